@@ -39,9 +39,12 @@ CONFIG += c++17
 
 SOURCES += \
     about.cpp \
+    batchevaluator.cpp \
     cache.cpp \
     calcview.cpp \
+    changelog.cpp \
     charactermap.cpp \
+    core.cpp \
     cropwidget.cpp \
     datepicker.cpp \
     extractiondialog.cpp \
@@ -59,17 +62,22 @@ SOURCES += \
     main.cpp \
     mainwindow.cpp \
     database.cpp \
+    databaseservice.cpp \
     networkmanager.cpp \
     nfpabuilder.cpp \
     nfpawidget.cpp \
+    pivottable.cpp \
     pixmaputils.cpp \
     propertydelegate.cpp \
     propertydialog.cpp \
     propertydock.cpp \
     propertyeditor.cpp \
+    propertyextractor.cpp \
     propertyfragment.cpp \
+    propertyindex.cpp \
     propertyview.cpp \
     propertywidget.cpp \
+    querytracer.cpp \
     reagentdelegate.cpp \
     reagentdialog.cpp \
     reagentdock.cpp \
@@ -78,9 +86,12 @@ SOURCES += \
     script.cpp \
     scriptmath.cpp \
     searchengine.cpp \
+    searchindex.cpp \
     searchfragment.cpp \
     settingsdialog.cpp \
+    startupprofiler.cpp \
     structurefragment.cpp \
+    structureprefetcher.cpp \
     syntaxhighlighter.cpp \
     system.cpp \
     table.cpp \
@@ -93,7 +104,9 @@ SOURCES += \
     tagselectiondialog.cpp \
     textedit.cpp \
     theme.cpp \
+    thumbnailmodel.cpp \
     variable.cpp \
+    variablebindings.cpp \
     xmltools.cpp \
     reagent.cpp \
     property.cpp \
@@ -103,10 +116,13 @@ SOURCES += \
 
 HEADERS += \
     about.h \
+    batchevaluator.h \
     buttonbox.h \
     cache.h \
     calcview.h \
+    changelog.h \
     charactermap.h \
+    core.h \
     cropwidget.h \
     datepicker.h \
     dockwidget.h \
@@ -128,20 +144,25 @@ HEADERS += \
     listutils.h \
     mainwindow.h \
     database.h \
+    databaseservice.h \
     field.h \
     networkmanager.h \
     nfpabuilder.h \
     nfpawidget.h \
+    pivottable.h \
     pixmaputils.h \
     propertydelegate.h \
     propertydialog.h \
     propertydock.h \
     propertyeditor.h \
+    propertyextractor.h \
     propertyfragment.h \
+    propertyindex.h \
     propertyinput.h \
     propertyview.h \
     propertyviewwidget.h \
     propertywidget.h \
+    querytracer.h \
     reagentdelegate.h \
     reagentdialog.h \
     reagentdock.h \
@@ -150,9 +171,12 @@ HEADERS += \
     script.h \
     scriptmath.h \
     searchengine.h \
+    searchindex.h \
     searchfragment.h \
     settingsdialog.h \
+    startupprofiler.h \
     structurefragment.h \
+    structureprefetcher.h \
     syntaxhighlighter.h \
     system.h \
     tabbar.h \
@@ -167,8 +191,10 @@ HEADERS += \
     textedit.h \
     textutils.h \
     theme.h \
+    thumbnailmodel.h \
     variable.h \
     variableentry.h \
+    variablehandle.h \
     widget.h \
     xmltools.h \
     main.h \
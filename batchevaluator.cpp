@@ -0,0 +1,538 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "batchevaluator.h"
+#include "htmlutils.h"
+#include "property.h"
+#include "querytracer.h"
+#include "reagent.h"
+#include "script.h"
+#include "scriptmath.h"
+#include "tag.h"
+#include "variable.h"
+#include "variablehandle.h"
+#include <QAtomicInt>
+#include <QRegularExpression>
+#include <QRunnable>
+#include <QSet>
+#include <QSqlQuery>
+
+/**
+ * @brief The BatchSnapshot struct holds everything workers need (read-only once built)
+ */
+struct BatchSnapshot {
+    /**
+     * @brief The Value struct
+     */
+    struct Value {
+        qreal value = 0.0;
+        bool valid = false;
+    };
+
+    /**
+     * @brief key
+     * @param reagentId
+     * @param tagId
+     * @return
+     */
+    [[nodiscard]] static quint64 key( const Id &reagentId, const Id &tagId ) {
+        return static_cast<quint64>( static_cast<quint32>( reagentId )) << 32 | static_cast<quint32>( tagId );
+    }
+
+    /**
+     * @brief key
+     * @param parentId
+     * @param name
+     * @return
+     */
+    [[nodiscard]] static QString key( const Id &parentId, const QString &name ) {
+        return QString::number( static_cast<int>( parentId )) + '/' + name;
+    }
+
+    QString program;
+    QString ans;
+    QString decimalSeparator;
+    QVector<BatchEvaluator::Entry> entries;
+    QHash<QString, Id> functions;
+    QHash<Id, qreal> scales;
+    QHash<QString, Id> names;
+    QHash<QString, Id> plainNames;
+    QHash<quint64, Value> values;
+};
+
+/**
+ * @brief The BatchJob struct is shared between the evaluator and its workers
+ */
+struct BatchJob {
+    QSharedPointer<const BatchSnapshot> snapshot;
+    QAtomicInt next;
+    QAtomicInt active;
+    QAtomicInt cancelled;
+};
+
+/**
+ * @brief The BatchWorker class evaluates blocks of entries with its own script engine
+ */
+class BatchWorker final : public QRunnable {
+    Q_DISABLE_COPY( BatchWorker )
+
+public:
+    /**
+     * @brief BatchWorker
+     * @param evaluator
+     * @param job
+     */
+    explicit BatchWorker( BatchEvaluator *evaluator, const QSharedPointer<BatchJob> &job ) : evaluator( evaluator ), job( job ) {}
+
+    // disable move
+    BatchWorker( BatchWorker&& ) = delete;
+    BatchWorker& operator=( BatchWorker&& ) = delete;
+    ~BatchWorker() override = default;
+
+    void run() override;
+
+private:
+    BatchEvaluator *evaluator;
+    const QSharedPointer<BatchJob> job;
+};
+
+/**
+ * @brief BatchWorker::run
+ */
+void BatchWorker::run() {
+    {
+        const BatchSnapshot &snapshot( *this->job->snapshot );
+
+        // NOTE: engines cannot be shared between threads, so each worker sets up its own
+        //       and compiles the expression only once
+        QJSEngine engine;
+        ScriptMath math;
+        BatchResolver resolver( &engine, this->job->snapshot );
+        QJSEngine::setObjectOwnership( &math, QJSEngine::CppOwnership );
+        QJSEngine::setObjectOwnership( &resolver, QJSEngine::CppOwnership );
+        engine.globalObject().setProperty( "JS", engine.newQObject( &resolver ));
+        engine.globalObject().setProperty( "math", engine.newQObject( &math ));
+        QJSValue function( engine.evaluate( snapshot.program ));
+
+        const int count = snapshot.entries.count();
+        while ( !this->job->cancelled.loadAcquire()) {
+            const int first = this->job->next.fetchAndAddRelaxed( BatchEvaluator_::BlockSize );
+            if ( first >= count )
+                break;
+
+            const int last = qMin( first + BatchEvaluator_::BlockSize, count );
+            QList<BatchEvaluator::Result> results;
+            results.reserve( last - first );
+
+            for ( int y = first; y < last; y++ ) {
+                resolver.setEntry( &snapshot.entries.at( y ));
+                const QJSValue value( function.isCallable() ? function.call() : function );
+
+                BatchEvaluator::Result result;
+                result.index = y;
+                if ( value.isError()) {
+                    result.errorString = value.toString();
+                } else if ( value.isNumber()) {
+                    result.isNumber = true;
+                    result.number = value.toNumber();
+                    result.value = Script::formatNumber( result.number, snapshot.decimalSeparator );
+                } else {
+                    result.value = value.toString();
+                }
+                results << result;
+            }
+
+            emit this->evaluator->resultsReady( results );
+        }
+    }
+
+    // last worker out reports completion
+    if ( !this->job->active.deref())
+        emit this->evaluator->finished();
+}
+
+/**
+ * @brief BatchEvaluator::BatchEvaluator
+ * @param parent
+ */
+BatchEvaluator::BatchEvaluator( QObject *parent ) : QObject( parent ) {}
+
+/**
+ * @brief BatchEvaluator::~BatchEvaluator
+ */
+BatchEvaluator::~BatchEvaluator() {
+    // workers emit through this object, so they must be done before it is gone
+    this->cancel();
+    this->pool.waitForDone();
+}
+
+/**
+ * @brief BatchEvaluator::start evaluates the expression for each reagent in the set (all reagents
+ * if empty) or, if the batch placeholder is used, for each of their batches
+ * NOTE: must be called from the GUI thread, since the snapshot is built from table models
+ * @param expression
+ * @param reagentIds
+ * @return
+ */
+bool BatchEvaluator::start( const QString &expression, const QList<Id> &reagentIds ) {
+    if ( this->isRunning()) {
+        this->cancel();
+        this->waitForDone();
+    }
+    this->m_errorString.clear();
+
+    QSharedPointer<BatchSnapshot> snapshot( new BatchSnapshot());
+
+    // placeholders are quoted, so that they pass as references to property functions
+    const QString expanded( QString( expression ).replace(
+            QRegularExpression( R"("?\$(reagent|batch)\b"?)" ), R"("$\1")" ));
+    const bool perBatch = expanded.contains( BatchEvaluator_::BatchPlaceholder );
+
+    QString processed( Script::instance()->preprocess( expanded, &this->m_errorString ));
+    if ( !this->m_errorString.isEmpty())
+        return false;
+
+    while ( processed.endsWith( ';' ))
+        processed.chop( 1 );
+    snapshot->program = QString( "(function() { return ( %1 ); })" ).arg( processed );
+    snapshot->ans = Variable::string( "calculator/ans" );
+    snapshot->decimalSeparator = Variable_::DecimalSeparator.value();
+
+    // property functions used in the expression
+    QSet<QString> used;
+    QRegularExpressionMatchIterator iterator( QRegularExpression( R"(JS\.getProperty\(\s*"([^"]+)\")" ).globalMatch( processed ));
+    while ( iterator.hasNext())
+        used << iterator.next().captured( 1 );
+
+    QStringList tagIds;
+    for ( int y = 0; y < Tag::instance()->count(); y++ ) {
+        const Row row = Tag::instance()->row( y );
+        const QString function( Tag::instance()->function( row ));
+        if ( function.isEmpty() || !used.contains( function ))
+            continue;
+
+        const Id tagId = Tag::instance()->id( row );
+        snapshot->functions[function] = tagId;
+        snapshot->scales[tagId] = Tag::instance()->scale( row );
+        tagIds << QString::number( static_cast<int>( tagId ));
+    }
+
+    // names and references of all reagents, since expressions may refer to any of them
+    QList<Id> parents;
+    QHash<Id, QList<Id>> children;
+    QHash<Id, QString> names, references;
+    for ( int y = 0; y < Reagent::instance()->count(); y++ ) {
+        const Row row = Reagent::instance()->row( y );
+        const Id id = Reagent::instance()->id( row );
+        const Id parentId = Reagent::instance()->parentId( row );
+        const QString name( Reagent::instance()->name( row ));
+        const QString reference( Reagent::instance()->reference( row ));
+
+        if ( parentId == Id::Invalid )
+            parents << id;
+        else
+            children[parentId] << id;
+
+        // raw names are matched first, plain text ones second (just like in Script)
+        const QString plainName( HTMLUtils::toPlainText( name ));
+        const QString plainReference( HTMLUtils::toPlainText( reference ));
+        if ( !name.isEmpty())
+            snapshot->names.insert( BatchSnapshot::key( parentId, name ), id );
+        if ( !reference.isEmpty())
+            snapshot->names.insert( BatchSnapshot::key( parentId, reference ), id );
+        if ( !plainName.isEmpty())
+            snapshot->plainNames.insert( BatchSnapshot::key( parentId, plainName ), id );
+        if ( !plainReference.isEmpty())
+            snapshot->plainNames.insert( BatchSnapshot::key( parentId, plainReference ), id );
+
+        names[id] = plainName;
+        references[id] = plainReference;
+    }
+
+    // entries
+    const QList<Id> set( reagentIds.isEmpty() ? parents : reagentIds );
+    for ( const Id &reagentId : set ) {
+        BatchEvaluator::Entry entry;
+        entry.reagentId = reagentId;
+        entry.reference = references.value( reagentId );
+        entry.name = names.value( reagentId );
+
+        if ( !perBatch ) {
+            snapshot->entries << entry;
+            continue;
+        }
+
+        const QList<Id> batches( children.value( reagentId ));
+        for ( const Id &batchId : batches ) {
+            entry.batchId = batchId;
+            entry.batch = names.value( batchId );
+            snapshot->entries << entry;
+        }
+    }
+
+    if ( snapshot->entries.isEmpty()) {
+        this->m_errorString = BatchEvaluator::tr( "nothing to evaluate" );
+        return false;
+    }
+
+    // property values (single pass over the property table)
+    if ( !tagIds.isEmpty()) {
+        QSqlQuery query;
+        QueryTracer::exec( query, QString( "select %1, %2, %3 from %4 where %2 in ( %5 )" )
+                            .arg( Property::instance()->fieldName( Property::ReagentId ),
+                                  Property::instance()->fieldName( Property::TagId ),
+                                  Property::instance()->fieldName( Property::PropertyData ),
+                                  Property::instance()->tableName(),
+                                  tagIds.join( ", " )), "script" );
+        while ( query.next()) {
+            const quint64 key = BatchSnapshot::key( query.value( 0 ).value<Id>(), query.value( 1 ).value<Id>());
+            if ( snapshot->values.contains( key ))
+                continue;
+
+            BatchSnapshot::Value value;
+            const QVariant data( query.value( 2 ));
+            if ( !data.isNull())
+                value.value = data.toReal( &value.valid );
+            snapshot->values.insert( key, value );
+        }
+    }
+
+    // start workers
+    this->job = QSharedPointer<BatchJob>( new BatchJob());
+    this->job->snapshot = snapshot;
+
+    const int blocks = ( snapshot->entries.count() + BatchEvaluator_::BlockSize - 1 ) / BatchEvaluator_::BlockSize;
+    const int workers = qBound( 1, this->pool.maxThreadCount(), blocks );
+    this->job->active.storeRelease( workers );
+    for ( int y = 0; y < workers; y++ )
+        this->pool.start( new BatchWorker( this, this->job ));
+
+    return true;
+}
+
+/**
+ * @brief BatchEvaluator::cancel stops workers after their current block
+ */
+void BatchEvaluator::cancel() {
+    if ( !this->job.isNull())
+        this->job->cancelled.storeRelease( 1 );
+}
+
+/**
+ * @brief BatchEvaluator::waitForDone
+ * @param msecs
+ * @return
+ */
+bool BatchEvaluator::waitForDone( int msecs ) {
+    return this->pool.waitForDone( msecs );
+}
+
+/**
+ * @brief BatchEvaluator::isRunning
+ * @return
+ */
+bool BatchEvaluator::isRunning() const {
+    return !this->job.isNull() && this->job->active.loadAcquire() > 0;
+}
+
+/**
+ * @brief BatchEvaluator::entries returns entries of the current evaluation (result indexes refer to these)
+ * @return
+ */
+QVector<BatchEvaluator::Entry> BatchEvaluator::entries() const {
+    if ( this->job.isNull())
+        return QVector<BatchEvaluator::Entry>();
+
+    return this->job->snapshot->entries;
+}
+
+/**
+ * @brief BatchResolver::BatchResolver
+ * @param engine
+ * @param snapshot
+ */
+BatchResolver::BatchResolver( QJSEngine *engine, const QSharedPointer<const BatchSnapshot> &snapshot ) : engine( engine ), snapshot( snapshot ) {}
+
+/**
+ * @brief BatchResolver::ans
+ * @return
+ */
+QJSValue BatchResolver::ans() {
+    if ( this->snapshot->ans.isEmpty()) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        this->engine->throwError( QJSValue::EvalError,
+#else
+        return QJSValue(
+#endif
+        Script::tr( "answer is empty" ));
+        return QJSValue();
+    }
+
+    return this->snapshot->ans;
+}
+
+/**
+ * @brief BatchResolver::getProperty
+ * @param functionName
+ * @param reference
+ * @return
+ */
+QJSValue BatchResolver::getProperty( const QString &functionName, const QString &reference ) {
+    // validate reagent reference
+    if ( reference.isEmpty()) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        this->engine->throwError( QJSValue::SyntaxError,
+#else
+        return QJSValue(
+#endif
+        Script::tr( "expected an argument for function \"%1\"" ).arg( functionName ));
+        return QJSValue();
+    }
+
+    return this->getPropertyInternal( functionName, reference );
+}
+
+/**
+ * @brief BatchResolver::getProperty
+ * @param functionName
+ * @param reference
+ * @param batchName
+ * @return
+ */
+QJSValue BatchResolver::getProperty( const QString &functionName, const QString &reference, const QString &batchName ) {
+    // validate batchName
+    if ( batchName.isEmpty()) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        this->engine->throwError( QJSValue::SyntaxError,
+#else
+        return QJSValue(
+#endif
+        Script::tr( "expected arguments for function \"%1\"" ).arg( functionName ));
+        return QJSValue();
+    }
+
+    return this->getPropertyInternal( functionName, reference, batchName );
+}
+
+/**
+ * @brief BatchResolver::getPropertyInternal mirrors Script::getPropertyInternal, but reads the snapshot
+ * @param functionName
+ * @param reference
+ * @param batchName
+ * @return
+ */
+QJSValue BatchResolver::getPropertyInternal( const QString &functionName, const QString &reference, const QString &batchName ) {
+    // get propertyId
+    const Id propertyId = this->snapshot->functions.value( functionName, Id::Invalid );
+    if ( propertyId == Id::Invalid ) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        this->engine->throwError( QJSValue::ReferenceError,
+#else
+        return QJSValue(
+#endif
+        Script::tr( "function \"%1\" is not defined" ).arg( functionName ));
+        return QJSValue();
+    }
+
+    // get reagentId (the batch placeholder alone falls back to its parent, like batch arguments do)
+    const Id reagentId = this->reagentId( reference );
+    if ( reagentId == Id::Invalid ) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        this->engine->throwError( QJSValue::ReferenceError,
+#else
+        return QJSValue(
+#endif
+        Script::tr( "reagent \"%1\" is not defined" ).arg( reference ));
+        return QJSValue();
+    }
+    Id valueId = reagentId;
+    Id parentId = ( reference == BatchEvaluator_::BatchPlaceholder && this->entry != nullptr ) ? this->entry->reagentId : Id::Invalid;
+
+    // get batchId
+    if ( !batchName.isEmpty()) {
+        const Id batchId = this->reagentId( batchName, reagentId );
+        if ( batchId == Id::Invalid ) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+            this->engine->throwError( QJSValue::ReferenceError,
+#else
+            return QJSValue(
+#endif
+            Script::tr( "batch \"%1\" is not defined" ).arg( batchName ));
+            return QJSValue();
+        }
+        valueId = batchId;
+        parentId = reagentId;
+    }
+
+    // get property value
+    quint64 key = BatchSnapshot::key( valueId, propertyId );
+    if ( !this->snapshot->values.contains( key ) && parentId != Id::Invalid )
+        key = BatchSnapshot::key( parentId, propertyId );
+
+    const auto value( this->snapshot->values.constFind( key ));
+    if ( value == this->snapshot->values.constEnd()) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        this->engine->throwError( QJSValue::TypeError,
+#else
+        return QJSValue(
+#endif
+        Script::tr( R"(property "%1" is not defined for "%2")" )
+        .arg( functionName,
+        batchName.isEmpty() ? reference : batchName ));
+        return QJSValue();
+    }
+
+    // make sure it is a valid number
+    if ( !value->valid ) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        this->engine->throwError( QJSValue::TypeError,
+#else
+        return QJSValue(
+#endif
+                                 Script::tr( "%1( %2 ) does not evaluate to a valid number" )
+                                 .arg( functionName,
+                                       reference ) +
+                                       ( batchName.isEmpty() ? "" : QString( ", %1" ).arg( batchName )));
+        return QJSValue();
+    }
+
+    // return scaled (for example assay is % or 0.01) value
+    return value->value * this->snapshot->scales.value( propertyId, 1.0 );
+}
+
+/**
+ * @brief BatchResolver::reagentId resolves placeholders and literal names or references
+ * @param reference
+ * @param parentId
+ * @return
+ */
+Id BatchResolver::reagentId( const QString &reference, const Id &parentId ) const {
+    if ( this->entry != nullptr ) {
+        if ( reference == BatchEvaluator_::ReagentPlaceholder )
+            return parentId == Id::Invalid ? this->entry->reagentId : Id::Invalid;
+
+        if ( reference == BatchEvaluator_::BatchPlaceholder )
+            return this->entry->batchId;
+    }
+
+    const QString key( BatchSnapshot::key( parentId, reference ));
+    return this->snapshot->names.value( key, this->snapshot->plainNames.value( key, Id::Invalid ));
+}
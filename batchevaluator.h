@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QJSEngine>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QVector>
+#include "table.h"
+
+/**
+ * @brief The BatchEvaluator_ namespace
+ */
+namespace BatchEvaluator_ {
+    [[maybe_unused]] static constexpr const char *ReagentPlaceholder = "$reagent";
+    [[maybe_unused]] static constexpr const char *BatchPlaceholder = "$batch";
+    [[maybe_unused]] static constexpr const int BlockSize = 32;
+}
+
+/*
+ * classes
+ */
+struct BatchJob;
+struct BatchSnapshot;
+
+/**
+ * @brief The BatchEvaluator class evaluates a calculator expression template for every reagent
+ * (or batch) of a reagent set on a thread pool
+ *
+ * Everything the expression needs is read on the GUI thread into a read-only snapshot, each
+ * worker then evaluates its share of entries with its own QJSEngine. Results are streamed
+ * through resultsReady in blocks and in no particular order.
+ */
+class BatchEvaluator final : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( BatchEvaluator )
+    friend class BatchWorker;
+
+public:
+    /**
+     * @brief The Entry struct
+     */
+    struct Entry {
+        Id reagentId = Id::Invalid;
+        Id batchId = Id::Invalid;
+        QString reference;
+        QString name;
+        QString batch;
+    };
+
+    /**
+     * @brief The Result struct
+     */
+    struct Result {
+        int index = -1;
+        QString value;
+        qreal number = 0.0;
+        bool isNumber = false;
+        QString errorString;
+    };
+
+    explicit BatchEvaluator( QObject *parent = nullptr );
+
+    // disable move
+    BatchEvaluator( BatchEvaluator&& ) = delete;
+    BatchEvaluator& operator=( BatchEvaluator&& ) = delete;
+    ~BatchEvaluator() override;
+
+    [[nodiscard]] bool start( const QString &expression, const QList<Id> &reagentIds = QList<Id>());
+    void cancel();
+    bool waitForDone( int msecs = -1 );
+    [[nodiscard]] bool isRunning() const;
+    [[nodiscard]] QVector<Entry> entries() const;
+    [[nodiscard]] QString errorString() const { return this->m_errorString; }
+    [[nodiscard]] int threadCount() const { return this->pool.maxThreadCount(); }
+    void setThreadCount( int count ) { this->pool.setMaxThreadCount( qMax( 1, count )); }
+
+signals:
+    void resultsReady( const QList<BatchEvaluator::Result> &results );
+    void finished();
+
+private:
+    QThreadPool pool;
+    QSharedPointer<BatchJob> job;
+    QString m_errorString;
+};
+
+/**
+ * @brief The BatchResolver class replaces Script (JS object) within worker engines, reading
+ * property values from the snapshot instead of the database
+ */
+class BatchResolver final : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( BatchResolver )
+
+public:
+    explicit BatchResolver( QJSEngine *engine, const QSharedPointer<const BatchSnapshot> &snapshot );
+
+    // disable move
+    BatchResolver( BatchResolver&& ) = delete;
+    BatchResolver& operator=( BatchResolver&& ) = delete;
+    ~BatchResolver() override = default;
+
+    /**
+     * @brief setEntry sets the entry placeholders are resolved to
+     * @param entry
+     */
+    void setEntry( const BatchEvaluator::Entry *entry ) { this->entry = entry; }
+
+    Q_INVOKABLE QJSValue ans();
+    Q_INVOKABLE QJSValue getProperty( const QString &functionName, const QString &reference );
+    Q_INVOKABLE QJSValue getProperty( const QString &functionName, const QString &reference, const QString &batchName );
+
+private:
+    [[nodiscard]] QJSValue getPropertyInternal( const QString &functionName, const QString &reference, const QString &batchName = QString());
+    [[nodiscard]] Id reagentId( const QString &reference, const Id &parentId = Id::Invalid ) const;
+    QJSEngine *engine;
+    const QSharedPointer<const BatchSnapshot> snapshot;
+    const BatchEvaluator::Entry *entry = nullptr;
+};
+
+// declare metatypes
+Q_DECLARE_METATYPE( BatchEvaluator::Result )
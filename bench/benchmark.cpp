@@ -0,0 +1,410 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "batchevaluator.h"
+#include "benchmark.h"
+#include "cache.h"
+#include "core.h"
+#include "database.h"
+#include "extractiondialog.h"
+#include "imageutils.h"
+#include "labelset.h"
+#include "main.h"
+#include "property.h"
+#include "propertyfragment.h"
+#include "reagent.h"
+#include "reagentmodel.h"
+#include "script.h"
+#include "searchindex.h"
+#include "startupprofiler.h"
+#include "tableentry.h"
+#include "tableproperty.h"
+#include "tableviewer.h"
+#include "variable.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTableView>
+#include <QTableWidget>
+#include <QTextStream>
+#include <QtTest>
+
+/**
+ * @brief Benchmark::Benchmark
+ * @param options
+ * @param jsonPath results are written to stdout if empty
+ */
+Benchmark::Benchmark( const InventoryGenerator::Options &options, const QString &jsonPath ) :
+    generator( options ), options( options ), jsonPath( jsonPath ) {}
+
+/**
+ * @brief Benchmark::initTestCase generates the inventory and measures startup (once per run, since
+ * database and tables are singletons)
+ */
+void Benchmark::initTestCase() {
+    QVERIFY( this->directory.isValid());
+
+    const QString path( this->directory.filePath( "database.db" ));
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY( this->generator.generate( path ));
+    this->record( "generate", timer.nsecsElapsed(), 1 );
+
+    Core::registerMetaTypes();
+    Core::addVariables();
+    Variable::setString( "databasePath", path );
+
+    // same phases as in main
+    StartupProfiler::instance()->mark( "configuration" );
+    Database::instance();
+    StartupProfiler::instance()->mark( "database" );
+    QVERIFY( Core::loadTables());
+    StartupProfiler::instance()->mark( "tables" );
+
+    // lazy tables are selected on first use
+    LabelSet::instance()->load();
+    TableEntry::instance()->load();
+    TableProperty::instance()->load();
+    StartupProfiler::instance()->mark( "lazy tables" );
+    StartupProfiler::instance()->finish();
+
+    const QList<QPair<QString, qint64>> phases( StartupProfiler::instance()->phases());
+    for ( const QPair<QString, qint64> &phase : phases )
+        this->record( QString( "startup/%1" ).arg( phase.first ), phase.second, 1 );
+
+    QCOMPARE( Reagent::instance()->count(), this->options.reagents * ( 1 + this->options.batches ));
+}
+
+/**
+ * @brief Benchmark::cleanupTestCase writes results
+ */
+void Benchmark::cleanupTestCase() {
+    const QJsonObject object {
+        { "options", QJsonObject::fromVariantMap( this->options.toMap()) },
+        { "qt", QString( qVersion()) },
+        { "results", this->results }
+    };
+    const QByteArray json( QJsonDocument( object ).toJson());
+
+    if ( this->jsonPath.isEmpty()) {
+        QTextStream( stdout ) << json;
+        return;
+    }
+
+    QFile file( this->jsonPath );
+    QVERIFY( file.open( QIODevice::WriteOnly | QIODevice::Truncate ));
+    file.write( json );
+    file.close();
+}
+
+/**
+ * @brief Benchmark::tableSelect
+ */
+void Benchmark::tableSelect() {
+    this->measure( []() {
+        Reagent::instance()->select();
+        Property::instance()->select();
+    } );
+}
+
+/**
+ * @brief Benchmark::tableRowById
+ */
+void Benchmark::tableRowById() {
+    // ids are picked with a fixed seed, so every run looks up the same rows
+    QRandomGenerator random( this->options.seed );
+    QVector<Id> ids;
+    const int count = Reagent::instance()->count();
+    for ( int y = 0; y < 1000; y++ )
+        ids << Reagent::instance()->id( static_cast<Row>( random.bounded( count )));
+
+    this->measure( [ &ids ]() {
+        for ( const Id &id : qAsConst( ids ))
+            QVERIFY( Reagent::instance()->row( id ) != Row::Invalid );
+    } );
+}
+
+/**
+ * @brief Benchmark::reagentModelSetup
+ */
+void Benchmark::reagentModelSetup() {
+    ReagentModel model;
+    this->measure( [ &model ]() {
+        model.setupModelData();
+    } );
+
+    QCOMPARE( model.invisibleRootItem()->rowCount(), this->options.reagents );
+}
+
+/**
+ * @brief Benchmark::scriptEvaluate
+ */
+void Benchmark::scriptEvaluate() {
+    QVERIFY( this->options.properties >= 2 );
+
+    this->measure( []() {
+        const QJSValue value( Script::instance()->evaluate( "molarMass(\"REF1\")*density(\"REF1\")" ));
+        QVERIFY( !value.isError());
+    } );
+}
+
+/**
+ * @brief Benchmark::batchEvaluate evaluates a template for every reagent (snapshot and thread pool)
+ */
+void Benchmark::batchEvaluate() {
+    QVERIFY( this->options.properties >= 2 );
+
+    BatchEvaluator evaluator;
+    this->measure( [ &evaluator ]() {
+        QVERIFY( evaluator.start( "molarMass($reagent)*density($reagent)" ));
+        evaluator.waitForDone();
+    } );
+}
+
+/**
+ * @brief Benchmark::searchQuery
+ */
+void Benchmark::searchQuery() {
+    if ( !SearchIndex::instance()->isAvailable())
+        QSKIP( "sqlite was built without FTS5" );
+
+    // index is built once, outside of measurement
+    SearchIndex::instance()->rebuild();
+
+    this->measure( []() {
+        QVERIFY( !SearchIndex::instance()->search( "reagent ref1" ).isEmpty());
+    } );
+}
+
+/**
+ * @brief Benchmark::tableViewerPopulate
+ */
+void Benchmark::tableViewerPopulate() {
+    TableViewer viewer( nullptr, static_cast<Id>( 1 ));
+    const QTableView *view( viewer.findChild<QTableView *>( "tableView" ));
+    QVERIFY( view != nullptr );
+
+    // pivot is built on the database thread
+    QTRY_VERIFY_WITH_TIMEOUT( view->model()->rowCount() > 0, 60000 );
+
+    QVector<int> rows;
+    for ( int y = 0; y < view->model()->rowCount(); y++ )
+        rows << y;
+
+    this->measure( [ &viewer, &rows ]() {
+        viewer.populateTable( rows );
+    } );
+}
+
+/**
+ * @brief Benchmark::propertyFragmentReadData
+ */
+void Benchmark::propertyFragmentReadData() {
+    ExtractionDialog dialog( nullptr, Reagent::instance()->id( static_cast<Row>( 0 )));
+    const QByteArray document( Benchmark::pubChemDocument( 200 ));
+
+    // readData sizes itself against the screen, so a native window is required
+    dialog.winId();
+
+    PropertyFragment *fragment( dialog.propertyFragment());
+    auto *propertyView( fragment->findChild<QTableWidget *>( "propertyView" ));
+    QVERIFY( propertyView != nullptr );
+
+    // NOTE: readData is a private slot, so it is invoked through the meta-object system
+    this->measure( [ fragment, propertyView, &document ]() {
+        propertyView->setRowCount( 0 );
+        QVERIFY( QMetaObject::invokeMethod( fragment, "readData", Qt::DirectConnection, Q_ARG( QByteArray, document )));
+    } );
+}
+
+/**
+ * @brief Benchmark::imageAutoCrop
+ */
+void Benchmark::imageAutoCrop() {
+    const QImage image( QImage::fromData( this->generator.formula( 0 )));
+    QVERIFY( !image.isNull());
+
+    this->measure( [ &image ]() {
+        const QImage cropped( ImageUtils::autoCrop( image ));
+        QVERIFY( cropped.width() < image.width());
+    } );
+}
+
+/**
+ * @brief Benchmark::cacheWrite
+ */
+void Benchmark::cacheWrite() {
+    int key = 0;
+    this->measure( [ this, &key ]() {
+        const QString name( QString( "bench%1" ).arg( key % this->options.formulas ));
+        QVERIFY( Cache::instance()->insert( Cache::DataContext, name, this->generator.formula( key++ ), true ));
+    } );
+}
+
+/**
+ * @brief Benchmark::cacheRead
+ */
+void Benchmark::cacheRead() {
+    for ( int y = 0; y < this->options.formulas; y++ )
+        QVERIFY( Cache::instance()->insert( Cache::DataContext, QString( "bench%1" ).arg( y ), this->generator.formula( y ), true ));
+
+    int key = 0;
+    this->measure( [ this, &key ]() {
+        const QString name( QString( "bench%1" ).arg( key++ % this->options.formulas ));
+        QVERIFY( !Cache::instance()->getData( Cache::DataContext, name, true ).isEmpty());
+    } );
+}
+
+/**
+ * @brief Benchmark::measure runs function within QBENCHMARK and records mean time per iteration
+ * @param function
+ */
+void Benchmark::measure( const std::function<void()> &function ) {
+    QElapsedTimer timer;
+    qint64 iterations = 0;
+
+    timer.start();
+    QBENCHMARK {
+        function();
+        iterations++;
+    }
+
+    this->record( QTest::currentTestFunction(), timer.nsecsElapsed(), iterations );
+}
+
+/**
+ * @brief Benchmark::record
+ * @param name
+ * @param nsecs total time
+ * @param iterations
+ */
+void Benchmark::record( const QString &name, qint64 nsecs, qint64 iterations ) {
+    this->results << QJsonObject {
+        { "name", name },
+        { "iterations", iterations },
+        { "nsPerIteration", iterations > 0 ? static_cast<double>( nsecs ) / iterations : 0.0 }
+    };
+}
+
+/**
+ * @brief Benchmark::pubChemDocument builds a PUG View-like document with nested sections
+ * @param sections
+ * @return
+ */
+QByteArray Benchmark::pubChemDocument( int sections ) {
+    const QStringList headings( QStringList() << "Molecular Weight" << "Density" << "Boiling Point" << "Melting Point"
+                                << "Flash Point" << "Viscosity" << "Physical Description" << "Solubility"
+                                << "Vapor Pressure" << "Refractive Index" );
+
+    QJsonArray list;
+    for ( int y = 0; y < sections; y++ ) {
+        const QString &heading( headings.at( y % headings.count()));
+        const bool numeric = y % 2 == 0;
+
+        QJsonObject value;
+        if ( numeric ) {
+            value.insert( "Number", QJsonArray { 1.0 + y, 2.5 + y } );
+            value.insert( "Unit", "g/mol" );
+        } else {
+            value.insert( "StringWithMarkup", QJsonArray { QJsonObject {{ "String", QString( "%1 %2 °C (%3 °F)" ).arg( heading ).arg( y ).arg( y * 2 + 32 ) }} } );
+        }
+
+        const QJsonObject information {
+            { "ReferenceNumber", y },
+            { "Value", value }
+        };
+
+        list << QJsonObject {
+            { "TOCHeading", "Chemical and Physical Properties" },
+            { "Section", QJsonArray {
+                  QJsonObject {
+                      { "TOCHeading", heading },
+                      { "Information", QJsonArray { information } }
+                  }
+              }
+            }
+        };
+    }
+
+    return QJsonDocument( QJsonObject {{ "Record", QJsonObject {{ "RecordType", "CID" }, { "Section", list }} }} ).toJson( QJsonDocument::Compact );
+}
+
+/**
+ * @brief main
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main( int argc, char *argv[] ) {
+    // keep configuration and cache out of the user's home directory
+    QTemporaryDir home;
+    qputenv( "HOME", home.path().toLocal8Bit());
+    qputenv( "USERPROFILE", home.path().toLocal8Bit());
+    if ( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ))
+        qputenv( "QT_QPA_PLATFORM", "offscreen" );
+
+    QApplication a( argc, argv );
+    StartupProfiler::instance()->mark( "application" );
+
+    // generator options are consumed here, the rest is passed on to QtTest
+    InventoryGenerator::Options options;
+    QString jsonPath;
+    QStringList arguments;
+    const QStringList input( QApplication::arguments());
+    for ( int y = 0; y < input.count(); y++ ) {
+        const QString &argument( input.at( y ));
+        const bool hasValue = y + 1 < input.count();
+
+        if ( hasValue && !QString::compare( argument, "--reagents" ))
+            options.reagents = qMax( 1, input.at( ++y ).toInt());
+        else if ( hasValue && !QString::compare( argument, "--batches" ))
+            options.batches = qMax( 0, input.at( ++y ).toInt());
+        else if ( hasValue && !QString::compare( argument, "--properties" ))
+            options.properties = qMax( 0, input.at( ++y ).toInt());
+        else if ( hasValue && !QString::compare( argument, "--labels" ))
+            options.labels = qMax( 0, input.at( ++y ).toInt());
+        else if ( hasValue && !QString::compare( argument, "--formulas" ))
+            options.formulas = qMax( 1, input.at( ++y ).toInt());
+        else if ( hasValue && !QString::compare( argument, "--seed" ))
+            options.seed = input.at( ++y ).toUInt();
+        else if ( hasValue && !QString::compare( argument, "--json" ))
+            jsonPath = input.at( ++y );
+        else
+            arguments << argument;
+    }
+
+    int result;
+    {
+        Benchmark benchmark( options, jsonPath );
+        result = QTest::qExec( &benchmark, arguments );
+    }
+
+    GarbageMan::instance()->clear();
+    delete GarbageMan::instance();
+
+    if ( Database::instance() != nullptr )
+        delete Database::instance();
+
+    delete Variable::instance();
+    return result;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QJsonArray>
+#include <QObject>
+#include <QTemporaryDir>
+#include <functional>
+#include "inventorygenerator.h"
+
+/**
+ * @brief The Benchmark class runs QBENCHMARK suites against a generated inventory and collects
+ * per-iteration timings for regression tracking
+ */
+class Benchmark final : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( Benchmark )
+
+public:
+    explicit Benchmark( const InventoryGenerator::Options &options, const QString &jsonPath = QString());
+
+    // disable move
+    Benchmark( Benchmark&& ) = delete;
+    Benchmark& operator=( Benchmark&& ) = delete;
+    ~Benchmark() override = default;
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void tableSelect();
+    void tableRowById();
+    void reagentModelSetup();
+    void scriptEvaluate();
+    void batchEvaluate();
+    void searchQuery();
+    void tableViewerPopulate();
+    void propertyFragmentReadData();
+    void imageAutoCrop();
+    void cacheWrite();
+    void cacheRead();
+
+private:
+    void measure( const std::function<void()> &function );
+    void record( const QString &name, qint64 nsecs, qint64 iterations );
+    [[nodiscard]] static QByteArray pubChemDocument( int sections );
+
+    InventoryGenerator generator;
+    const InventoryGenerator::Options options;
+    const QString jsonPath;
+    QTemporaryDir directory;
+    QJsonArray results;
+};
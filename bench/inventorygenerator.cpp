@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "inventorygenerator.h"
+#include "tableentry.h"
+#include "tag.h"
+#include <QBuffer>
+#include <QDebug>
+#include <QFile>
+#include <QImage>
+#include <QPainter>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QtMath>
+
+/**
+ * @brief InventoryGenerator::Options::toMap
+ * @return
+ */
+QVariantMap InventoryGenerator::Options::toMap() const {
+    return QVariantMap {
+        { "reagents", this->reagents },
+        { "batches", this->batches },
+        { "properties", this->properties },
+        { "labels", this->labels },
+        { "formulas", this->formulas },
+        { "seed", this->seed }
+    };
+}
+
+/**
+ * @brief InventoryGenerator::generate creates a database at the given path (using the built-in schema)
+ * @param path
+ * @return
+ */
+bool InventoryGenerator::generate( const QString &path ) {
+    QFile::remove( path );
+    if ( !QFile::copy( ":/initial/database.db", path )) {
+        qWarning() << "could not create database" << path;
+        return false;
+    }
+    QFile::setPermissions( path, QFileDevice::ReadOwner | QFileDevice::WriteOwner );
+
+    // formula images are drawn once and shared between reagents
+    this->formulas.clear();
+    for ( int y = 0; y < qMax( 1, this->options.formulas ); y++ )
+        this->formulas << this->drawFormula( y );
+
+    bool success = true;
+    {
+        // NOTE: a separate connection is used, since the default one belongs to Database and
+        //       table models bind to it on construction
+        QSqlDatabase database( QSqlDatabase::addDatabase( "QSQLITE", InventoryGenerator::ConnectionName ));
+        database.setDatabaseName( path );
+        if ( !database.open()) {
+            qWarning() << "could not open database" << database.lastError().text();
+            return false;
+        }
+
+        auto exec = [ &success ]( QSqlQuery &query ) {
+            if ( !query.exec()) {
+                qWarning() << "generator query failed" << query.lastError().text();
+                success = false;
+            }
+        };
+
+        // start from an empty inventory
+        QSqlQuery query( database );
+        query.exec( "pragma foreign_keys=off" );
+        query.exec( "delete from property" );
+        query.exec( "delete from labelset" );
+        query.exec( "delete from reagent" );
+        query.exec( "delete from table_prop" );
+        query.exec( "delete from table_" );
+
+        // tag mix: numeric and text tags, every fourth property being a formula
+        QList<int> realTags, textTags, labelIds;
+        int formulaTag = -1;
+        query.exec( "select id, type from tag order by id" );
+        while ( query.next()) {
+            const int id = query.value( 0 ).toInt();
+            switch ( static_cast<Tag::Types>( query.value( 1 ).toInt())) {
+            case Tag::Real:
+                realTags << id;
+                break;
+
+            case Tag::Text:
+                textTags << id;
+                break;
+
+            case Tag::Formula:
+                formulaTag = id;
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        query.exec( "select id from label order by id" );
+        while ( query.next())
+            labelIds << query.value( 0 ).toInt();
+
+        database.transaction();
+
+        QSqlQuery reagent( database ), property( database ), labelSet( database );
+        reagent.prepare( "insert into reagent ( id, name, reference, parentId, dateTime ) values ( ?, ?, ?, ?, ? )" );
+        property.prepare( "insert into property ( name, tagId, propertyData, reagentId, tableOrder ) values ( ?, ?, ?, ?, ? )" );
+        labelSet.prepare( "insert into labelset ( labelId, reagentId ) values ( ?, ? )" );
+
+        constexpr const qint64 epoch = 1577836800; // 2020-01-01
+        constexpr const int period = 3 * 365 * 24 * 3600;
+        int reagentId = 1;
+        int order = 1;
+
+        auto addProperty = [ &exec, &property, &order ]( const QString &name, int tagId, const QByteArray &data, int reagentId ) {
+            property.addBindValue( name );
+            property.addBindValue( tagId );
+            property.addBindValue( data );
+            property.addBindValue( reagentId );
+            property.addBindValue( order++ );
+            exec( property );
+        };
+
+        for ( int y = 0; y < this->options.reagents && success; y++ ) {
+            const int parentId = reagentId++;
+
+            reagent.addBindValue( parentId );
+            reagent.addBindValue( QString( "Reagent %1" ).arg( y + 1 ));
+            reagent.addBindValue( QString( "REF%1" ).arg( y + 1 ));
+            reagent.addBindValue( -1 );
+            reagent.addBindValue( epoch + this->random.bounded( period ));
+            exec( reagent );
+
+            // properties (numeric values are stored as text, just like property widgets do)
+            for ( int k = 0; k < this->options.properties; k++ ) {
+                if ( formulaTag != -1 && k % 4 == 3 ) {
+                    addProperty( QString(), formulaTag, this->formulas.at( static_cast<int>( this->random.bounded( this->formulas.count()))), parentId );
+                } else if ( !textTags.isEmpty() && k % 4 == 2 ) {
+                    addProperty( QString(), textTags.at( k % textTags.count()), QString( "Text %1" ).arg( this->random.bounded( 100000 )).toUtf8(), parentId );
+                } else if ( !realTags.isEmpty()) {
+                    addProperty( QString(), realTags.at( k % realTags.count()), QByteArray::number( 1.0 + this->random.bounded( 1000.0 ), 'f', 3 ), parentId );
+                }
+            }
+
+            // labels are picked without repetition
+            QList<int> pool( labelIds );
+            for ( int k = 0; k < this->options.labels && !pool.isEmpty(); k++ ) {
+                labelSet.addBindValue( pool.takeAt( static_cast<int>( this->random.bounded( pool.count()))));
+                labelSet.addBindValue( parentId );
+                exec( labelSet );
+            }
+
+            // batches override a numeric property of their parent
+            for ( int k = 0; k < this->options.batches; k++ ) {
+                const int batchId = reagentId++;
+
+                reagent.addBindValue( batchId );
+                reagent.addBindValue( QString( "Batch %1" ).arg( k + 1 ));
+                reagent.addBindValue( QString());
+                reagent.addBindValue( parentId );
+                reagent.addBindValue( epoch + this->random.bounded( period ));
+                exec( reagent );
+
+                if ( !realTags.isEmpty())
+                    addProperty( QString(), realTags.first(), QByteArray::number( 90.0 + this->random.bounded( 10.0 ), 'f', 2 ), batchId );
+            }
+        }
+
+        // a pivot table of numeric tags
+        query.prepare( "insert into table_ ( id, name, mode ) values ( 1, ?, ? )" );
+        query.addBindValue( "Benchmark" );
+        query.addBindValue( static_cast<int>( TableEntry::Reagents ));
+        exec( query );
+
+        query.prepare( "insert into table_prop ( tableId, tagId, tab, tableOrder ) values ( 1, ?, 0, ? )" );
+        for ( int y = 0; y < realTags.count(); y++ ) {
+            query.addBindValue( realTags.at( y ));
+            query.addBindValue( y );
+            exec( query );
+        }
+
+        if ( success )
+            database.commit();
+        else
+            database.rollback();
+
+        database.close();
+    }
+    QSqlDatabase::removeDatabase( InventoryGenerator::ConnectionName );
+
+    return success;
+}
+
+/**
+ * @brief InventoryGenerator::formula returns png data of a generated formula
+ * @param index
+ * @return
+ */
+QByteArray InventoryGenerator::formula( int index ) const {
+    if ( this->formulas.isEmpty())
+        return QByteArray();
+
+    return this->formulas.at( index % this->formulas.count());
+}
+
+/**
+ * @brief InventoryGenerator::drawFormula draws a structure-like skeleton (rings and bonds) on
+ * a padded white canvas, so that autoCrop has some work to do
+ * @param index
+ * @return
+ */
+QByteArray InventoryGenerator::drawFormula( int index ) {
+    QImage image( 400, 300, QImage::Format_ARGB32 );
+    image.fill( Qt::white );
+
+    QPainter painter( &image );
+    painter.setRenderHint( QPainter::Antialiasing );
+    painter.setPen( QPen( Qt::black, 2.0 ));
+
+    const int rings = 1 + index % 3;
+    QPointF centre( 120.0 + this->random.bounded( 40.0 ), 110.0 + this->random.bounded( 40.0 ));
+    constexpr const qreal radius = 24.0;
+    for ( int y = 0; y < rings; y++ ) {
+        QPolygonF hexagon;
+        for ( int k = 0; k < 6; k++ ) {
+            const qreal angle = M_PI / 3.0 * k + M_PI / 6.0;
+            hexagon << centre + QPointF( radius * qCos( angle ), radius * qSin( angle ));
+        }
+        painter.drawPolygon( hexagon );
+
+        // substituent
+        const qreal angle = M_PI / 3.0 * static_cast<int>( this->random.bounded( 6 )) + M_PI / 6.0;
+        const QPointF from( centre + QPointF( radius * qCos( angle ), radius * qSin( angle )));
+        painter.drawLine( from, from + QPointF( radius * qCos( angle ), radius * qSin( angle )));
+
+        // fused ring
+        centre += QPointF( radius * qSqrt( 3.0 ), 0.0 );
+    }
+    painter.end();
+
+    QByteArray data;
+    QBuffer buffer( &data );
+    buffer.open( QIODevice::WriteOnly );
+    image.save( &buffer, "PNG" );
+    buffer.close();
+
+    return data;
+}
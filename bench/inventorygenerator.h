@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QByteArray>
+#include <QList>
+#include <QRandomGenerator>
+#include <QString>
+#include <QVariantMap>
+
+/**
+ * @brief The InventoryGenerator class writes a synthetic, reproducible inventory into an sqlite database
+ * (same seed and options always produce the same database)
+ */
+class InventoryGenerator final {
+    Q_DISABLE_COPY( InventoryGenerator )
+
+public:
+    /**
+     * @brief The Options struct
+     */
+    struct Options {
+        int reagents = 1000;
+        int batches = 3;
+        int properties = 8;
+        int labels = 2;
+        int formulas = 16;
+        quint32 seed = 1;
+
+        [[nodiscard]] QVariantMap toMap() const;
+    };
+
+    explicit InventoryGenerator( const Options &options ) : options( options ), random( options.seed ) {}
+
+    // disable move
+    InventoryGenerator( InventoryGenerator&& ) = delete;
+    InventoryGenerator& operator=( InventoryGenerator&& ) = delete;
+    ~InventoryGenerator() = default;
+
+    bool generate( const QString &path );
+    [[nodiscard]] QByteArray formula( int index ) const;
+
+private:
+    static constexpr const char *ConnectionName = "generator";
+    [[nodiscard]] QByteArray drawFormula( int index );
+
+    const Options options;
+    QRandomGenerator random;
+    QList<QByteArray> formulas;
+};
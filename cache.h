@@ -36,6 +36,7 @@ public:
     constexpr static const char *NameContext = "name";
     constexpr static const char *DataContext = "data";
     constexpr static const char *IdMapContext = "id";
+    constexpr static const char *ThumbnailContext = "thumbnail";
 
     /**
      * @brief The Types enum
@@ -30,6 +30,7 @@
 #include <QComboBox>
 #include <QMenu>
 #include <QSqlQuery>
+#include "querytracer.h"
 #include <QStringListModel>
 
 /**
@@ -113,14 +114,14 @@ bool CalcEdit::completeCommand() {
 
             Id parentId = Id::Invalid;
             if ( !parent.isEmpty()) {
-                query.exec( QString( "select %1, %2, %6 from %3 where %4=%5" )
+                if ( !QueryTracer::exec( query, QString( "select %1, %2, %6 from %3 where %4=%5" )
                                     .arg( Reagent::instance()->fieldName( Reagent::Name ),
                                           Reagent::instance()->fieldName( Reagent::Reference ),
                                           Reagent::instance()->tableName(),
                                           Reagent::instance()->fieldName( Reagent::ParentId ),
                                           QString::number( static_cast<int>( Id::Invalid )),
-                                          Reagent::instance()->fieldName( Reagent::ID ))
-                );
+                                          Reagent::instance()->fieldName( Reagent::ID )), "calcEdit" ))
+                    return false;
 
                 // append plainText names
                 while ( query.next()) {
@@ -139,13 +140,13 @@ bool CalcEdit::completeCommand() {
             // TODO: use references exclusively?
             //
             QStringList reagents;
-            query.exec( QString( "select %1, %2 from %3 where %4=%5" )
+            if ( !QueryTracer::exec( query, QString( "select %1, %2 from %3 where %4=%5" )
                                 .arg( Reagent::instance()->fieldName( Reagent::Name ),
                                       Reagent::instance()->fieldName( Reagent::Reference ),
                                       Reagent::instance()->tableName(),
                                       Reagent::instance()->fieldName( Reagent::ParentId ),
-                                      QString::number( static_cast<int>( parentId )))
-            );
+                                      QString::number( static_cast<int>( parentId ))), "calcEdit" ))
+                return false;
 
             // append plainText names
             while ( query.next()) {
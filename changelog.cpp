@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "changelog.h"
+#include "database.h"
+#include "reagent.h"
+#include "property.h"
+#include "variable.h"
+#include "main.h"
+#include "querytracer.h"
+#include <QCoreApplication>
+#include <QSqlError>
+#include <QUuid>
+
+/**
+ * @brief ChangeLog::ChangeLog
+ */
+ChangeLog::ChangeLog() : origin( QUuid::createUuid().toString()) {
+    // add to garbage collector
+    GarbageMan::instance()->add( this );
+
+    if ( !ChangeLog::isSharedMode())
+        return;
+
+    // NOTE: sequence is autoincrement so that numbers are never reused after pruning
+    QSqlQuery query;
+    if ( !QueryTracer::exec( query, QString( "create table if not exists %1 ( sequence integer primary key autoincrement, tableName text, rowId integer, operation integer, fieldId integer, origin text )" )
+                      .arg( ChangeLog::TableName ), "changelog" )) {
+        qCCritical( Database_::Debug ) << ChangeLog::tr( "could not create change log, reason - \"%1\"" ).arg( query.lastError().text());
+        return;
+    }
+
+    // models have just been loaded, so earlier changes are already applied
+    QueryTracer::exec( query, QString( "select max( sequence ) from %1" ).arg( ChangeLog::TableName ), "changelog" );
+    this->lastSequence = query.next() ? query.value( 0 ).toLongLong() : 0;
+    QueryTracer::exec( query, QString( "delete from %1 where sequence<=%2" ).arg( ChangeLog::TableName ).arg( this->lastSequence - ChangeLog::MaxEntries ), "changelog" );
+
+    this->insertQuery.prepare( QString( "insert into %1( tableName, rowId, operation, fieldId, origin ) values( ?, ?, ?, ?, ? )" ).arg( ChangeLog::TableName ));
+    for ( Table *table : Database::instance()->tableList())
+        this->watch( table );
+
+    // poll for changes made by other instances
+    ChangeLog::connect( &this->timer, &QTimer::timeout, this, &ChangeLog::poll );
+    this->timer.start( qMax( 100, Variable::integer( "database/pollInterval" )));
+    this->m_enabled = true;
+
+    qCInfo( Database_::Debug ) << ChangeLog::tr( "running in shared database mode" );
+}
+
+/**
+ * @brief ChangeLog::~ChangeLog
+ */
+ChangeLog::~ChangeLog() {
+    ChangeLog::disconnect( &this->timer, &QTimer::timeout, this, &ChangeLog::poll );
+    this->timer.stop();
+}
+
+/**
+ * @brief ChangeLog::isSharedMode returns true if shared mode is enabled in settings or with the --shared argument
+ * @return
+ */
+bool ChangeLog::isSharedMode() {
+    return Variable::isEnabled( "database/shared" ) || QCoreApplication::arguments().contains( "--shared" );
+}
+
+/**
+ * @brief ChangeLog::watch records modifications made through Table
+ * @param table
+ */
+void ChangeLog::watch( Table *table ) {
+    ChangeLog::connect( table, &Table::entryAdded, this, [ this, table ]( const Id &id ) { this->record( table, id, Insert ); } );
+    ChangeLog::connect( table, &Table::entryRemoved, this, [ this, table ]( const Id &id ) { this->record( table, id, Remove ); } );
+    ChangeLog::connect( table, &Table::entryChanged, this, [ this, table ]( const Id &id, int fieldId ) { this->record( table, id, Update, fieldId ); } );
+    ChangeLog::connect( table, &Table::invalidated, this, [ this, table ]() { this->record( table, Id::Invalid, Reset ); } );
+    ChangeLog::connect( table, &Table::orphansRemoved, this, [ this, table ]() { this->record( table, Id::Invalid, Reset ); } );
+}
+
+/**
+ * @brief ChangeLog::record
+ * @param table
+ * @param id
+ * @param operation
+ * @param fieldId
+ */
+void ChangeLog::record( const Table *table, const Id &id, Operations operation, int fieldId ) {
+    // do not echo changes made by other instances
+    if ( this->applying )
+        return;
+
+    this->insertQuery.addBindValue( table->tableName());
+    this->insertQuery.addBindValue( static_cast<int>( id ));
+    this->insertQuery.addBindValue( static_cast<int>( operation ));
+    this->insertQuery.addBindValue( fieldId );
+    this->insertQuery.addBindValue( this->origin );
+
+    if ( !QueryTracer::exec( this->insertQuery, "changelog" ))
+        qCWarning( Database_::Debug ) << ChangeLog::tr( "could not record change, reason - \"%1\"" ).arg( this->insertQuery.lastError().text());
+}
+
+/**
+ * @brief ChangeLog::poll applies changes made by other instances since the last poll
+ */
+void ChangeLog::poll() {
+    // NOTE: scrollable, so that returned rows are counted by the tracer before changes are applied
+    QSqlQuery query;
+    if ( !QueryTracer::exec( query, QString( "select sequence, tableName, rowId, operation, fieldId, origin from %1 where sequence>%2 order by sequence" )
+                      .arg( ChangeLog::TableName ).arg( this->lastSequence ), "changelog" ))
+        return;
+
+    // NOTE: changes are applied in order, so that batches are added after their parents
+    this->applying = true;
+    while ( query.next()) {
+        this->lastSequence = query.value( 0 ).toLongLong();
+        if ( query.value( 5 ).toString() == this->origin )
+            continue;
+
+        Table *table( Database::instance()->table( query.value( 1 ).toString()));
+        if ( table != nullptr )
+            this->apply( table, query.value( 2 ).value<Id>(), static_cast<Operations>( query.value( 3 ).toInt()), query.value( 4 ).toInt());
+    }
+    this->applyPending();
+    this->applying = false;
+}
+
+/**
+ * @brief ChangeLog::apply updates in-memory models with a single change
+ *
+ * Inserts, removals and reloads are only queued here and are applied once per poll
+ * by applyPending, so that each table is reselected at most once.
+ * @param table
+ * @param id
+ * @param operation
+ * @param fieldId
+ */
+void ChangeLog::apply( Table *table, const Id &id, Operations operation, int fieldId ) {
+    if ( !this->pendingTables.contains( table ))
+        this->pendingTables << table;
+
+    // small tables are simply reloaded
+    if ( table != Reagent::instance() && table != Property::instance()) {
+        this->pendingReloads << table;
+        return;
+    }
+
+    switch ( operation ) {
+    case Insert:
+        this->pendingInserts[table] << id;
+        break;
+
+    case Update:
+        // entries added within the same poll are selected with their latest values anyway
+        if ( this->pendingInserts.value( table ).contains( id ))
+            break;
+
+        // flags depend on tags and reagents of all properties
+        if ( table == Property::instance() && ( fieldId == Property::TagId || fieldId == Property::ReagentId ))
+            this->pendingReloads << table;
+        else
+            table->applyUpdate( id, fieldId );
+
+        if ( table == Reagent::instance())
+            emit this->reagentChanged( id, fieldId );
+        break;
+
+    case Remove:
+        // entries added and removed within the same poll are never selected
+        if ( this->pendingInserts[table].removeAll( id ) > 0 )
+            break;
+
+        if ( table == Reagent::instance())
+            emit this->reagentRemoved( id );
+
+        this->pendingRemoves[table] << id;
+        break;
+
+    case Reset:
+        this->pendingReloads << table;
+        break;
+    }
+}
+
+/**
+ * @brief ChangeLog::applyPending applies queued inserts, removals and reloads with a single select per table
+ */
+void ChangeLog::applyPending() {
+    for ( Table *table : qAsConst( this->pendingTables )) {
+        // reloading invalidates the table, so listeners do not need separate add/remove notifications
+        if ( this->pendingReloads.contains( table )) {
+            table->reload();
+            if ( table == Reagent::instance())
+                emit this->reagentsReset();
+
+            continue;
+        }
+
+        table->applyChanges( this->pendingInserts.value( table ), this->pendingRemoves.value( table ));
+
+        // batches are added after their parents (changes are queued in order)
+        if ( table == Reagent::instance()) {
+            for ( const Id &id : this->pendingInserts.value( table ))
+                emit this->reagentAdded( id );
+        }
+    }
+
+    this->pendingTables.clear();
+    this->pendingInserts.clear();
+    this->pendingRemoves.clear();
+    this->pendingReloads.clear();
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QSqlQuery>
+#include <QTimer>
+#include "table.h"
+
+/**
+ * @brief The ChangeLog class shares modifications between several instances using the same database
+ */
+class ChangeLog final : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( ChangeLog )
+
+public:
+    /**
+     * @brief The Operations enum
+     */
+    enum Operations {
+        Insert = 0,
+        Update,
+        Remove,
+        Reset
+    };
+    Q_ENUM( Operations )
+
+    // disable move
+    ChangeLog( ChangeLog&& ) = delete;
+    ChangeLog& operator=( ChangeLog&& ) = delete;
+
+    /**
+     * @brief instance
+     * @return
+     */
+    static ChangeLog *instance() {
+        static auto *instance( new ChangeLog());
+        return instance;
+    }
+    ~ChangeLog() override;
+
+    /**
+     * @brief isEnabled returns true if running in shared database mode
+     * @return
+     */
+    [[nodiscard]] bool isEnabled() const { return this->m_enabled; }
+    static bool isSharedMode();
+    static constexpr const char *TableName = "changeLog";
+    static constexpr int MaxEntries = 10000;
+
+public slots:
+    void poll();
+
+signals:
+    // reagent model is not part of the core, so it is updated through these
+    void reagentAdded( const Id &id );
+    void reagentChanged( const Id &id, int fieldId );
+    void reagentRemoved( const Id &id );
+    void reagentsReset();
+
+private:
+    explicit ChangeLog();
+    void watch( Table *table );
+    void record( const Table *table, const Id &id, Operations operation, int fieldId = -1 );
+    void apply( Table *table, const Id &id, Operations operation, int fieldId );
+    void applyPending();
+    bool m_enabled = false;
+    bool applying = false;
+    qint64 lastSequence = 0;
+    QString origin;
+    QSqlQuery insertQuery;
+    QTimer timer;
+    QList<Table*> pendingTables;
+    QHash<Table*, QList<Id>> pendingInserts;
+    QHash<Table*, QList<Id>> pendingRemoves;
+    QSet<Table*> pendingReloads;
+};
@@ -0,0 +1,541 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "batchevaluator.h"
+#include "cli.h"
+#include "core.h"
+#include "database.h"
+#include "pivottable.h"
+#include "property.h"
+#include "propertyextractor.h"
+#include "reagent.h"
+#include "script.h"
+#include "tableentry.h"
+#include "tag.h"
+#include "variable.h"
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <cstdio>
+#include <functional>
+
+/**
+ * @brief Cli::Cli
+ * @param arguments
+ */
+Cli::Cli( const QStringList &arguments ) : arguments( arguments ), out( stdout ), err( stderr ) {}
+
+/**
+ * @brief Cli::exec parses arguments and runs the requested command
+ * @return exit code
+ */
+int Cli::exec() {
+    QCommandLineParser parser;
+    parser.setApplicationDescription( Cli::tr( "Headless calculator, import and export tool for FumingCube databases" ));
+    parser.addHelpOption();
+    parser.addPositionalArgument( "command", Cli::tr( "eval, batch, import, export or bench" ));
+    parser.addPositionalArgument( "arguments", Cli::tr( "expressions (eval), expression template (batch), PubChem json files (import) or table name (export)" ), "[arguments...]" );
+
+    const QCommandLineOption databaseOption( QStringList() << "d" << "database", Cli::tr( "Database path (defaults to the one used by the application)" ), "path" );
+    const QCommandLineOption referenceOption( QStringList() << "r" << "reference", Cli::tr( "Reference of the imported reagent (single file only) or of a reagent to evaluate (batch, repeatable)" ), "reference" );
+    const QCommandLineOption outputOption( QStringList() << "o" << "output", Cli::tr( "Output file (stdout if omitted)" ), "file" );
+    const QCommandLineOption formatOption( QStringList() << "f" << "format", Cli::tr( "Export format (csv or json)" ), "format", "csv" );
+    const QCommandLineOption iterationsOption( QStringList() << "n" << "iterations", Cli::tr( "Benchmark iterations" ), "count", "100" );
+    const QCommandLineOption jobsOption( QStringList() << "j" << "jobs", Cli::tr( "Batch evaluation threads (all cores by default)" ), "count", "0" );
+    parser.addOptions( QList<QCommandLineOption>() << databaseOption << referenceOption << outputOption << formatOption << iterationsOption << jobsOption );
+    parser.process( this->arguments );
+
+    QStringList positional( parser.positionalArguments());
+    if ( positional.isEmpty()) {
+        this->err << parser.helpText();
+        return InvalidArguments;
+    }
+
+    const QString command( positional.takeFirst());
+    const QStringList commands( QStringList() << "eval" << "batch" << "import" << "export" << "bench" );
+    if ( !commands.contains( command )) {
+        this->err << Cli::tr( "unknown command \"%1\"" ).arg( command ) << endl;
+        return InvalidArguments;
+    }
+
+    if ( !this->open( parser.value( databaseOption ))) {
+        this->err << Cli::tr( "could not load database \"%1\"" ).arg( Variable::string( "databasePath" )) << endl;
+        return DatabaseError;
+    }
+
+    if ( !QString::compare( command, "eval" ))
+        return this->evaluate( positional );
+
+    if ( !QString::compare( command, "batch" )) {
+        if ( positional.count() != 1 ) {
+            this->err << Cli::tr( "batch requires a single expression template, for example \"molarMass($reagent)*assay($reagent,$batch)\"" ) << endl;
+            return InvalidArguments;
+        }
+
+        return this->batch( positional.first(), parser.values( referenceOption ), parser.value( outputOption ), parser.value( formatOption ), parser.value( jobsOption ).toInt());
+    }
+
+    if ( !QString::compare( command, "import" ))
+        return this->import( positional, parser.value( referenceOption ));
+
+    if ( !QString::compare( command, "export" )) {
+        if ( positional.count() != 1 ) {
+            this->err << Cli::tr( "export requires a single table name or id" ) << endl;
+            return InvalidArguments;
+        }
+
+        return this->exportTable( positional.first(), parser.value( outputOption ), parser.value( formatOption ));
+    }
+
+    return this->benchmark( qMax( 1, parser.value( iterationsOption ).toInt()), parser.value( outputOption ));
+}
+
+/**
+ * @brief Cli::open loads database and its tables
+ * NOTE: configuration is neither read nor written, so jobs cannot alter application settings
+ * @param databasePath
+ * @return
+ */
+bool Cli::open( const QString &databasePath ) {
+    Core::registerMetaTypes();
+    Core::addVariables();
+
+    // NOTE: an empty path makes Database fall back to the default location
+    if ( !databasePath.isEmpty())
+        Variable::setString( "databasePath", QFileInfo( databasePath ).absoluteFilePath());
+
+    Database::instance();
+    this->m_open = true;
+
+    return Core::loadTables();
+}
+
+/**
+ * @brief Cli::evaluate evaluates calculator expressions (one per line from stdin if none are given)
+ * @param expressions
+ * @return
+ */
+int Cli::evaluate( const QStringList &expressions ) {
+    QStringList list( expressions );
+    if ( list.isEmpty()) {
+        QTextStream in( stdin );
+        while ( !in.atEnd()) {
+            const QString line( in.readLine().trimmed());
+            if ( !line.isEmpty())
+                list << line;
+        }
+    }
+
+    int result = Success;
+    for ( const QString &expression : qAsConst( list )) {
+        const QJSValue value( Script::instance()->evaluate( expression ));
+        if ( value.isError()) {
+            this->err << expression << ": " << value.toString() << endl;
+            result = Failure;
+            continue;
+        }
+
+        this->out << value.toString() << endl;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Cli::batch evaluates an expression template for every reagent (or batch) and streams results
+ * NOTE: csv rows are written as soon as workers report them (in no particular order)
+ * @param expression
+ * @param references reagent set (all reagents if empty)
+ * @param fileName
+ * @param format
+ * @param threads
+ * @return
+ */
+int Cli::batch( const QString &expression, const QStringList &references, const QString &fileName, const QString &format, int threads ) {
+    const bool json = !QString::compare( format, "json", Qt::CaseInsensitive );
+    if ( !json && QString::compare( format, "csv", Qt::CaseInsensitive )) {
+        this->err << Cli::tr( "unsupported format \"%1\"" ).arg( format ) << endl;
+        return InvalidArguments;
+    }
+
+    QList<Id> reagentIds;
+    for ( const QString &reference : references ) {
+        const Id reagentId = Script::instance()->getReagentId( reference );
+        if ( reagentId == Id::Invalid ) {
+            this->err << Cli::tr( "reagent \"%1\" is not defined" ).arg( reference ) << endl;
+            return InvalidArguments;
+        }
+        reagentIds << reagentId;
+    }
+
+    QFile file( fileName );
+    if ( !json ) {
+        if ( !( fileName.isEmpty() ? file.open( stdout, QIODevice::WriteOnly ) : file.open( QIODevice::WriteOnly | QIODevice::Truncate ))) {
+            this->err << Cli::tr( "could not write \"%1\"" ).arg( fileName ) << endl;
+            return Failure;
+        }
+        file.write( "reference,name,batch,value,error\n" );
+    }
+
+    BatchEvaluator evaluator;
+    if ( threads > 0 )
+        evaluator.setThreadCount( threads );
+
+    QEventLoop loop;
+    QJsonArray array;
+    int count = 0, failed = 0;
+    QVector<BatchEvaluator::Entry> entries;
+    QObject::connect( &evaluator, &BatchEvaluator::resultsReady, &loop, [ & ]( const QList<BatchEvaluator::Result> &results ) {
+        QByteArray data;
+        for ( const BatchEvaluator::Result &result : results ) {
+            const BatchEvaluator::Entry &entry( entries.at( result.index ));
+            count++;
+            if ( !result.errorString.isEmpty())
+                failed++;
+
+            if ( json ) {
+                array << QJsonObject {
+                    { "reference", entry.reference },
+                    { "name", entry.name },
+                    { "batch", entry.batch },
+                    { "value", result.isNumber ? QJsonValue( result.number ) : QJsonValue( result.value ) },
+                    { "error", result.errorString }
+                };
+                continue;
+            }
+
+            data.append( QStringList { Cli::csvField( entry.reference ),
+                                       Cli::csvField( entry.name ),
+                                       Cli::csvField( entry.batch ),
+                                       Cli::csvField( result.value ),
+                                       Cli::csvField( result.errorString ) }.join( "," ).append( "\n" ).toUtf8());
+        }
+
+        if ( !json ) {
+            file.write( data );
+            file.flush();
+        }
+    } );
+    QObject::connect( &evaluator, &BatchEvaluator::finished, &loop, &QEventLoop::quit );
+
+    QElapsedTimer timer;
+    timer.start();
+    if ( !evaluator.start( expression, reagentIds )) {
+        this->err << evaluator.errorString() << endl;
+        return Failure;
+    }
+
+    // NOTE: results are queued to this thread, so entries are in place before the first one arrives
+    entries = evaluator.entries();
+    loop.exec();
+
+    this->err << Cli::tr( "%1 entries evaluated (%2 failed) in %3 ms using %4 threads" )
+                 .arg( count ).arg( failed ).arg( timer.elapsed()).arg( evaluator.threadCount()) << endl;
+
+    if ( json ) {
+        if ( !Cli::write( fileName, QJsonDocument( array ).toJson())) {
+            this->err << Cli::tr( "could not write \"%1\"" ).arg( fileName ) << endl;
+            return Failure;
+        }
+    } else {
+        file.close();
+    }
+
+    return Success;
+}
+
+/**
+ * @brief Cli::import adds reagents and their properties from PubChem (PUG View) json files
+ * @param fileNames
+ * @param reference
+ * @return
+ */
+int Cli::import( const QStringList &fileNames, const QString &reference ) {
+    if ( fileNames.isEmpty() || ( !reference.isEmpty() && fileNames.count() > 1 )) {
+        this->err << Cli::tr( "import requires json files (and a reference only for a single file)" ) << endl;
+        return InvalidArguments;
+    }
+
+    int result = Success;
+    Transaction transaction;
+    for ( const QString &fileName : fileNames ) {
+        QFile file( fileName );
+        if ( !file.open( QIODevice::ReadOnly )) {
+            this->err << Cli::tr( "could not open \"%1\"" ).arg( fileName ) << endl;
+            result = Failure;
+            continue;
+        }
+
+        QString errorString;
+        const QJsonValue document( PropertyExtractor::parse( file.readAll(), &errorString ));
+        file.close();
+        if ( document.isUndefined()) {
+            this->err << Cli::tr( "could not parse \"%1\": %2" ).arg( fileName, errorString ) << endl;
+            result = Failure;
+            continue;
+        }
+
+        // reagents are matched by reference (file name by default)
+        const QJsonObject record( document.toObject().value( "Record" ).toObject());
+        const int cid = record.value( "RecordNumber" ).toInt();
+        const QString name( record.value( "RecordTitle" ).toString( QFileInfo( fileName ).completeBaseName()));
+        const QString ref( reference.isEmpty() ? QFileInfo( fileName ).completeBaseName() : reference );
+
+        Id reagentId = Script::instance()->getReagentId( ref );
+        if ( reagentId == Id::Invalid ) {
+            const Row row = Reagent::instance()->add( name, ref, Id::Invalid, QDateTime::currentDateTime());
+            if ( row == Row::Invalid ) {
+                this->err << Cli::tr( "could not add reagent \"%1\"" ).arg( name ) << endl;
+                result = Failure;
+                continue;
+            }
+            reagentId = Reagent::instance()->id( row );
+        }
+
+        // first value of every extracted tag (existing properties are kept)
+        QMap<Id, QVariant> values;
+        const QMap<Id, QList<QStringList>> extracted( PropertyExtractor::extract( document ));
+        for ( auto it = extracted.constBegin(); it != extracted.constEnd(); ++it ) {
+            const QStringList candidate( it.value().first());
+            values[it.key()] = PropertyExtractor::propertyData( it.key(), candidate.mid( 1 ));
+        }
+
+        if ( cid > 0 ) {
+            for ( int y = 0; y < Tag::instance()->count(); y++ ) {
+                const auto row = static_cast<Row>( y );
+                if ( Tag::instance()->type( row ) == Tag::PubChemId )
+                    values[Tag::instance()->id( row )] = QString::number( cid );
+            }
+        }
+
+        int count = 0;
+        for ( auto it = values.constBegin(); it != values.constEnd(); ++it ) {
+            if ( !it.value().isValid() || Script::instance()->getPropertyValue( it.key(), reagentId ).isValid())
+                continue;
+
+            if ( Property::instance()->add( QString(), it.key(), it.value(), reagentId ) != Row::Invalid )
+                count++;
+        }
+
+        this->out << Cli::tr( "%1: %2 properties added to \"%3\"" ).arg( fileName ).arg( count ).arg( ref ) << endl;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Cli::exportTable writes a table (as shown in the table viewer) in csv or json format
+ * @param table name or id
+ * @param fileName
+ * @param format
+ * @return
+ */
+int Cli::exportTable( const QString &table, const QString &fileName, const QString &format ) {
+    const bool json = !QString::compare( format, "json", Qt::CaseInsensitive );
+    if ( !json && QString::compare( format, "csv", Qt::CaseInsensitive )) {
+        this->err << Cli::tr( "unsupported format \"%1\"" ).arg( format ) << endl;
+        return InvalidArguments;
+    }
+
+    const Id id = Cli::tableId( table );
+    if ( id == Id::Invalid ) {
+        this->err << Cli::tr( "unknown table \"%1\"" ).arg( table ) << endl;
+        return InvalidArguments;
+    }
+
+    // NOTE: pivot is built on the database thread, so this just waits for it
+    const QSharedPointer<PivotTable> pivot( PivotTable::fromTable( id ).result());
+    if ( pivot.isNull()) {
+        this->err << Cli::tr( "could not build table \"%1\"" ).arg( table ) << endl;
+        return Failure;
+    }
+
+    QStringList headers( QStringList() << Cli::tr( "Name" ));
+    const QList<Id> tagIds( pivot->tagIds());
+    for ( const Id &tagId : tagIds )
+        headers << Tag::instance()->name( tagId );
+
+    const QVector<int> rows( pivot->rows());
+    QByteArray data;
+    if ( json ) {
+        QJsonArray array;
+        for ( const int row : rows ) {
+            QJsonObject object;
+            for ( int column = -1; column < pivot->columnCount(); column++ )
+                object.insert( headers.at( column + 1 ), QJsonValue::fromVariant( pivot->sortKey( row, column )));
+
+            array << object;
+        }
+        data = QJsonDocument( array ).toJson();
+    } else {
+        QStringList lines;
+        QStringList fields;
+        for ( const QString &header : qAsConst( headers ))
+            fields << Cli::csvField( header );
+        lines << fields.join( "," );
+
+        for ( const int row : rows ) {
+            fields.clear();
+            for ( int column = -1; column < pivot->columnCount(); column++ )
+                fields << Cli::csvField( pivot->sortKey( row, column ).toString());
+
+            lines << fields.join( "," );
+        }
+        data = lines.join( "\n" ).append( "\n" ).toUtf8();
+    }
+
+    if ( !Cli::write( fileName, data )) {
+        this->err << Cli::tr( "could not write \"%1\"" ).arg( fileName ) << endl;
+        return Failure;
+    }
+
+    return Success;
+}
+
+/**
+ * @brief Cli::benchmark times core operations on the current database and writes results as json
+ * @param iterations
+ * @param fileName
+ * @return
+ */
+int Cli::benchmark( int iterations, const QString &fileName ) {
+    QJsonArray results;
+    auto measure = [ &results ]( const QString &name, int count, const std::function<void()> &function ) {
+        QElapsedTimer timer;
+        timer.start();
+        for ( int y = 0; y < count; y++ )
+            function();
+
+        results << QJsonObject {
+            { "name", name },
+            { "iterations", count },
+            { "nsPerIteration", static_cast<double>( timer.nsecsElapsed()) / count }
+        };
+    };
+
+    measure( "table/select", iterations, []() {
+        Reagent::instance()->select();
+        Property::instance()->select();
+    } );
+
+    QVector<Id> ids;
+    for ( int y = 0; y < Reagent::instance()->count(); y++ )
+        ids << Reagent::instance()->id( static_cast<Row>( y ));
+
+    measure( "table/rowById", iterations, [ &ids ]() {
+        for ( const Id &id : qAsConst( ids ))
+            Reagent::instance()->row( id );
+    } );
+
+    // a property function of the first reagent that has a reference
+    const QStringList functions( Tag::instance()->getFunctionList());
+    for ( int y = 0; y < Reagent::instance()->count() && !functions.isEmpty(); y++ ) {
+        const QString reference( Reagent::instance()->reference( static_cast<Row>( y )));
+        if ( reference.isEmpty())
+            continue;
+
+        const QString expression( QString( "%1(\"%2\")" ).arg( functions.first(), reference ));
+        measure( "script/evaluate", iterations, [ &expression ]() {
+            const QJSValue value( Script::instance()->evaluate( expression ));
+            Q_UNUSED( value )
+        } );
+        break;
+    }
+
+    // pivots are cached until data changes, so each is built once
+    for ( int y = 0; y < TableEntry::instance()->count(); y++ ) {
+        const Id id = TableEntry::instance()->id( static_cast<Row>( y ));
+        measure( QString( "pivot/%1" ).arg( TableEntry::instance()->name( id )), 1, [ id ]() {
+            PivotTable::fromTable( id ).waitForFinished();
+        } );
+    }
+
+    const QJsonObject object {
+        { "database", Variable::string( "databasePath" ) },
+        { "reagents", Reagent::instance()->count() },
+        { "properties", Property::instance()->count() },
+        { "qt", QString( qVersion()) },
+        { "results", results }
+    };
+
+    if ( !Cli::write( fileName, QJsonDocument( object ).toJson())) {
+        this->err << Cli::tr( "could not write \"%1\"" ).arg( fileName ) << endl;
+        return Failure;
+    }
+
+    return Success;
+}
+
+/**
+ * @brief Cli::tableId finds a table by its name or id
+ * @param table
+ * @return
+ */
+Id Cli::tableId( const QString &table ) {
+    for ( int y = 0; y < TableEntry::instance()->count(); y++ ) {
+        const auto row = static_cast<Row>( y );
+        if ( !QString::compare( TableEntry::instance()->name( row ), table ) ||
+             !QString::compare( QString::number( static_cast<int>( TableEntry::instance()->id( row ))), table ))
+            return TableEntry::instance()->id( row );
+    }
+
+    return Id::Invalid;
+}
+
+/**
+ * @brief Cli::write writes data to a file or stdout (if fileName is empty)
+ * @param fileName
+ * @param data
+ * @return
+ */
+bool Cli::write( const QString &fileName, const QByteArray &data ) {
+    QFile file( fileName );
+    if ( fileName.isEmpty()) {
+        if ( !file.open( stdout, QIODevice::WriteOnly ))
+            return false;
+    } else if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate )) {
+        return false;
+    }
+
+    const bool success = file.write( data ) == data.size();
+    file.close();
+
+    return success;
+}
+
+/**
+ * @brief Cli::csvField quotes a csv field if needed
+ * @param field
+ * @return
+ */
+QString Cli::csvField( const QString &field ) {
+    if ( !field.contains( QRegularExpression( "[\",\\n]" )))
+        return field;
+
+    return QString( "\"%1\"" ).arg( QString( field ).replace( "\"", "\"\"" ));
+}
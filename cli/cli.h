@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+#include "table.h"
+
+/**
+ * @brief The Cli class implements headless commands of fumingcube-cli on top of the core library
+ */
+class Cli final {
+    Q_DECLARE_TR_FUNCTIONS( Cli )
+    Q_DISABLE_COPY( Cli )
+
+public:
+    /**
+     * @brief The ExitCodes enum
+     */
+    enum ExitCodes {
+        Success = 0,
+        Failure,
+        InvalidArguments,
+        DatabaseError
+    };
+
+    explicit Cli( const QStringList &arguments );
+
+    // disable move
+    Cli( Cli&& ) = delete;
+    Cli& operator=( Cli&& ) = delete;
+    ~Cli() = default;
+
+    [[nodiscard]] int exec();
+
+    /**
+     * @brief isOpen
+     * @return
+     */
+    [[nodiscard]] bool isOpen() const { return this->m_open; }
+
+private:
+    [[nodiscard]] bool open( const QString &databasePath );
+    [[nodiscard]] int evaluate( const QStringList &expressions );
+    [[nodiscard]] int batch( const QString &expression, const QStringList &references, const QString &fileName, const QString &format, int threads );
+    [[nodiscard]] int import( const QStringList &fileNames, const QString &reference );
+    [[nodiscard]] int exportTable( const QString &table, const QString &fileName, const QString &format );
+    [[nodiscard]] int benchmark( int iterations, const QString &fileName );
+    [[nodiscard]] static Id tableId( const QString &table );
+    [[nodiscard]] static bool write( const QString &fileName, const QByteArray &data );
+    [[nodiscard]] static QString csvField( const QString &field );
+
+    const QStringList arguments;
+    QTextStream out;
+    QTextStream err;
+    bool m_open = false;
+};
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "cli.h"
+#include "database.h"
+#include "main.h"
+#include "variable.h"
+#include <QCoreApplication>
+
+/**
+ * @brief main
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main( int argc, char *argv[] ) {
+    // NOTE: no display server is required, since only the core library is used
+    QCoreApplication a( argc, argv );
+    QCoreApplication::setApplicationName( "fumingcube-cli" );
+
+    Cli cli( QCoreApplication::arguments());
+    const int result = cli.exec();
+
+    // clean up
+    GarbageMan::instance()->clear();
+    delete GarbageMan::instance();
+
+    // NOTE: database is not created for invalid arguments or --help
+    if ( cli.isOpen())
+        delete Database::instance();
+
+    delete Variable::instance();
+    return result;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "batchevaluator.h"
+#include "core.h"
+#include "database.h"
+#include "label.h"
+#include "labelset.h"
+#include "property.h"
+#include "reagent.h"
+#include "table.h"
+#include "tableentry.h"
+#include "tableproperty.h"
+#include "tag.h"
+#include "variable.h"
+#include <QLocale>
+
+/**
+ * @brief Core::registerMetaTypes
+ */
+void Core::registerMetaTypes() {
+    //qRegisterMetaType<Reagent::Fields>();
+    qRegisterMetaType<Id>();
+    qRegisterMetaType<Row>();
+    qRegisterMetaType<Table::Roles>();
+    qRegisterMetaType<QList<BatchEvaluator::Result>>( "QList<BatchEvaluator::Result>" );
+}
+
+/**
+ * @brief Core::addVariables sets variable defaults (must be called before reading configuration)
+ * @param history initial calculator history (compressed)
+ */
+void Core::addVariables( const QString &history ) {
+    Variable::add( "databasePath", "", Var::Flag::Hidden );
+    Variable::add( "database/journalMode", "WAL", Var::Flag::ReadOnly | Var::Flag::Hidden );
+    Variable::add( "database/synchronous", "NORMAL", Var::Flag::ReadOnly | Var::Flag::Hidden );
+    Variable::add( "database/mmapSize", 64 * 1024 * 1024, Var::Flag::ReadOnly | Var::Flag::Hidden );
+    Variable::add( "database/cacheSize", -8192, Var::Flag::ReadOnly | Var::Flag::Hidden );
+    Variable::add( "database/tempStore", "MEMORY", Var::Flag::ReadOnly | Var::Flag::Hidden );
+    Variable::add( "database/shared", false, Var::Flag::ReadOnly | Var::Flag::Hidden );
+    Variable::add( "database/pollInterval", 1000, Var::Flag::ReadOnly | Var::Flag::Hidden );
+    Variable::add( "database/slowQueryThreshold", 50, Var::Flag::ReadOnly | Var::Flag::Hidden );
+    Variable::add( "calculator/commands", "", Var::Flag::ReadOnly );
+    Variable::add( "calculator/history", history, Var::Flag::ReadOnly );
+    Variable::add( "calculator/ans", "", Var::Flag::ReadOnly );
+    Variable::add( "calculator/theme", "", Var::Flag::ReadOnly | Var::Flag::Hidden );
+    Variable::add( "calculator/zoom", 1.0, Var::Flag::ReadOnly | Var::Flag::Hidden );
+    Variable::add( "mainWindow/geometry", QByteArray(), Var::Flag::ReadOnly );
+    Variable::add( "mainWindow/state", QByteArray(), Var::Flag::ReadOnly );
+    Variable::add( "reagentDock/selection", -1, Var::Flag::Hidden );
+    Variable::add( "reagentDock/openNodes", "", Var::Flag::Hidden );
+    Variable::add( "reagentDock/hiddenNodes", "", Var::Flag::Hidden );
+    Variable::add( "reagentDock/deprecatedNodes", "", Var::Flag::Hidden );
+    Variable::add( "propertyDock/hiddenTags", "", Var::Flag::Hidden );
+    Variable::add( "darkMode", false, Var::Flag::ReadOnly | Var::Flag::Hidden | Var::Flag::NoSave );
+    Variable::add( "overrideTheme", false, Var::Flag::ReadOnly | Var::Flag::Hidden );
+    Variable::add( "theme", "light", Var::Flag::ReadOnly | Var::Flag::Hidden );
+    Variable::add( "fetchPropertiesOnAddition", false, Var::Flag::ReadOnly | Var::Flag::Hidden );
+    Variable::add( "alwaysOnTop", false, Var::Flag::ReadOnly | Var::Flag::Hidden );
+    Variable::add( "decimalSeparator", QString( QLocale::system().decimalPoint()), Var::Flag::Hidden );
+    Variable::add( "searchFragment/history", "", Var::Flag::ReadOnly );
+    Variable::add( "propertyFragment/selectedTags", "", Var::Flag::Hidden );
+    Variable::add( "labelDock/selectedRows", "", Var::Flag::Hidden );
+    Variable::add( "labelDock/matchAll", false, Var::Flag::Hidden );
+}
+
+/**
+ * @brief Core::loadTables adds tables to the database and populates built-in tags and labels
+ * @return
+ */
+bool Core::loadTables() {
+    bool success = true;
+    success &= Database::instance()->add( Reagent::instance());
+    success &= Database::instance()->add( Property::instance());
+    success &= Database::instance()->add( Tag::instance());
+    success &= Database::instance()->add( Label::instance());
+
+    // these are not needed for the first paint, so they are selected on first use
+    success &= Database::instance()->add( LabelSet::instance(), true );
+    success &= Database::instance()->add( TableEntry::instance(), true );
+    success &= Database::instance()->add( TableProperty::instance(), true );
+
+    if ( !Tag::instance()->count())
+        Tag::instance()->populate();
+
+    if ( !Label::instance()->count())
+        Label::instance()->populate();
+
+    Tag::instance()->sort( Tag::Name, Qt::AscendingOrder );
+    //Tag::instance()->select();
+
+    return success;
+}
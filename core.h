@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QString>
+
+/**
+ * @brief The Core class sets up variables and tables shared by the application and its tools
+ */
+class Core final {
+    Q_DISABLE_COPY( Core )
+
+public:
+    // disable move
+    Core( Core&& ) = delete;
+    Core& operator=( Core&& ) = delete;
+
+    static void registerMetaTypes();
+    static void addVariables( const QString &history = QString());
+    [[nodiscard]] static bool loadTables();
+
+private:
+    explicit Core() {}
+};
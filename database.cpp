@@ -22,14 +22,16 @@
 #include <QDir>
 #include <QSqlQuery>
 #include <QSqlError>
-#include <QApplication>
+#include <QSqlRecord>
+#include <QCoreApplication>
 #include <QTime>
 #include "database.h"
 #include "table.h"
 #include "field.h"
 #include "main.h"
 #include "variable.h"
-#include "mainwindow.h"
+#include "startupprofiler.h"
+#include "querytracer.h"
 
 /**
  * @brief Database::testPath checks if provided database path is valid and creates non-existent sub-directories
@@ -111,20 +113,81 @@ Database::Database( QObject *parent ) : QObject( parent ) {
     database.setHostName( "localhost" );
     database.setDatabaseName( QFileInfo( file ).absoluteFilePath());
 
+    // wait for other instances instead of failing with SQLITE_BUSY
+    database.setConnectOptions( "QSQLITE_BUSY_TIMEOUT=5000" );
+
     // set path and open
     if ( !database.open())
         qFatal( QT_TR_NOOP_UTF8( "could not load database" ) );
 
+    // set journal mode, sync level and caching
+    Database::configure( database );
+
     // done
     this->setInitialised();
 }
 
 /**
- * @brief Database::removeOrphanedEntries removes orphaned entries in database tables
+ * @brief Database::pragmas returns connection pragmas from settings
+ * @return
  */
-void Database::removeOrphanedEntries() {
-    for ( Table *table : qAsConst( this->tables ))
-        table->removeOrphanedEntries();
+QStringList Database::pragmas() {
+    return QStringList()
+            << QString( "journal_mode=%1" ).arg( Variable::string( "database/journalMode" ))
+            << QString( "synchronous=%1" ).arg( Variable::string( "database/synchronous" ))
+            << QString( "mmap_size=%1" ).arg( Variable::integer( "database/mmapSize" ))
+            << QString( "cache_size=%1" ).arg( Variable::integer( "database/cacheSize" ))
+            << QString( "temp_store=%1" ).arg( Variable::string( "database/tempStore" ))
+            << "foreign_keys=on";
+}
+
+/**
+ * @brief Database::configure applies pragmas to the given connection
+ * @param database
+ * @param pragmas
+ */
+void Database::configure( QSqlDatabase &database, const QStringList &pragmas ) {
+    QSqlQuery query( database );
+
+    // NOTE: unsupported values are ignored by sqlite, so failures are only logged
+    for ( const QString &pragma : pragmas ) {
+        if ( !QueryTracer::exec( query, QString( "pragma %1" ).arg( pragma ), "database" ))
+            qCWarning( Database_::Debug ) << Database::tr( R"(could not set pragma "%1", reason - "%2")" ).arg( pragma, query.lastError().text());
+    }
+}
+
+/**
+ * @brief Database::beginTransaction starts a transaction (nested calls join the outermost one)
+ * @return
+ */
+bool Database::beginTransaction() {
+    if ( this->transactionDepth++ > 0 )
+        return true;
+
+    if ( !QSqlDatabase::database().transaction()) {
+        qCWarning( Database_::Debug ) << Database::tr( "could not begin transaction, reason - \"%1\"" ).arg( QSqlDatabase::database().lastError().text());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Database::commit commits the outermost transaction
+ * @return
+ */
+bool Database::commit() {
+    if ( this->transactionDepth <= 0 || --this->transactionDepth > 0 )
+        return true;
+
+    QSqlDatabase database( QSqlDatabase::database());
+    if ( !database.commit()) {
+        qCCritical( Database_::Debug ) << Database::tr( "could not commit transaction, reason - \"%1\"" ).arg( database.lastError().text());
+        database.rollback();
+        return false;
+    }
+
+    return true;
 }
 
 /**
@@ -134,8 +197,7 @@ Database::~Database() {
     QString connectionName;
     bool open = false;
 
-    // remove orphans
-    this->removeOrphanedEntries();
+    // NOTE: orphans are removed by sqlite through foreign keys, so there is no need to sweep tables on exit
 
     // announce
     qCInfo( Database_::Debug ) << Database::tr( "unloading database" );
@@ -167,11 +229,135 @@ Database::~Database() {
         QSqlDatabase::removeDatabase( connectionName );
 }
 
+/**
+ * @brief Database::schema returns column definitions and constraints of the given table
+ * @param table
+ * @return
+ */
+QString Database::schema( const Table *table ) const {
+    QString statement;
+
+    // prepare statement
+    for ( const Field &field : qAsConst( table->fields )) {
+        statement.append( QString( "%1 %2" ).arg( field->name(), field->format()));
+
+        if ( field->isUnique())
+            statement.append( " unique" );
+
+        if ( QString::compare( field->name(), table->fields.last()->name()))
+            statement.append( ", " );
+    }
+
+    // check for constraints
+    QString constraints;
+    const int tc = table->constraints.count();
+
+    if ( tc > 0 ) {
+        for ( int y = 0; y < table->constraints.count(); y++ ) {
+            constraints.append( "unique( " );
+
+            const int cc = table->constraints.at( y ).count();
+            for ( int k = 0; k < cc; k++ ) {
+                const QSharedPointer<Field_> field( table->constraints.at( y ).at( k ));
+                constraints.append( field->name());
+                constraints.append( k == cc - 1 ? " )" : ", " );
+
+            }
+
+            if ( y < tc - 1 )
+                constraints.append( ", " );
+        }
+
+        statement.append( ", " );
+        statement.append( constraints );
+    }
+
+    // add foreign keys
+    for ( const Table::ForeignKey &key : qAsConst( table->foreignKeys )) {
+        if ( key.sentinels )
+            continue;
+
+        statement.append( QString( ", foreign key( %1 ) references %2( %3 ) on delete cascade" )
+                          .arg( key.field->name(), key.parent->tableName(), key.parent->primaryField()->name()));
+    }
+
+    return statement;
+}
+
+/**
+ * @brief Database::migrate rebuilds a table with foreign keys, dropping orphaned entries
+ * @param table
+ * @return
+ */
+bool Database::migrate( const Table *table ) {
+    qCInfo( Database_::Debug ) << Database::tr( "adding foreign keys to table - \"%1\"" ).arg( table->tableName());
+
+    QStringList columns;
+    for ( const Field &field : qAsConst( table->fields ))
+        columns << field->name();
+
+    // only entries that reference existing parents are kept
+    QStringList conditions;
+    for ( const Table::ForeignKey &key : qAsConst( table->foreignKeys )) {
+        conditions << QString( "%1%2 in ( select %3 from %4 )" )
+                      .arg( key.sentinels ? QString( "%1<0 or " ).arg( key.field->name()) : QString(),
+                            key.field->name(), key.parent->primaryField()->name(), key.parent->tableName());
+    }
+
+    // NOTE: foreign keys cannot be toggled within a transaction
+    QSqlQuery query;
+    QueryTracer::exec( query, "pragma foreign_keys=off", "database" );
+
+    const QString temporary( table->tableName() + "_migration" );
+    const QStringList statements( QStringList()
+                                  << QString( "create table %1 ( %2 )" ).arg( temporary, this->schema( table ))
+                                  << QString( "insert into %1 ( %2 ) select %2 from %3 where ( %4 )" )
+                                     .arg( temporary, columns.join( ", " ), table->tableName(), conditions.join( " ) and ( " ))
+                                  << QString( "drop table %1" ).arg( table->tableName())
+                                  << QString( "alter table %1 rename to %2" ).arg( temporary, table->tableName()));
+
+    bool success = QSqlDatabase::database().transaction();
+    for ( const QString &statement : statements ) {
+        if ( !success )
+            break;
+
+        success = QueryTracer::exec( query, statement, "database" );
+        if ( !success )
+            qCCritical( Database_::Debug ) << Database::tr( R"(could not migrate table - "%1", reason - "%2")" ).arg( table->tableName(), query.lastError().text());
+    }
+
+    if ( success )
+        QSqlDatabase::database().commit();
+    else
+        QSqlDatabase::database().rollback();
+
+    QueryTracer::exec( query, "pragma foreign_keys=on", "database" );
+    return success;
+}
+
+/**
+ * @brief Database::addTriggers creates cascade triggers for sentinel keys of all registered tables
+ */
+void Database::addTriggers() {
+    QSqlQuery query;
+
+    for ( const Table *table : qAsConst( this->tables )) {
+        for ( const Table::ForeignKey &key : qAsConst( table->foreignKeys )) {
+            if ( !key.sentinels || !this->tables.contains( key.parent->tableName()))
+                continue;
+
+            QueryTracer::exec( query, QString( "create trigger if not exists %1_%2_cascade after delete on %3 begin delete from %1 where %2=old.%4; end" )
+                        .arg( table->tableName(), key.field->name(), key.parent->tableName(), key.parent->primaryField()->name()), "database" );
+        }
+    }
+}
+
 /**
  * @brief Database::add adds and validates Table instance to database
  * @param table Table instance (QSqlTableModel)
+ * @param lazy defer selecting data until first use
  */
-bool Database::add( Table *table ) {
+bool Database::add( Table *table, bool lazy ) {
     QSqlDatabase database( QSqlDatabase::database());
     const QStringList tableList( database.tables());
 
@@ -186,9 +372,11 @@ bool Database::add( Table *table ) {
     bool found = false;
     for ( const QString &tableName : tableList ) {
         if ( !QString::compare( table->tableName(), tableName )) {
+            // NOTE: each record() call runs a pragma table_info query, so it is read once
+            const QSqlRecord record( database.record( table->tableName()));
             for ( const Field &field : qAsConst( table->fields )) {
 
-                if ( !database.record( table->tableName()).contains( field->name())) {
+                if ( !record.contains( field->name())) {
                     qCCritical( Database_::Debug )
                         << Database::tr( R"(database field mismatch in table "%1", field - "%2")" ).arg( tableName, field->name());
                     return false;
@@ -196,7 +384,7 @@ bool Database::add( Table *table ) {
 
                 // ignore unsigned ints for now
                 const QVariant::Type internalType = field->type() == QVariant::UInt ? QVariant::Int : field->type();
-                const QVariant::Type databaseType = database.record( table->tableName()).field( field->id()).type();
+                const QVariant::Type databaseType = record.field( field->id()).type();
 
                 if ( internalType != databaseType ) {
                     qCCritical( Database_::Debug )
@@ -209,66 +397,48 @@ bool Database::add( Table *table ) {
         }
     }
 
-    QString statement;
     QSqlQuery query;
-
     if ( !found ) {
         // announce
         qCInfo( Database_::Debug ) << Database::tr( "creating an empty table - \"%1\"" ).arg( table->tableName());
 
-        // prepare statement
-        for ( const Field &field : qAsConst( table->fields )) {
-            statement.append( QString( "%1 %2" ).arg( field->name(), field->format()));
-
-            if ( field->isUnique())
-                statement.append( " unique" );
-
-            if ( QString::compare( field->name(), table->fields.last()->name()))
-                statement.append( ", " );
-        }
-
-        // check for constraints
-        QString constraints;
-        const int tc = table->constraints.count();
-
-        if ( tc > 0 ) {
-            for ( int y = 0; y < table->constraints.count(); y++ ) {
-                constraints.append( "unique( " );
-
-                const int cc = table->constraints.at( y ).count();
-                for ( int k = 0; k < cc; k++ ) {
-                    const QSharedPointer<Field_> field( table->constraints.at( y ).at( k ));
-                    constraints.append( field->name());
-                    constraints.append( k == cc - 1 ? " )" : ", " );
-
-                }
-
-                if ( y < tc - 1 )
-                    constraints.append( ", " );
-            }
-
-            statement.append( ", " );
-            statement.append( constraints );
-        }
-
-        if ( !query.exec( QString( "create table if not exists %1 ( %2 )" ).arg( table->tableName(), statement )))
+        if ( !QueryTracer::exec( query, QString( "create table if not exists %1 ( %2 )" ).arg( table->tableName(), this->schema( table )), "database" ))
             qCCritical( Database_::Debug )
                 << Database::tr( R"(could not create table - "%1", reason - "%2")" ).arg( table->tableName(), query.lastError().text());
+    } else {
+        // tables created before foreign keys were declared must be rebuilt
+        QueryTracer::exec( query, QString( "pragma foreign_key_list( %1 )" ).arg( table->tableName()), "database" );
+        int keys = 0;
+        while ( query.next())
+            keys++;
+
+        int declared = 0;
+        for ( const Table::ForeignKey &key : qAsConst( table->foreignKeys ))
+            declared += key.sentinels ? 0 : 1;
+
+        if ( keys < declared )
+            this->migrate( table );
     }
 
+    // sentinel keys are cascaded with triggers, which require both tables to exist
+    this->addTriggers();
+
     // table has been verified and is marked as valid
     table->setValid();
 
     // create table model
     table->setTable( table->tableName());
 
-    // load data
-    if ( !table->select()) {
+    // load data (lazy tables are selected on first use)
+    if ( lazy ) {
+        table->m_loaded = false;
+    } else if ( !table->select()) {
         qCCritical( Database_::Debug )
             << Database::tr( "could not initialize model for table - \"%1\"" ).arg( table->tableName());
         table->setValid( false );
     }
 
+    StartupProfiler::instance()->mark( QString( "table %1" ).arg( table->tableName()));
     return true;
 }
 
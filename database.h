@@ -61,7 +61,7 @@ public:
         return instance;
     }
     ~Database() override;
-    bool add( Table *table );
+    bool add( Table *table, bool lazy = false );
 
     /**
      * @brief hasInitialised
@@ -69,12 +69,29 @@ public:
      */
     [[nodiscard]] bool hasInitialised() const { return this->m_initialised; }
 
-public slots:
-    void removeOrphanedEntries();
+    /**
+     * @brief table returns table by its name
+     * @param tableName
+     * @return
+     */
+    [[nodiscard]] Table *table( const QString &tableName ) const { return this->tables.value( tableName, nullptr ); }
+
+    /**
+     * @brief tableList
+     * @return
+     */
+    [[nodiscard]] QList<Table *> tableList() const { return this->tables.values(); }
+    bool beginTransaction();
+    bool commit();
+    [[nodiscard]] static QStringList pragmas();
+    static void configure( QSqlDatabase &database, const QStringList &pragmas = Database::pragmas());
 
 private:
     explicit Database( QObject *parent = nullptr );
     bool testPath( const QString &path );
+    [[nodiscard]] QString schema( const Table *table ) const;
+    bool migrate( const Table *table );
+    void addTriggers();
 
     /**
      * @brief setInitialised
@@ -88,4 +105,27 @@ private:
      */
     QMap<QString, Table *> tables;
     bool m_initialised = false;
+    int transactionDepth = 0;
+};
+
+/**
+ * @brief The Transaction class coalesces all writes made during its lifetime into a single commit
+ */
+class Transaction final {
+    Q_DISABLE_COPY( Transaction )
+
+public:
+    /**
+     * @brief Transaction
+     */
+    explicit Transaction() { Database::instance()->beginTransaction(); }
+
+    // disable move
+    Transaction( Transaction&& ) = delete;
+    Transaction& operator=( Transaction&& ) = delete;
+
+    /**
+     * @brief ~Transaction
+     */
+    ~Transaction() { Database::instance()->commit(); }
 };
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "databaseservice.h"
+#include "database.h"
+#include "main.h"
+#include <QDebug>
+#include <QSqlError>
+
+/**
+ * @brief DatabaseWorker::execute
+ * @param job
+ */
+void DatabaseWorker::execute( const DatabaseWorker::Job &job ) {
+    // NOTE: connections can only be used in the thread that created them, so open it lazily here
+    QSqlDatabase database( QSqlDatabase::database( DatabaseWorker::ConnectionName, false ));
+    if ( !database.isValid()) {
+        database = QSqlDatabase::addDatabase( "QSQLITE", DatabaseWorker::ConnectionName );
+        database.setDatabaseName( this->databaseName );
+        database.setConnectOptions( "QSQLITE_BUSY_TIMEOUT=5000" );
+    }
+
+    if ( !database.isOpen()) {
+        if ( !database.open())
+            qCWarning( Database_::Debug ) << DatabaseWorker::tr( "could not open worker connection, reason - \"%1\"" ).arg( database.lastError().text());
+        else
+            Database::configure( database, this->pragmas );
+    }
+
+    job( database );
+}
+
+/**
+ * @brief DatabaseWorker::close
+ */
+void DatabaseWorker::close() {
+    {
+        QSqlDatabase database( QSqlDatabase::database( DatabaseWorker::ConnectionName, false ));
+        if ( !database.isValid())
+            return;
+
+        database.close();
+    }
+
+    QSqlDatabase::removeDatabase( DatabaseWorker::ConnectionName );
+}
+
+/**
+ * @brief DatabaseService::DatabaseService
+ */
+DatabaseService::DatabaseService() : worker( new DatabaseWorker( QSqlDatabase::database().databaseName(), Database::pragmas())) {
+    qRegisterMetaType<DatabaseWorker::Job>( "DatabaseWorker::Job" );
+
+    // jobs are executed one by one in the order they were posted
+    this->worker->moveToThread( &this->thread );
+    DatabaseService::connect( this, &DatabaseService::posted, this->worker, &DatabaseWorker::execute, Qt::QueuedConnection );
+    DatabaseService::connect( &this->thread, &QThread::finished, this->worker, &QObject::deleteLater );
+    this->thread.setObjectName( "database" );
+    this->thread.start();
+
+    // add to garbage collector
+    GarbageMan::instance()->add( this );
+}
+
+/**
+ * @brief DatabaseService::~DatabaseService
+ */
+DatabaseService::~DatabaseService() {
+    // close connection in its own thread, then stop
+    QMetaObject::invokeMethod( this->worker, "close", Qt::BlockingQueuedConnection );
+    this->thread.quit();
+    this->thread.wait();
+}
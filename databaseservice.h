@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QFuture>
+#include <QFutureInterface>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QThread>
+#include <functional>
+
+/**
+ * @brief The DatabaseWorker class executes jobs on the service thread using its own connection
+ */
+class DatabaseWorker final : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( DatabaseWorker )
+
+public:
+    using Job = std::function<void( QSqlDatabase & )>;
+
+    explicit DatabaseWorker( const QString &databaseName, const QStringList &pragmas ) : databaseName( databaseName ), pragmas( pragmas ) {}
+
+    // disable move
+    DatabaseWorker( DatabaseWorker&& ) = delete;
+    DatabaseWorker& operator=( DatabaseWorker&& ) = delete;
+    ~DatabaseWorker() override = default;
+
+    static constexpr const char *ConnectionName = "worker";
+
+public slots:
+    void execute( const DatabaseWorker::Job &job );
+    void close();
+
+private:
+    QString databaseName;
+    QStringList pragmas;
+};
+Q_DECLARE_METATYPE( DatabaseWorker::Job )
+
+/**
+ * @brief The DatabaseService class runs queries off the GUI thread and returns their results as futures
+ */
+class DatabaseService final : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( DatabaseService )
+
+public:
+    // disable move
+    DatabaseService( DatabaseService&& ) = delete;
+    DatabaseService& operator=( DatabaseService&& ) = delete;
+
+    /**
+     * @brief instance
+     * @return
+     */
+    static DatabaseService *instance() {
+        static auto *instance( new DatabaseService());
+        return instance;
+    }
+    ~DatabaseService() override;
+
+    /**
+     * @brief run executes a function on the service thread (function must poll interface for cancellation)
+     * @param function T function( QSqlDatabase &database, const QFutureInterfaceBase &interface )
+     * @return
+     */
+    template<typename T, typename Function>
+    [[nodiscard]] QFuture<T> run( Function function ) {
+        QFutureInterface<T> interface;
+        interface.reportStarted();
+
+        emit this->posted( [ interface, function ]( QSqlDatabase &database ) mutable {
+            // skip jobs that were cancelled while queued
+            if ( !interface.isCanceled())
+                interface.reportResult( function( database, interface ));
+
+            interface.reportFinished();
+        } );
+
+        return interface.future();
+    }
+
+signals:
+    void posted( const DatabaseWorker::Job &job );
+
+private:
+    explicit DatabaseService();
+    QThread thread;
+    DatabaseWorker *worker;
+};
@@ -87,11 +87,19 @@ QSize GHSWidget::sizeHint() const {
         return QSize( GHSWidget::scale * this->parameters().count(), GHSWidget::scale );
     }
 
-    const int sectionSize = PropertyDock::instance()->sectionSize( Property::PropertyData );
-    if ( sectionSize == 0 )
+    return this->sizeForWidth( PropertyDock::instance()->sectionSize( Property::PropertyData ));
+}
+
+/**
+ * @brief GHSWidget::sizeForWidth wraps pictograms into rows that fit the given width
+ * @param width
+ * @return
+ */
+QSize GHSWidget::sizeForWidth( int width ) const {
+    if ( width == 0 )
         return QSize();
 
-    this->m_iconsPerRow = qMax( 1, ( sectionSize - ( sectionSize % GHSWidget::scale )) / GHSWidget::scale );
+    this->m_iconsPerRow = qMax( 1, ( width - ( width % GHSWidget::scale )) / GHSWidget::scale );
     const int numIcons = this->parameters().count();
     const int rows = ( numIcons - ( numIcons % this->iconsPerRow())) / this->iconsPerRow() +
                      ( numIcons % this->iconsPerRow() > 0 ? 1 : 0 );
@@ -100,5 +108,5 @@ QSize GHSWidget::sizeHint() const {
     for ( int y = 1; y < rows; y++ )
         height += GHSWidget::scale;
 
-    return QSize( this->parameters().count() * GHSWidget::scale, qAsConst( height ));
+    return QSize( qMin( numIcons, this->iconsPerRow()) * GHSWidget::scale, qAsConst( height ));
 }
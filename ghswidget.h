@@ -40,6 +40,8 @@ public:
      */
     [[nodiscard]] int iconsPerRow() const { return this->m_iconsPerRow; }
     static const int scale;
+    [[nodiscard]] QSize sizeHint() const override;
+    [[nodiscard]] QSize sizeForWidth( int width ) const;
 
 public slots:
     /**
@@ -55,17 +57,17 @@ public slots:
      * @brief setLinear
      */
     void setLinear() { this->m_linear = true; }
+
+    /**
+     * @brief setParameters sets parameters without triggering a repaint (used by delegates)
+     * @param parms
+     */
+    void setParameters( const QStringList &parms ) { this->m_parameters = parms; }
     void paint( QPainter *painter, const qreal devicePixelRatio = 1.0 ) const;
 
 protected:
     void paintEvent( QPaintEvent * ) override;
 
-    /**
-     * @brief sizeHint
-     * @return
-     */
-    [[nodiscard]] QSize sizeHint() const override;
-
     /**
      * @brief minimumSizeHint
      * @return
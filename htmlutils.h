@@ -21,7 +21,7 @@
 /*
  * includes
  */
-#include <QTextEdit>
+#include <QString>
 
 /**
  * @brief The HTMLUtils class
@@ -37,6 +37,7 @@ public:
     [[nodiscard]] static QString simplify( const QString &html );
     [[nodiscard]] static QString toPlainText( const QString &html );
     [[nodiscard]] static QString captureBody( const QString &html );
+    [[nodiscard]] static uint entity( const QString &name );
 
 private:
     explicit HTMLUtils() {}
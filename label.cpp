@@ -24,11 +24,13 @@
 #include "field.h"
 #include "database.h"
 #include "variable.h"
-#include "listutils.h"
+#include "variablehandle.h"
 #include <QPixmap>
 #include <QPainter>
 #include <QSqlQuery>
-#include <QApplication>
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QPalette>
 
 /**
  * @brief Label::Label
@@ -63,13 +65,13 @@ QVariant Label::data( const QModelIndex &index, int role ) const {
     if ( role == Qt::DisplayRole ) {
         // NOTE: for now use this i18n method, in future replace with something better
         const QString originalString( Table::data( index, role ).toString());
-        return QApplication::translate( "Label", originalString.toUtf8().constData());
+        return QCoreApplication::translate( "Label", originalString.toUtf8().constData());
     }
 
     if ( role == Qt::BackgroundRole ) {
-        const QList<int> rows( ListUtils::toNumericList<int>( Variable::string( "labelDock/selectedRows" ).split( ";" )));
-        if ( rows.contains( index.row()) || Reagent::instance()->filter().isEmpty()) {
-            QColor highlight( QApplication::palette().highlight().color());
+        const QList<int> &rows( Variable_::SelectedLabelRows.value());
+        if ( rows.contains( index.row()) || rows.isEmpty()) {
+            QColor highlight( QGuiApplication::palette().highlight().color());
             highlight.setAlpha( 16 );
             return highlight;
         }
@@ -32,6 +32,7 @@
 #include <QMenu>
 #include <QPainter>
 #include <QSqlQuery>
+#include <QCheckBox>
 
 /**
  * @brief LabelDock::LabelDock
@@ -58,6 +59,18 @@ LabelDock::LabelDock( QWidget *parent ) : DockWidget( parent ), ui( new Ui::Labe
                                       LabelDock::setFilter( this->ui->labelView->selectionModel()->selectedRows());
                                   } );
 
+    // toggle between any (OR) and all (AND) selected labels
+    this->ui->matchAllCheck->setChecked( Variable::isEnabled( "labelDock/matchAll" ));
+    QCheckBox::connect( this->ui->matchAllCheck, &QCheckBox::toggled, [ this ]( bool checked ) {
+        Variable::setEnabled( "labelDock/matchAll", checked );
+
+        const QModelIndexList rows( this->ui->labelView->selectionModel()->selectedRows());
+        if ( !rows.isEmpty()) {
+            ReagentDock::instance()->view()->filterModel()->setLabelFilter();
+            LabelDock::setFilter( rows );
+        }
+    } );
+
     Variable::instance()->bind( "labelDock/selectedRows", this, SLOT( changed()));
 }
 
@@ -94,13 +107,15 @@ QList<Id> LabelDock::currentLabels() const {
  * @param list
  */
 void LabelDock::setFilter( const QModelIndexList &list ) {
-    // apply sql filter
+    SortFilterProxyModel *filterModel( ReagentDock::instance()->view()->filterModel());
+
+    // NOTE: filtering is done in memory by the proxy model, reagents are not re-selected
     if ( list.isEmpty()) {
         // don't set filter twice
-        if ( Reagent::instance()->filter().isEmpty())
+        if ( filterModel->labelFilter() == SortFilterProxyModel::NoLabelFilter )
             return;
 
-        Reagent::instance()->setFilter( "" );
+        filterModel->setLabelFilter();
         Variable::setString( "labelDock/selectedRows", "" );
     } else {
         QList<Id> labelIds;
@@ -111,41 +126,13 @@ void LabelDock::setFilter( const QModelIndexList &list ) {
             rows << QString::number( index.row());
         }
 
-        QString whereStatement( QString( "select %1.%2 from %1 " )
-                                .arg( LabelSet::instance()->tableName(),
-                                      LabelSet::instance()->fieldName( LabelSet::ReagentId )));
-        for ( int y = 0; y < labelIds.count(); y++ )
-            whereStatement.append( QString( QString(( y == 0 ) ? "where" : "or" ) + " %1=%2 " )
-                                   .arg( LabelSet::instance()->fieldName( LabelSet::LabelId ),
-                                         QString::number( static_cast<int>( labelIds.at( y )))));
-
-        QString reagentStatement( QString( "select distinct %1 from %2 where "
-                                           "%1 in ( %3 ) "
-                                           "or "
-                                           "%4 in ( %3 ) " )
-                                          .arg( Reagent::instance()->fieldName( Reagent::ID ),
-                                                Reagent::instance()->tableName(),
-                                                whereStatement,
-                                                Reagent::instance()->fieldName( Reagent::ParentId )));
-
-        const QString filter( QString( "%1.%2 in ( %3 )" )
-                              .arg( Reagent::instance()->tableName(),
-                                    Reagent::instance()->fieldName( Reagent::ID ),
-                                    reagentStatement ));
-
-        // don't set filter twice
-        if ( !QString::compare( Reagent::instance()->filter(), filter ))
-            return;
-
-        Reagent::instance()->setFilter( filter );
+        filterModel->setLabelFilter( labelIds, Variable::isEnabled( "labelDock/matchAll" ) ? SortFilterProxyModel::AllLabels : SortFilterProxyModel::AnyLabel );
 
         // store variable
         Variable::setString( "labelDock/selectedRows", rows.join( ";" ));
-
     }
-    Reagent::instance()->select();
-    ReagentDock::instance()->view()->updateView();
-    PropertyDock::instance()->updateView();
+
+    ReagentDock::instance()->view()->restoreIndex();
 }
 
 /**
@@ -240,19 +227,13 @@ void LabelDock::on_labelView_customContextMenuRequested( const QPoint &pos ) {
  * @brief LabelDock::on_noButton_clicked
  */
 void LabelDock::on_noButton_clicked() {
-    Reagent::instance()->setFilter( QString( "%1 not in ( select %2 from %3 )" )
-                                    .arg( Reagent::instance()->fieldName( Reagent::ID ))
-                                    .arg( LabelSet::instance()->fieldName( LabelSet::ReagentId ))
-                                    .arg( LabelSet::instance()->tableName())
-                                    );
+    ReagentDock::instance()->view()->filterModel()->setLabelFilter( QList<Id>(), SortFilterProxyModel::NoLabels );
 
     this->ui->labelView->selectionModel()->blockSignals( true );
     this->ui->labelView->reset();
     this->ui->labelView->selectionModel()->blockSignals( false );
 
-    Reagent::instance()->select();
-    ReagentDock::instance()->view()->updateView();
-    PropertyDock::instance()->updateView();
+    ReagentDock::instance()->view()->restoreIndex();
     Variable::setString( "labelDock/selectedRows", "-1" );
 }
 
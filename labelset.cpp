@@ -24,7 +24,9 @@
 #include "database.h"
 #include "label.h"
 #include "reagent.h"
+#include "querytracer.h"
 
+#include <QSqlError>
 #include <QSqlQuery>
 
 /**
@@ -34,6 +36,10 @@ LabelSet::LabelSet() : Table( "labelset" ) {
     this->addField( PRIMARY_FIELD( ID ) );
     this->addField( FIELD( LabelId, Int ) );
     this->addField( FIELD( ReagentId, Int ) );
+
+    // assignments are removed along with their labels and reagents
+    this->addForeignKey( this->field( LabelId ), Label::instance());
+    this->addForeignKey( this->field( ReagentId ), Reagent::instance());
 }
 
 /**
@@ -43,8 +49,18 @@ LabelSet::LabelSet() : Table( "labelset" ) {
  * @return
  */
 Row LabelSet::add( const Id &labelId, const Id &reagentId ) {
-    return Table::add(
-            QVariantList() << Database_::null << static_cast<int>( labelId ) << static_cast<int>( reagentId ));
+    const Row row = Table::add( QVariantList() << Database_::null << static_cast<int>( labelId ) << static_cast<int>( reagentId ));
+
+    // update index
+    if ( row != Row::Invalid && this->m_indexed ) {
+        this->labelIndex[labelId] << reagentId;
+        this->reagentIndex[reagentId] << labelId;
+    }
+
+    if ( row != Row::Invalid )
+        emit this->labelsChanged( reagentId );
+
+    return row;
 }
 
 /**
@@ -53,29 +69,114 @@ Row LabelSet::add( const Id &labelId, const Id &reagentId ) {
  * @param reagentId
  */
 void LabelSet::remove( const Id &labelId, const Id &reagentId ) {
-    QSqlQuery().exec( QString( "delete from %1 where %2=%3 and %4=%5" )
-                              .arg( this->tableName(),
-                                    this->fieldName( LabelId ),
-                                    QString::number( static_cast<int>( labelId )),
-                                    this->fieldName( ReagentId ),
-                                    QString::number( static_cast<int>( reagentId ))));
+    QSqlQuery query;
+    if ( !QueryTracer::exec( query, QString( "select %1 from %2 where %3=%4 and %5=%6" )
+                             .arg( this->fieldName( ID ),
+                                   this->tableName(),
+                                   this->fieldName( LabelId ),
+                                   QString::number( static_cast<int>( labelId )),
+                                   this->fieldName( ReagentId ),
+                                   QString::number( static_cast<int>( reagentId ))), "labels" )) {
+        qCWarning( Database_::Debug ) << LabelSet::tr( "could not remove label, reason - \"%1\"" ).arg( query.lastError().text());
+        return;
+    }
+
+    QList<Id> ids;
+    while ( query.next())
+        ids << query.value( 0 ).value<Id>();
+
+    if ( ids.isEmpty())
+        return;
+
+    // NOTE: only this reagent's label strip is updated (no invalidation, which would reset all of them)
+    Table::remove( ids );
+
+    // update index
+    if ( this->m_indexed ) {
+        this->labelIndex[labelId].remove( reagentId );
+        this->reagentIndex[reagentId].remove( labelId );
+    }
+
+    emit this->labelsChanged( reagentId );
+}
+
+/**
+ * @brief LabelSet::buildIndex reads all label assignments in one query
+ */
+void LabelSet::buildIndex() const {
+    if ( this->m_indexed )
+        return;
+
+    this->labelIndex.clear();
+    this->reagentIndex.clear();
+
+    QSqlQuery query;
+    QueryTracer::exec( query, QString( "select %1, %2 from %3" )
+                .arg( this->fieldName( LabelId ),
+                      this->fieldName( ReagentId ),
+                      this->tableName()), "labels" );
+
+    while ( query.next()) {
+        const Id labelId = query.value( 0 ).value<Id>();
+        const Id reagentId = query.value( 1 ).value<Id>();
+
+        this->labelIndex[labelId] << reagentId;
+        this->reagentIndex[reagentId] << labelId;
+    }
+
+    this->m_indexed = true;
+}
+
+/**
+ * @brief LabelSet::reagents returns reagents that have the given label
+ * @param labelId
+ * @return
+ */
+QSet<Id> LabelSet::reagents( const Id &labelId ) const {
+    this->buildIndex();
+    return this->labelIndex.value( labelId );
+}
+
+/**
+ * @brief LabelSet::reagents returns reagents that have any (or all) of the given labels
+ * @param labelIds
+ * @param matchAll
+ * @return
+ */
+QSet<Id> LabelSet::reagents( const QList<Id> &labelIds, bool matchAll ) const {
+    this->buildIndex();
+
+    QSet<Id> reagents;
+    for ( int y = 0; y < labelIds.count(); y++ ) {
+        const QSet<Id> set( this->labelIndex.value( labelIds.at( y )));
+
+        if ( y == 0 )
+            reagents = set;
+        else if ( matchAll )
+            reagents.intersect( set );
+        else
+            reagents.unite( set );
+    }
+
+    return reagents;
+}
+
+/**
+ * @brief LabelSet::labels returns labels of the given reagent
+ * @param reagentId
+ * @return
+ */
+QSet<Id> LabelSet::labels( const Id &reagentId ) const {
+    this->buildIndex();
+    return this->reagentIndex.value( reagentId );
 }
 
 /**
  * @brief LabelSet::removeOrphanedEntries
  */
 void LabelSet::removeOrphanedEntries() {
-    // remove if label has been deleted
-    QSqlQuery().exec( QString( "delete from %1 where %2 not in ( select %3 from %4 )" )
-                              .arg( this->tableName(),
-                                    this->fieldName( LabelId ),
-                                    Label::instance()->fieldName( Label::ID ),
-                                    Label::instance()->tableName()));
-
-    // remove if reagent has been deleted
-    QSqlQuery().exec( QString( "delete from %1 where %2 not in ( select %3 from %4 )" )
-                              .arg( this->tableName(),
-                                    this->fieldName( ReagentId ),
-                                    Reagent::instance()->fieldName( Reagent::ID ),
-                                    Reagent::instance()->tableName()));
+    // NOTE: orphans are removed by sqlite through foreign keys, this only refreshes in-memory indexes
+    // rebuild index on next use
+    this->m_indexed = false;
+    this->invalidate();
 }
@@ -22,6 +22,7 @@
  * includes
  */
 #include "table.h"
+#include <QSet>
 
 /**
  * @brief The LabelSet class
@@ -59,9 +60,21 @@ public:
     }
     ~LabelSet() override = default;
     Row add( const Id &labelId, const Id &reagentId );
-    void remove( const Row &row ) override { Table::remove( row ); }
+    void remove( const Row &row ) override { this->m_indexed = false; Table::remove( row ); }
+    void reload() override { this->m_indexed = false; Table::reload(); }
     void remove( const Id &labelId, const Id &reagentId );
 
+    [[nodiscard]] QSet<Id> reagents( const Id &labelId ) const;
+    [[nodiscard]] QSet<Id> reagents( const QList<Id> &labelIds, bool matchAll = false ) const;
+    [[nodiscard]] QSet<Id> labels( const Id &reagentId ) const;
+
+    /**
+     * @brief hasLabels
+     * @param reagentId
+     * @return
+     */
+    [[nodiscard]] bool hasLabels( const Id &reagentId ) const { return !this->labels( reagentId ).isEmpty(); }
+
     // initialize field setters and getters
     INITIALIZE_FIELD( Id, ID, id )
     INITIALIZE_FIELD( Id, LabelId, labelId )
@@ -70,8 +83,17 @@ public:
 public slots:
     void removeOrphanedEntries() override;
 
+signals:
+    void labelsChanged( const Id &reagentId );
+
 private:
     explicit LabelSet();
+    void buildIndex() const;
+
+    // in-memory label->reagent and reagent->label posting lists (built on first use)
+    mutable bool m_indexed = false;
+    mutable QHash<Id, QSet<Id>> labelIndex;
+    mutable QHash<Id, QSet<Id>> reagentIndex;
 };
 
 // declare enums
@@ -36,6 +36,12 @@
 #include "propertydock.h"
 #include "searchengine.h"
 #include "cache.h"
+#include "searchindex.h"
+#include "changelog.h"
+#include "core.h"
+#include "script.h"
+#include "system.h"
+#include "startupprofiler.h"
 #include <QApplication>
 #include <QDate>
 #include <QDir>
@@ -143,6 +149,9 @@ scripting:
 int main( int argc, char *argv[] ) {
     QApplication a( argc, argv );
 
+    // measure startup phases (see system.startupInfo() in calculator)
+    StartupProfiler::instance()->mark( "application" );
+
     // simple single instance implementation
     // NOTE: this however will fail if app crashes during startup
 #ifndef QT_DEBUG
@@ -158,15 +167,14 @@ int main( int argc, char *argv[] ) {
         }
     };
     QSharedPointer<SharedMemory> sharedMemory( new SharedMemory( "fumingCube_singleInstance", &a ));
-    if ( !sharedMemory->lock())
+
+    // NOTE: several instances are allowed in shared database mode
+    if ( !a.arguments().contains( "--shared" ) && !sharedMemory->lock())
         return 0;
 #endif
 
     // register metaTypes
-    //qRegisterMetaType<Reagent::Fields>();
-    qRegisterMetaType<Id>();
-    qRegisterMetaType<Row>();
-    qRegisterMetaType<Table::Roles>();
+    Core::registerMetaTypes();
 
     // i18n
     QTranslator translator;
@@ -192,31 +200,11 @@ int main( int argc, char *argv[] ) {
     }
 
     // set variable defaults
-    Variable::add( "databasePath", "", Var::Flag::Hidden );
-    Variable::add( "calculator/commands", "", Var::Flag::ReadOnly );
-    Variable::add( "calculator/history", qAsConst( history ), Var::Flag::ReadOnly );
-    Variable::add( "calculator/ans", "", Var::Flag::ReadOnly );
-    Variable::add( "calculator/theme", "", Var::Flag::ReadOnly | Var::Flag::Hidden );
-    Variable::add( "calculator/zoom", 1.0, Var::Flag::ReadOnly | Var::Flag::Hidden );
-    Variable::add( "mainWindow/geometry", QByteArray(), Var::Flag::ReadOnly );
-    Variable::add( "mainWindow/state", QByteArray(), Var::Flag::ReadOnly );
-    Variable::add( "reagentDock/selection", -1, Var::Flag::Hidden );
-    Variable::add( "reagentDock/openNodes", "", Var::Flag::Hidden );
-    Variable::add( "reagentDock/hiddenNodes", "", Var::Flag::Hidden );
-    Variable::add( "reagentDock/deprecatedNodes", "", Var::Flag::Hidden );
-    Variable::add( "propertyDock/hiddenTags", "", Var::Flag::Hidden );
-    Variable::add( "darkMode", false, Var::Flag::ReadOnly | Var::Flag::Hidden | Var::Flag::NoSave );
-    Variable::add( "overrideTheme", false, Var::Flag::ReadOnly | Var::Flag::Hidden );
-    Variable::add( "theme", "light", Var::Flag::ReadOnly | Var::Flag::Hidden );
-    Variable::add( "fetchPropertiesOnAddition", false, Var::Flag::ReadOnly | Var::Flag::Hidden );
-    Variable::add( "alwaysOnTop", false, Var::Flag::ReadOnly | Var::Flag::Hidden );
-    Variable::add( "decimalSeparator", QString( QLocale::system().decimalPoint()), Var::Flag::Hidden );
-    Variable::add( "searchFragment/history", "", Var::Flag::ReadOnly );
-    Variable::add( "propertyFragment/selectedTags", "", Var::Flag::Hidden );
-    Variable::add( "labelDock/selectedRows", "", Var::Flag::Hidden );
+    Core::addVariables( qAsConst( history ));
 
     // read configuration
     XMLTools::read();
+    StartupProfiler::instance()->mark( "configuration" );
 
 #ifdef Q_OS_WIN
     EMFMime *emf( new EMFMime());
@@ -288,30 +276,9 @@ int main( int argc, char *argv[] ) {
 
     // initialize database and its tables
     Database::instance();
-    auto loadTables = []() {
-        bool success = true;
-        success &= Database::instance()->add( Reagent::instance());
-        success &= Database::instance()->add( Property::instance());
-        success &= Database::instance()->add( Tag::instance());
-        success &= Database::instance()->add( Label::instance());
-        success &= Database::instance()->add( LabelSet::instance());
-        success &= Database::instance()->add( TableEntry::instance());
-        success &= Database::instance()->add( TableProperty::instance());
-
-
-        if ( !Tag::instance()->count())
-            Tag::instance()->populate();
-
-        if ( !Label::instance()->count())
-            Label::instance()->populate();
-
-        Tag::instance()->sort( Tag::Name, Qt::AscendingOrder );
-        //Tag::instance()->select();
+    StartupProfiler::instance()->mark( "database" );
 
-        return success;
-    };
-
-    if ( !loadTables()) {
+    if ( !Core::loadTables()) {
         QMessageBox::critical(
                     // FIXME
             #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
@@ -333,6 +300,13 @@ int main( int argc, char *argv[] ) {
         return 0;
     }
 
+    // start maintaining full-text search index (it is rebuilt on first search if out of sync)
+    SearchIndex::instance();
+
+    // pick up changes made by other instances (shared database mode only)
+    ChangeLog::instance();
+    StartupProfiler::instance()->mark( "indexes" );
+
     // detect dark mode
     bool darkMode = false;
     bool darkModeWin10 = false;
@@ -374,6 +348,7 @@ int main( int argc, char *argv[] ) {
     MainWindow::instance()->setWindowFlag( Qt::WindowStaysOnTopHint, Variable::isEnabled( "alwaysOnTop" ));
     MainWindow::instance()->show();
     MainWindow::instance()->scrollToBottom();
+    StartupProfiler::instance()->mark( "main window" );
 
 #ifdef Q_OS_LINUX
     // fixes issues with dockwidgets on linux
@@ -398,12 +373,19 @@ int main( int argc, char *argv[] ) {
 
     // restore last reagent selection
     ReagentDock::instance()->view()->updateView();
+    StartupProfiler::instance()->mark( "history" );
+
+    // system (debug) commands of the calculator depend on the main window
+    Script::instance()->setSystem( new System());
 
     // load search engines
     SearchEngineManager::instance()->loadSearchEngines();
+    StartupProfiler::instance()->mark( "search engines" );
 
     // read reagent cache
     Cache::instance()->readReagentCache();
+    StartupProfiler::instance()->mark( "reagent cache" );
+    StartupProfiler::instance()->finish();
 
     return QApplication::exec();
 }
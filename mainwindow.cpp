@@ -36,6 +36,7 @@
 #include <QScrollBar>
 #include <QMenu>
 #include <QSqlQuery>
+#include "querytracer.h"
 #include <QTimer>
 #include <utility>
 #include <QInputDialog>
@@ -124,14 +125,14 @@ MainWindow::MainWindow( QWidget *parent ) : QMainWindow( parent ), ui( new Ui::M
         //       therefore we must find its label and select it
         {
             QSqlQuery query;
-            query.exec( QString( "select %1 from %2 where %3=%4" )
+            const bool ok = QueryTracer::exec( query, QString( "select %1 from %2 where %3=%4" )
                                 .arg( LabelSet::instance()->fieldName( LabelSet::LabelId ),
                                       LabelSet::instance()->tableName(),
                                       LabelSet::instance()->fieldName( LabelSet::ReagentId ),
-                                      QString::number( static_cast<int>( reagentId ))));
+                                      QString::number( static_cast<int>( reagentId ))), "mainWindow" );
 
             // find the first label the reagent has
-            if ( query.next()) {
+            if ( ok && query.next()) {
                 const Id labelId = query.value( 0 ).value<Id>();
                 if ( labelId != Id::Invalid ) {
                     const QList<Row> list( ListUtils::toNumericList<Row>( Variable::string( "labelDock/selectedRows" ).split( ";" )));
@@ -67,3 +67,16 @@ void NetworkManager::execute( const QString &url, NetworkManager::Types type, co
         reply->deleteLater();
     } );
 }
+
+/**
+ * @brief NetworkManager::abort aborts all pending requests of the given type
+ * @param type
+ */
+void NetworkManager::abort( NetworkManager::Types type ) {
+    // NOTE: replies are owned by the access manager until they are finished
+    const QList<QNetworkReply *> replies( this->manager.findChildren<QNetworkReply *>());
+    for ( QNetworkReply *reply : replies ) {
+        if ( reply->isRunning() && reply->request().attribute( QNetworkRequest::User ).toInt() == static_cast<int>( type ))
+            reply->abort();
+    }
+}
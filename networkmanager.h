@@ -47,6 +47,9 @@ public:
         FormulaRequest,
         FormulaRequestBrowser,
         NameRequest,
+        FormulaRequestPrefetch,
+        NameRequestPrefetch,
+        ThumbnailRequest,
         FavIcon,
         DropImageRequest
     };
@@ -76,6 +79,7 @@ signals:
 
 public slots:
     void execute( const QString &url, NetworkManager::Types type, const QVariant &userData = QVariant());
+    void abort( NetworkManager::Types type );
 
 private:
     /**
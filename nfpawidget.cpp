@@ -64,41 +64,41 @@ qreal NFPAWidget::fontScaleF( int len ) const {
 }
 
 /**
- * @brief NFPAWidget::paintEvent
+ * @brief NFPAWidget::paint paints the diamond within sizeHint() bounds starting at the painter origin
+ * @param painter
  */
-void NFPAWidget::paintEvent( QPaintEvent * ) {
+void NFPAWidget::paint( QPainter *painter ) const {
     if ( this->rects.isEmpty())
         return;
 
     // translate painter and rotate it by 45 degrees
-    QPainter painter( this );
-    painter.translate( this->vscale(), this->height() * 0.5 );
-    painter.rotate( 45 );
+    painter->save();
+    painter->translate( this->vscale(), this->vscale());
+    painter->rotate( 45 );
 
     // draw rects
-    painter.setPen( QPen( Qt::black, 1 ));
-    painter.setBrush( QColor::fromRgb( 255, 102, 102 ));
-    painter.drawRect( QRectF( -this->scale(), -this->scale(), this->scale(), this->scale()));
-    painter.setBrush( Qt::white );
-    painter.drawRect( QRectF( 0, 0, this->scale(), this->scale()));
-    painter.setBrush( QColor::fromRgb( 102, 145, 255 ));
-    painter.drawRect( QRectF( -this->scale(), 0, this->scale(), this->scale()));
-    painter.setBrush( QColor::fromRgb( 252, 255, 102 ));
-    painter.drawRect( QRectF( 0, -this->scale(), this->scale(), this->scale()));
+    painter->setPen( QPen( Qt::black, 1 ));
+    painter->setBrush( QColor::fromRgb( 255, 102, 102 ));
+    painter->drawRect( QRectF( -this->scale(), -this->scale(), this->scale(), this->scale()));
+    painter->setBrush( Qt::white );
+    painter->drawRect( QRectF( 0, 0, this->scale(), this->scale()));
+    painter->setBrush( QColor::fromRgb( 102, 145, 255 ));
+    painter->drawRect( QRectF( -this->scale(), 0, this->scale(), this->scale()));
+    painter->setBrush( QColor::fromRgb( 252, 255, 102 ));
+    painter->drawRect( QRectF( 0, -this->scale(), this->scale(), this->scale()));
 
     // draw outer grid
-    painter.setBrush( Qt::transparent );
-    painter.setPen( QPen( Qt::black, 1.2 ));
-    painter.drawRect( QRectF( -this->scale(), -this->scale(), this->scale() * 2, this->scale() * 2 ));
+    painter->setBrush( Qt::transparent );
+    painter->setPen( QPen( Qt::black, 1.2 ));
+    painter->drawRect( QRectF( -this->scale(), -this->scale(), this->scale() * 2, this->scale() * 2 ));
 
-    // reset transformations
-    painter.resetTransform();
-    painter.translate( this->vscale(), this->height() * 0.5 );
+    // undo rotation
+    painter->rotate( -45 );
 
     // draw numbers
     for ( int y = 0; y < qMin( this->parameters().count(), 4 ); y++ ) {
-        painter.save();
-        QFont font( painter.font());
+        painter->save();
+        QFont font( painter->font());
 
         const QString parm( this->parameters().at( y ));
         if ( !parm.isEmpty()) {
@@ -106,10 +106,21 @@ void NFPAWidget::paintEvent( QPaintEvent * ) {
                 font.setStrikeOut( true );
 
             font.setPointSizeF(( y == 3 ) ? this->fontScaleF( parm.length()) : static_cast<qreal>( this->scale() * 0.5 ));
-            painter.setFont( font );
+            painter->setFont( font );
         }
 
-        painter.drawText( this->rects.at( y ), parm, { Qt::AlignCenter } );
-        painter.restore();
+        painter->drawText( this->rects.at( y ), parm, { Qt::AlignCenter } );
+        painter->restore();
     }
+
+    painter->restore();
+}
+
+/**
+ * @brief NFPAWidget::paintEvent
+ */
+void NFPAWidget::paintEvent( QPaintEvent * ) {
+    QPainter painter( this );
+    painter.translate( 0, this->height() * 0.5 - this->vscale());
+    this->paint( &painter );
 }
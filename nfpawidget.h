@@ -54,6 +54,15 @@ public:
      */
     [[nodiscard]] qreal fontScaleF( int len ) const;
 
+    /**
+     * @brief sizeHint
+     * @return
+     */
+    [[nodiscard]] QSize sizeHint() const override {
+        const qreal vScale = sqrt( 2 * ( this->scale() * this->scale()));
+        return QSizeF( vScale * 2, vScale * 2 ).toSize();
+    }
+
 public slots:
     /**
      * @brief update
@@ -73,17 +82,15 @@ public slots:
      */
     void setScale( const int &scale = 32 );
 
-protected:
-    void paintEvent( QPaintEvent * ) override;
-
     /**
-     * @brief sizeHint
-     * @return
+     * @brief setParameters sets parameters without triggering a repaint (used by delegates)
+     * @param parms
      */
-    [[nodiscard]] QSize sizeHint() const override {
-        const qreal vScale = sqrt( 2 * ( this->scale() * this->scale()));
-        return QSizeF( vScale * 2, vScale * 2 ).toSize();
-    }
+    void setParameters( const QStringList &parms ) { this->m_parameters = parms; }
+    void paint( QPainter *painter ) const;
+
+protected:
+    void paintEvent( QPaintEvent * ) override;
 
     /**
      * @brief sizeHint
@@ -25,7 +25,12 @@
 #include "variable.h"
 #include "listutils.h"
 #include "main.h"
+#include "database.h"
+#include "querytracer.h"
+#include "reagent.h"
+#include <QSqlQuery>
 #include <QStandardItem>
+#include <algorithm>
 
 /**
  * @brief NodeHistory::NodeHistory
@@ -34,6 +39,9 @@
 NodeHistory::NodeHistory() {
     this->loadHistory();
 
+    // forget removed reagents (batches are reported separately)
+    NodeHistory::connect( Reagent::instance(), &Reagent::entryAboutToBeRemoved, this, &NodeHistory::removeFromHistory );
+
     // add to garbage collector
     GarbageMan::instance()->add( this );
 }
@@ -42,6 +50,8 @@ NodeHistory::NodeHistory() {
  * @brief NodeHistory::~NodeHistory
  */
 NodeHistory::~NodeHistory() {
+    NodeHistory::disconnect( Reagent::instance(), &Reagent::entryAboutToBeRemoved, this, nullptr );
+
     if ( this->treeParent() != nullptr ) {
         NodeHistory::disconnect( this->treeParent(), &QTreeView::expanded, this, nullptr );
         NodeHistory::disconnect( this->treeParent(), &QTreeView::collapsed, this, nullptr );
@@ -79,18 +89,95 @@ void NodeHistory::restoreNodeState() {
  * @brief NodeHistory::saveHistory
  */
 void NodeHistory::saveHistory() {
-    Variable::setValue( "reagentDock/openNodes", ListUtils::toStringList<Id>( qAsConst( this->openNodes )));
-    Variable::setValue( "reagentDock/hiddenNodes", ListUtils::toStringList<Id>( qAsConst( this->hiddenNodes )));
-    Variable::setValue( "reagentDock/deprecatedNodes", ListUtils::toStringList<Id>( qAsConst( this->deprecatedNodes )));
+    // open nodes are a per-user view state, so they are kept in configuration
+    QList<Id> openNodes( this->openNodes.values());
+    std::sort( openNodes.begin(), openNodes.end());
+    Variable::setValue( "reagentDock/openNodes", ListUtils::toStringList<Id>( qAsConst( openNodes )));
 }
 
 /**
  * @brief NodeHistory::loadHistory
  */
 void NodeHistory::loadHistory() {
-    this->openNodes = ListUtils::toNumericList<Id>( Variable::value<QStringList>( "reagentDock/openNodes" ));
-    this->hiddenNodes = ListUtils::toNumericList<Id>( Variable::value<QStringList>( "reagentDock/hiddenNodes" ));
-    this->deprecatedNodes = ListUtils::toNumericList<Id>( Variable::value<QStringList>( "reagentDock/deprecatedNodes" ));
+    const QList<Id> openNodes( ListUtils::toNumericList<Id>( Variable::value<QStringList>( "reagentDock/openNodes" )));
+    this->openNodes.clear();
+    for ( const Id &id : openNodes )
+        this->openNodes << id;
+
+    this->loadNodeState();
+}
+
+/**
+ * @brief NodeHistory::loadNodeState reads hidden and deprecated flags from the database
+ */
+void NodeHistory::loadNodeState() {
+    this->hiddenNodes.clear();
+    this->deprecatedNodes.clear();
+
+    // flags are removed along with their reagents
+    QSqlQuery query;
+    QueryTracer::exec( query, QString( "create table if not exists %1 ( reagentId integer primary key, flags integer not null, "
+                                       "foreign key( reagentId ) references %2( %3 ) on delete cascade )" )
+                       .arg( NodeHistory::TableName,
+                             Reagent::instance()->tableName(),
+                             Reagent::instance()->fieldName( Reagent::ID )), "nodeHistory" );
+
+    QueryTracer::exec( query, QString( "select reagentId, flags from %1" ).arg( NodeHistory::TableName ), "nodeHistory" );
+    while ( query.next()) {
+        const Id id = query.value( 0 ).value<Id>();
+        const NodeHistory::StateFlags flags( QFlag( query.value( 1 ).toInt()));
+
+        if ( flags.testFlag( Hidden ))
+            this->hiddenNodes << id;
+
+        if ( flags.testFlag( Deprecated ))
+            this->deprecatedNodes << id;
+    }
+
+    // import lists stored in configuration by earlier versions
+    const QList<Id> hiddenNodes( ListUtils::toNumericList<Id>( Variable::value<QStringList>( "reagentDock/hiddenNodes" )));
+    const QList<Id> deprecatedNodes( ListUtils::toNumericList<Id>( Variable::value<QStringList>( "reagentDock/deprecatedNodes" )));
+    if ( hiddenNodes.isEmpty() && deprecatedNodes.isEmpty())
+        return;
+
+    for ( const Id &id : hiddenNodes )
+        this->hiddenNodes << id;
+
+    for ( const Id &id : deprecatedNodes )
+        this->deprecatedNodes << id;
+
+    Transaction transaction;
+    for ( const Id &id : hiddenNodes + deprecatedNodes )
+        this->writeNodeState( id );
+
+    Variable::reset( "reagentDock/hiddenNodes" );
+    Variable::reset( "reagentDock/deprecatedNodes" );
+}
+
+/**
+ * @brief NodeHistory::writeNodeState writes hidden and deprecated flags of a single reagent to the database
+ * @param id
+ */
+void NodeHistory::writeNodeState( const Id &id ) {
+    NodeHistory::StateFlags flags( NoState );
+    if ( this->hiddenNodes.contains( id ))
+        flags |= Hidden;
+
+    if ( this->deprecatedNodes.contains( id ))
+        flags |= Deprecated;
+
+    // NOTE: only the changed entry is written, so that flags set by other instances (shared mode) are kept
+    QSqlQuery query;
+    if ( flags == NoState ) {
+        query.prepare( QString( "delete from %1 where reagentId=?" ).arg( NodeHistory::TableName ));
+        query.addBindValue( static_cast<int>( id ));
+    } else {
+        // NOTE: flags of reagents removed elsewhere (shared mode) are rejected by the foreign key
+        query.prepare( QString( "insert or replace into %1 ( reagentId, flags ) values ( ?, ? )" ).arg( NodeHistory::TableName ));
+        query.addBindValue( static_cast<int>( id ));
+        query.addBindValue( static_cast<int>( flags ));
+    }
+    QueryTracer::exec( query, "nodeHistory" );
 }
 
 /**
@@ -115,10 +202,10 @@ void NodeHistory::setTreeParent( QTreeView *parent ) {
         if ( id == Id::Invalid )
             return;
 
-        if ( expanded && !this->openNodes.contains( id ))
+        if ( expanded )
             this->openNodes << id;
         else
-            this->openNodes.removeAll( id );
+            this->openNodes.remove( id );
     };
 
     QTreeView::connect( this->treeParent(), &QTreeView::expanded, [ saveNodeState ]( const QModelIndex &index ) {
@@ -135,7 +222,46 @@ void NodeHistory::setTreeParent( QTreeView *parent ) {
  * @param id
  */
 void NodeHistory::removeFromHistory( const Id &id ) {
-    this->openNodes.removeOne( id );
-    this->hiddenNodes.removeOne( id );
-    this->deprecatedNodes.removeOne( id );
+    this->openNodes.remove( id );
+    this->hiddenNodes.remove( id );
+    this->deprecatedNodes.remove( id );
+}
+
+/**
+ * @brief NodeHistory::hide
+ * @param id
+ */
+void NodeHistory::hide( const Id &id ) {
+    this->hiddenNodes << id;
+    this->writeNodeState( id );
+}
+
+/**
+ * @brief NodeHistory::deprecate
+ * @param id
+ */
+void NodeHistory::deprecate( const Id &id ) {
+    this->deprecatedNodes << id;
+    this->writeNodeState( id );
+}
+
+/**
+ * @brief NodeHistory::restore
+ * @param id
+ */
+void NodeHistory::restore( const Id &id ) {
+    this->deprecatedNodes.remove( id );
+    this->writeNodeState( id );
+}
+
+/**
+ * @brief NodeHistory::clearHiddenNodes
+ */
+void NodeHistory::clearHiddenNodes() {
+    const QList<Id> hiddenNodes( this->hiddenNodes.values());
+    this->hiddenNodes.clear();
+
+    Transaction transaction;
+    for ( const Id &id : hiddenNodes )
+        this->writeNodeState( id );
 }
@@ -21,6 +21,7 @@
 /*
  * includes
  */
+#include <QSet>
 #include <QTreeView>
 #include "table.h"
 
@@ -33,6 +34,16 @@ class NodeHistory : public QObject {
     friend class ReagentDock;
 
 public:
+    /**
+     * @brief The StateFlag enum
+     */
+    enum StateFlag {
+        NoState    = 0x0,
+        Hidden     = 0x1,
+        Deprecated = 0x2
+    };
+    Q_DECLARE_FLAGS( StateFlags, StateFlag )
+
     // disable move
     NodeHistory( NodeHistory&& ) = delete;
     NodeHistory& operator=( NodeHistory&& ) = delete;
@@ -65,7 +76,6 @@ public:
      */
     [[nodiscard]] bool isDeperecated( const Id& id ) const { return this->deprecatedNodes.contains( id ); }
 
-
     /**
      * @brief hiddenCount
      * @return
@@ -92,36 +102,23 @@ public slots:
     void loadHistory();
     void setTreeParent( QTreeView *parent );
     void removeFromHistory( const Id &id );
-
-    /**
-     * @brief hide
-     * @param id
-     */
-    void hide( const Id& id ) { if ( !this->hiddenNodes.contains( id )) this->hiddenNodes << id; }
-
-    /**
-     * @brief deprecate
-     * @param id
-     */
-    void deprecate( const Id& id ) { if ( !this->deprecatedNodes.contains( id )) this->deprecatedNodes << id; }
-
-    /**
-     * @brief restore
-     * @param id
-     */
-    void restore( const Id& id ) { if ( this->deprecatedNodes.contains( id )) this->deprecatedNodes.removeAll( id ); }
-
-    /**
-     * @brief clearHiddenNodes
-     */
-    void clearHiddenNodes() { this->hiddenNodes.clear(); }    
+    void hide( const Id& id );
+    void deprecate( const Id& id );
+    void restore( const Id& id );
+    void clearHiddenNodes();
 
 private:
     explicit NodeHistory();
+    void loadNodeState();
+    void writeNodeState( const Id &id );
+    static constexpr const char *TableName = "nodeState";
 
     QTreeView *m_treeParent;
     bool m_enabled = true;
-    QList<Id> openNodes;
-    QList<Id> hiddenNodes;
-    QList<Id> deprecatedNodes;
+    QSet<Id> openNodes;
+    QSet<Id> hiddenNodes;
+    QSet<Id> deprecatedNodes;
 };
+
+// declare flags
+Q_DECLARE_OPERATORS_FOR_FLAGS( NodeHistory::StateFlags )
@@ -0,0 +1,390 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "pivottable.h"
+#include "property.h"
+#include "reagent.h"
+#include "tableentry.h"
+#include "tableproperty.h"
+#include "propertyindex.h"
+#include "databaseservice.h"
+#include "querytracer.h"
+#include "htmlutils.h"
+#include <QSqlQuery>
+#include <QSet>
+#include <algorithm>
+
+/**
+ * @brief generations returns current generations of all tables the pivot depends on
+ * @return
+ */
+static QVector<int> generations() {
+    return QVector<int>() << Property::instance()->generation()
+                          << Reagent::instance()->generation()
+                          << Tag::instance()->generation()
+                          << TableEntry::instance()->generation()
+                          << TableProperty::instance()->generation();
+}
+
+/**
+ * @brief sortKey converts raw property data to a value suitable for sorting
+ * @param data
+ * @param type
+ * @return
+ */
+static QVariant sortKey( const QVariant &data, const Tag::Types &type ) {
+    if ( type == Tag::Integer || type == Tag::Real ) {
+        bool ok;
+        const qreal number = data.toString().replace( ",", "." ).toDouble( &ok );
+        if ( ok )
+            return number;
+    }
+
+    // avoid html parsing for plain strings
+    const QString string( data.toString());
+    return string.contains( '<' ) ? HTMLUtils::toPlainText( string ) : string;
+}
+
+/**
+ * @brief The PivotCache struct holds the latest pivot build of a table and the number of viewers waiting for it
+ */
+struct PivotCache {
+    QFuture<QSharedPointer<PivotTable>> future;
+    int waiters = 0;
+};
+
+/**
+ * @brief pivotCache
+ * @return
+ */
+static QHash<Id, PivotCache> &pivotCache() {
+    static QHash<Id, PivotCache> cache;
+    return cache;
+}
+
+/**
+ * @brief PivotTable::fromTable returns a cached pivot for the given table, rebuilding it on the database thread if data has changed
+ * NOTE: callers that may stop waiting must call release instead of cancelling the (shared) future
+ * @param tableId
+ * @return
+ */
+QFuture<QSharedPointer<PivotTable>> PivotTable::fromTable( const Id &tableId ) {
+    if ( tableId == Id::Invalid )
+        return QFuture<QSharedPointer<PivotTable>>();
+
+    // reuse pending builds and valid pivots (NOTE: default constructed and cancelled futures are rebuilt)
+    PivotCache &entry( pivotCache()[tableId] );
+    if ( !entry.future.isCanceled()) {
+        if ( !entry.future.isFinished() || ( entry.future.resultCount() > 0 && entry.future.result()->isValid())) {
+            entry.waiters++;
+            return entry.future;
+        }
+    }
+
+    // table layout is read on the GUI thread, bulk of the data on the database thread
+    const QSharedPointer<PivotTable> pivot( new PivotTable( tableId ));
+    entry.future = DatabaseService::instance()->run<QSharedPointer<PivotTable>>( [ pivot ]( QSqlDatabase &database, const QFutureInterfaceBase &interface ) {
+        pivot->build( database, interface );
+        return pivot;
+    } );
+    entry.waiters = 1;
+
+    return entry.future;
+}
+
+/**
+ * @brief PivotTable::release stops waiting for a pivot; the build is cancelled only if it is still
+ * running and nobody else waits for it (finished pivots stay cached)
+ * @param tableId
+ * @param future
+ */
+void PivotTable::release( const Id &tableId, const QFuture<QSharedPointer<PivotTable>> &future ) {
+    const auto it = pivotCache().find( tableId );
+    if ( it == pivotCache().end() || it->future != future )
+        return;
+
+    if ( it->waiters > 0 )
+        it->waiters--;
+
+    if ( it->waiters == 0 && !it->future.isFinished())
+        it->future.cancel();
+}
+
+/**
+ * @brief PivotTable::PivotTable
+ * @param tableId
+ */
+PivotTable::PivotTable( const Id &tableId ) : m_tableId( tableId ) {
+    this->prepare();
+}
+
+/**
+ * @brief PivotTable::isValid returns false if any of the source tables have been modified since build
+ * @return
+ */
+bool PivotTable::isValid() const {
+    return this->generations == ::generations();
+}
+
+/**
+ * @brief PivotTable::prepare reads table layout and builds statements for the database thread
+ */
+void PivotTable::prepare() {
+    this->generations = ::generations();
+
+    //
+    // step one: get selected tags and the tab tag (if any)
+    //
+    QSqlQuery query;
+    QueryTracer::exec( query, QString( "select %1, %2 from %3 where %4=%5 order by %6" )
+                .arg( TableProperty::instance()->fieldName( TableProperty::TagId ),
+                      TableProperty::instance()->fieldName( TableProperty::Tab ),
+                      TableProperty::instance()->tableName(),
+                      TableProperty::instance()->fieldName( TableProperty::TableId ),
+                      QString::number( static_cast<int>( this->tableId())),
+                      TableProperty::instance()->fieldName( TableProperty::TableOrder )), "pivot" );
+
+    while ( query.next()) {
+        const Id id = query.value( 0 ).value<Id>();
+        if ( !query.value( 1 ).toBool())
+            this->m_tagIds << id;
+        else
+            this->m_tabId = id;
+    }
+
+    // NOTE: tab values are served by PropertyIndex, so they are not scanned here
+    QStringList tags;
+    for ( const Id &tagId : qAsConst( this->m_tagIds )) {
+        this->m_tagTypes[tagId] = Tag::instance()->type( tagId );
+        tags << QString::number( static_cast<int>( tagId ));
+    }
+
+    if ( tags.isEmpty())
+        return;
+
+    this->batches = TableEntry::instance()->mode( this->tableId()) == TableEntry::ReagentsAndBatches;
+    this->reagentStatement = QString( "select %1, %2, %3 from %4" )
+            .arg( Reagent::instance()->fieldName( Reagent::ID ),
+                  Reagent::instance()->fieldName( Reagent::ParentId ),
+                  Reagent::instance()->fieldName( Reagent::Name ),
+                  Reagent::instance()->tableName());
+    this->propertyStatement = QString( "select %1, %2, %3, %4 from %5 where %3 in ( %6 ) order by %1" )
+            .arg( Property::instance()->fieldName( Property::ID ),
+                  Property::instance()->fieldName( Property::ReagentId ),
+                  Property::instance()->fieldName( Property::TagId ),
+                  Property::instance()->fieldName( Property::PropertyData ),
+                  Property::instance()->tableName(),
+                  tags.join( ", " ));
+}
+
+/**
+ * @brief PivotTable::build reads reagents and properties (runs on the database thread)
+ * @param database
+ * @param interface used to check for cancellation
+ */
+void PivotTable::build( QSqlDatabase &database, const QFutureInterfaceBase &interface ) {
+    if ( this->m_tagIds.isEmpty())
+        return;
+
+    //
+    // step two: read reagent hierarchy
+    //
+    QHash<Id, QPair<Id, QString>> reagents;
+    QSqlQuery query( database );
+    query.setForwardOnly( true );
+    {
+        // NOTE: forward-only queries are fetched while iterating, so they are traced for their lifetime
+        QueryTrace trace( this->reagentStatement, "pivot" );
+        query.exec( this->reagentStatement );
+        while ( trace.next( query ))
+            reagents[query.value( 0 ).value<Id>()] = qMakePair( query.value( 1 ).value<Id>(), query.value( 2 ).toString());
+    }
+
+    //
+    // step three: scan all properties of the selected tags once
+    //
+    const int columns = this->columnCount();
+    QHash<Id, QVector<Id>> cells;
+    {
+        QueryTrace trace( this->propertyStatement, "pivot" );
+        query.exec( this->propertyStatement );
+
+        for ( int y = 0; trace.next( query ); y++ ) {
+            // check for cancellation every now and then
+            if (( y & 0xff ) == 0 && interface.isCanceled())
+                return;
+
+            const Id propertyId = query.value( 0 ).value<Id>();
+            const Id reagentId = query.value( 1 ).value<Id>();
+            const Id tagId = query.value( 2 ).value<Id>();
+            if ( !reagents.contains( reagentId ))
+                continue;
+
+            // NOTE: only the first property of each tag is displayed
+            QVector<Id> &row( cells[reagentId] );
+            if ( row.isEmpty())
+                row.fill( Id::Invalid, columns );
+
+            const int column = this->m_tagIds.indexOf( tagId );
+            if ( column < 0 || row.at( column ) != Id::Invalid )
+                continue;
+
+            row[column] = propertyId;
+            this->m_properties[propertyId] = qMakePair( tagId, query.value( 3 ));
+        }
+    }
+
+    //
+    // step four: build rows from reagents that have at least one of the properties
+    //
+    QList<Id> baseIds;
+    for ( auto it = cells.constBegin(); it != cells.constEnd(); ++it ) {
+        if ( this->batches || reagents[it.key()].first == Id::Invalid )
+            baseIds << it.key();
+    }
+
+    // order batches right after their parents
+    const auto parentOrSelf = [ &reagents ]( const Id &id ) {
+        const Id parentId = reagents[id].first;
+        return static_cast<int>( parentId == Id::Invalid ? id : parentId );
+    };
+    std::sort( baseIds.begin(), baseIds.end(), [ parentOrSelf ]( const Id &left, const Id &right ) {
+        const int leftKey = parentOrSelf( left );
+        const int rightKey = parentOrSelf( right );
+        return leftKey == rightKey ? left < right : leftKey < rightKey;
+    } );
+
+    // parents are back-filled as empty rows, that are only displayed
+    // if their batches are visible, but parents themselves are not
+    QList<Id> placeholderIds;
+    for ( const Id &id : qAsConst( baseIds )) {
+        const Id parentId = reagents[id].first;
+        if ( parentId != Id::Invalid && reagents.contains( parentId ) && !placeholderIds.contains( parentId ))
+            placeholderIds << parentId;
+    }
+
+    const QList<Id> rowIds( baseIds + placeholderIds );
+    const int baseCount = baseIds.count();
+    this->reagentIds.reserve( rowIds.count());
+    this->names.reserve( rowIds.count());
+    this->backfill.reserve( rowIds.count());
+    this->parentRows.reserve( rowIds.count());
+    this->propertyIds.fill( QVector<Id>( rowIds.count(), Id::Invalid ), columns );
+    this->sortKeys.fill( QVector<QVariant>( rowIds.count()), columns );
+
+    for ( int y = 0; y < rowIds.count(); y++ ) {
+        const Id id = rowIds.at( y );
+        const bool placeholder = y >= baseCount;
+        const Id parentId = reagents[id].first;
+
+        this->reagentIds << id;
+        this->names << sortKey( reagents[id].second, Tag::Text ).toString();
+        this->backfill << placeholder;
+        this->parentRows << ( parentId == Id::Invalid || placeholder ? -1 : baseCount + placeholderIds.indexOf( parentId ));
+
+        if ( placeholder )
+            continue;
+
+        const QVector<Id> row( cells[id] );
+        for ( int c = 0; c < columns; c++ ) {
+            const Id propertyId = row.at( c );
+            if ( propertyId == Id::Invalid )
+                continue;
+
+            this->propertyIds[c][y] = propertyId;
+            this->sortKeys[c][y] = sortKey( this->m_properties[propertyId].second, this->m_tagTypes[this->m_tagIds.at( c )] );
+        }
+    }
+}
+
+/**
+ * @brief PivotTable::categories returns unique tab values (tab names)
+ * @return
+ */
+QStringList PivotTable::categories() const {
+    if ( this->tabId() == Id::Invalid )
+        return QStringList();
+
+    // NOTE: histogram is maintained incrementally, so this does not scan properties
+    QStringList categories( PropertyIndex::instance()->histogram( this->tabId()).keys());
+    categories.removeAll( QString());
+    return categories;
+}
+
+/**
+ * @brief PivotTable::rows returns all rows
+ * @return
+ */
+QVector<int> PivotTable::rows() const {
+    QVector<int> rows;
+    for ( int y = 0; y < this->rowCount(); y++ ) {
+        if ( !this->backfill.at( y ))
+            rows << y;
+    }
+
+    return this->withParents( rows );
+}
+
+/**
+ * @brief PivotTable::rows returns rows that belong to a category (empty category returns unsorted rows)
+ * @param category
+ * @return
+ */
+QVector<int> PivotTable::rows( const QString &category ) const {
+    if ( this->tabId() == Id::Invalid )
+        return this->rows();
+
+    // get reagents from posting lists
+    const bool unsorted = category.isEmpty();
+    const QSet<Id> reagents( unsorted ? PropertyIndex::instance()->reagents( this->tabId()) :
+                                        PropertyIndex::instance()->reagents( this->tabId(), category ));
+
+    QVector<int> rows;
+    for ( int y = 0; y < this->rowCount(); y++ ) {
+        if ( !this->backfill.at( y ) && reagents.contains( this->reagentId( y )) != unsorted )
+            rows << y;
+    }
+
+    return this->withParents( rows );
+}
+
+/**
+ * @brief PivotTable::withParents appends empty parent rows for batches whose parents are not listed
+ * @param rows
+ * @return
+ */
+QVector<int> PivotTable::withParents( const QVector<int> &rows ) const {
+    QSet<Id> listed;
+    for ( const int row : rows )
+        listed << this->reagentId( row );
+
+    QVector<int> output( rows );
+    for ( const int row : rows ) {
+        const int parentRow = this->parentRows.at( row );
+        if ( parentRow < 0 || listed.contains( this->reagentId( parentRow )))
+            continue;
+
+        listed << this->reagentId( parentRow );
+        output << parentRow;
+    }
+
+    return output;
+}
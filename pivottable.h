@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QFuture>
+#include <QHash>
+#include <QSharedPointer>
+#include <QSqlDatabase>
+#include <QVector>
+#include "table.h"
+#include "tag.h"
+
+/**
+ * @brief The PivotTable class is an in-memory reagent x tag matrix built from a single property scan
+ */
+class PivotTable final {
+    Q_DISABLE_COPY( PivotTable )
+
+public:
+    // disable move
+    PivotTable( PivotTable&& ) = delete;
+    PivotTable& operator=( PivotTable&& ) = delete;
+
+    static QFuture<QSharedPointer<PivotTable>> fromTable( const Id &tableId );
+    static void release( const Id &tableId, const QFuture<QSharedPointer<PivotTable>> &future );
+
+    /**
+     * @brief tableId
+     * @return
+     */
+    [[nodiscard]] Id tableId() const { return this->m_tableId; }
+
+    /**
+     * @brief tagIds
+     * @return
+     */
+    [[nodiscard]] QList<Id> tagIds() const { return this->m_tagIds; }
+
+    /**
+     * @brief tabId
+     * @return
+     */
+    [[nodiscard]] Id tabId() const { return this->m_tabId; }
+
+    /**
+     * @brief rowCount
+     * @return
+     */
+    [[nodiscard]] int rowCount() const { return this->reagentIds.count(); }
+
+    /**
+     * @brief columnCount
+     * @return
+     */
+    [[nodiscard]] int columnCount() const { return this->m_tagIds.count(); }
+
+    /**
+     * @brief reagentId
+     * @param row
+     * @return
+     */
+    [[nodiscard]] Id reagentId( int row ) const { return this->reagentIds.at( row ); }
+
+    /**
+     * @brief propertyId
+     * @param row
+     * @param column
+     * @return
+     */
+    [[nodiscard]] Id propertyId( int row, int column ) const { return this->propertyIds.at( column ).at( row ); }
+
+    /**
+     * @brief sortKey
+     * @param row
+     * @param column (-1 for reagent names)
+     * @return
+     */
+    [[nodiscard]] QVariant sortKey( int row, int column ) const { return column < 0 ? this->names.at( row ) : this->sortKeys.at( column ).at( row ); }
+
+    /**
+     * @brief properties returns (tagId, propertyData) pairs of all properties in the table
+     * @return
+     */
+    [[nodiscard]] const QHash<Id, QPair<Id, QVariant>> &properties() const { return this->m_properties; }
+
+    /**
+     * @brief tagTypes
+     * @return
+     */
+    [[nodiscard]] const QHash<Id, Tag::Types> &tagTypes() const { return this->m_tagTypes; }
+
+    [[nodiscard]] QStringList categories() const;
+    [[nodiscard]] QVector<int> rows() const;
+    [[nodiscard]] QVector<int> rows( const QString &category ) const;
+    [[nodiscard]] bool isValid() const;
+
+private:
+    explicit PivotTable( const Id &tableId );
+    void prepare();
+    void build( QSqlDatabase &database, const QFutureInterfaceBase &interface );
+    [[nodiscard]] QVector<int> withParents( const QVector<int> &rows ) const;
+
+    Id m_tableId = Id::Invalid;
+    Id m_tabId = Id::Invalid;
+    QList<Id> m_tagIds;
+
+    // rows (reagents that have at least one of the tags) and their parent rows
+    QVector<Id> reagentIds;
+    QVector<int> parentRows;
+    QVector<bool> backfill;
+    QVector<QString> names;
+
+    // columnar storage of property ids and their sort keys
+    QVector<QVector<Id>> propertyIds;
+    QVector<QVector<QVariant>> sortKeys;
+
+    QHash<Id, QPair<Id, QVariant>> m_properties;
+    QHash<Id, Tag::Types> m_tagTypes;
+
+    // generations of source tables at the time of build
+    QVector<int> generations;
+
+    // prepared on the GUI thread for the database thread
+    bool batches = false;
+    QString reagentStatement;
+    QString propertyStatement;
+};
@@ -24,7 +24,9 @@
 #include "database.h"
 #include "tag.h"
 #include "reagent.h"
+#include "querytracer.h"
 #include <QSqlQuery>
+#include <QSet>
 
 /**
  * @brief Property::Property
@@ -36,6 +38,11 @@ Property::Property() : Table( "property" ) {
     this->addField( FIELD( PropertyData, QByteArray ));  // value (can be anything)
     this->addField( FIELD( ReagentId, Int ));    // Id in parent table
     this->addField( FIELD( TableOrder, Int ));        // order
+
+    // properties are removed along with their reagents and tags (NoTag and PixmapTag are negative)
+    this->addForeignKey( this->field( ReagentId ), Reagent::instance());
+    this->addForeignKey( this->field( TagId ), Tag::instance(), true );
+
     this->setSort( TableOrder, Qt::AscendingOrder );
 }
 
@@ -68,6 +75,82 @@ Row Property::add( const QString &name, const Id &tagId, const QVariant &value,
                        );
 }
 
+/**
+ * @brief Property::select
+ * @return
+ */
+bool Property::select() {
+    const bool result = Table::select();
+    this->updateFlags();
+    return result;
+}
+
+/**
+ * @brief Property::updateFlags computes batch, override and duplicate flags for all selected properties in one pass
+ */
+void Property::updateFlags() {
+    this->m_flags.fill( NoFlags, this->count());
+
+    // NOTE: flags are only meaningful for a single reagent (and its parent) as shown in the property view,
+    //       so unfiltered selects (startup, reloads) are not worth the extra query
+    if ( this->filter().isEmpty() || this->count() == 0 )
+        return;
+
+    // get parents and overridden parent tags for the whole selection in a single query
+    QHash<Id, QPair<Id, bool>> parents;
+    QSqlQuery query;
+    QueryTracer::exec( query, QString( "select p.%1, r.%2, ( select count(*) from %3 o where o.%4=r.%2 and o.%5=p.%5 and o.%5!=-2 ) "
+                                       "from %3 p left join %6 r on r.%7=p.%4 where p.%1 in ( select %1 from %3 where %8 )" )
+                        .arg( this->fieldName( Property::ID ),                       // 1
+                              Reagent::instance()->fieldName( Reagent::ParentId ),   // 2
+                              this->tableName(),                                     // 3
+                              this->fieldName( Property::ReagentId ),                // 4
+                              this->fieldName( Property::TagId ),                    // 5
+                              Reagent::instance()->tableName(),                      // 6
+                              Reagent::instance()->fieldName( Reagent::ID ),         // 7
+                              this->filter()), "property" );                         // 8
+    while ( query.next()) {
+        const QVariant parentId( query.value( 1 ));
+        parents[query.value( 0 ).value<Id>()] = qMakePair( parentId.isNull() ? Id::Invalid : parentId.value<Id>(), query.value( 2 ).toInt() > 0 );
+    }
+
+    // scriptable tags (read from the in-memory model)
+    QSet<Id> scriptable;
+    for ( int y = 0; y < Tag::instance()->count(); y++ ) {
+        const Row row = static_cast<Row>( y );
+        if ( !Tag::instance()->function( row ).isEmpty())
+            scriptable << Tag::instance()->id( row );
+    }
+
+    // scriptable tags already seen for each reagent (batches share them with their parent)
+    QHash<Id, QSet<Id>> seenTags;
+    for ( int y = 0; y < this->count(); y++ ) {
+        const Row row = static_cast<Row>( y );
+        const Id reagentId = this->reagentId( row );
+        const Id tagId = this->tagId( row );
+        const QPair<Id, bool> parent( parents.value( this->id( row ), qMakePair( Id::Invalid, false )));
+        const bool isBatchProperty = parent.first != Id::Invalid;
+
+        // check for overrides
+        if ( isBatchProperty && parent.second )
+            this->m_flags[y] |= Override;
+
+        // check all previous scriptable tags of the same reagent for duplicates
+        bool isDuplicate = false;
+        if ( tagId != Id::Invalid && scriptable.contains( tagId )) {
+            QSet<Id> &tags( seenTags[isBatchProperty ? parent.first : reagentId] );
+            isDuplicate = tags.contains( tagId );
+            tags << tagId;
+        }
+
+        // NOTE: batch properties are displayed in italic (at least for now)
+        if ( isDuplicate )
+            this->m_flags[y] |= Duplicate;
+        else if ( isBatchProperty )
+            this->m_flags[y] |= Batch;
+    }
+}
+
 /**
  * @brief Property::headerData
  * @param section
@@ -96,16 +179,7 @@ QVariant Property::headerData( int section, Qt::Orientation orientation, int rol
  * @brief Property::removeOrphanedEntries
  */
 void Property::removeOrphanedEntries() {
-    QSqlQuery().exec( QString( "delete from %1 where %2 not in ( select %3 from %4 )" )
-                      .arg( this->tableName(),
-                            this->fieldName( Property::ReagentId ),
-                            Reagent::instance()->fieldName( Reagent::ID ),
-                            Reagent::instance()->tableName()));
-
-    // NOTE: must not delete -1 and -2 tags (NoTag and PixmapTag)
-    QSqlQuery().exec( QString( "delete from %1 where %2!=-1 and %2!=-2 and %2 not in ( select %3 from %4 )" )
-                      .arg( this->tableName(),
-                            this->fieldName( Property::TagId ),
-                            Tag::instance()->fieldName( Tag::ID ),
-                            Tag::instance()->tableName()));
+    // NOTE: orphans are removed by sqlite through foreign keys, this only refreshes in-memory indexes
+    //       (search index entries are removed along with their reagents and tags)
+    this->invalidateOrphans();
 }
@@ -66,6 +66,18 @@ public:
     };
     Q_ENUM( Fields )
 
+    /**
+     * @brief The Flag enum describes display status of a property within the current selection
+     */
+    enum Flag {
+        NoFlags   = 0x0,
+        Batch     = 0x01,
+        Duplicate = 0x02,
+        Override  = 0x04
+    };
+    Q_DECLARE_FLAGS( PropertyFlags, Flag )
+    Q_FLAG( PropertyFlags )
+
     /**
      * @brief instance
      * @return
@@ -78,6 +90,15 @@ public:
     Row add( const QString &name = QString(), const Id &tagId = Id::Invalid,
              const QVariant &value = QVariant(), const Id &reagentId = Id::Invalid );
 
+    bool select() override;
+
+    /**
+     * @brief propertyFlags returns precomputed batch/duplicate/override flags of a property
+     * @param row
+     * @return
+     */
+    [[nodiscard]] PropertyFlags propertyFlags( const Row &row ) const { return this->m_flags.value( static_cast<int>( row ), NoFlags ); }
+
     // initialize field setters and getters
     INITIALIZE_FIELD( Id, ID, id )
     INITIALIZE_FIELD( QString, Name, name )
@@ -94,7 +115,11 @@ public slots:
 
 private:
     explicit Property();
+    void updateFlags();
+    QVector<PropertyFlags> m_flags;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS( Property::PropertyFlags )
+
 // declare enums
 Q_DECLARE_METATYPE( Property::Fields )
@@ -25,6 +25,7 @@
 #include "textedit.h"
 #include "tag.h"
 #include "variable.h"
+#include "variablehandle.h"
 #include "cache.h"
 #include "reagent.h"
 #include "reagentmodel.h"
@@ -42,81 +43,247 @@
 #include "htmlutils.h"
 #include "pixmaputils.h"
 #include "propertydock.h"
+#include "nfpawidget.h"
+#include "ghswidget.h"
 
 /**
- * @brief PropertyDelegate::setupDocument
+ * @brief PropertyDelegate::PropertyDelegate
+ * @param parent
+ */
+PropertyDelegate::PropertyDelegate( QObject *parent ) : QStyledItemDelegate( parent ),
+    nfpaRenderer( new NFPAWidget()), ghsRenderer( new GHSWidget()) {
+    // documents are cheap to rebuild, so keep only those likely to be visible
+    this->cache.setMaxCost( 256 );
+}
+
+/**
+ * @brief PropertyDelegate::~PropertyDelegate
+ */
+PropertyDelegate::~PropertyDelegate() {
+    this->clearCache();
+    delete this->nfpaRenderer;
+    delete this->ghsRenderer;
+}
+
+/**
+ * @brief PropertyDelegate::tagId
+ * NOTE: in property view the index belongs to Property, so the value is read from the model (no queries)
  * @param index
+ * @param propertyId
+ * @return
  */
-void PropertyDelegate::setupDocument( const QModelIndex &index, const QFont &defaultFont ) const {
-    QFont font( defaultFont );
+Id PropertyDelegate::tagId( const QModelIndex &index, const Id &propertyId ) const {
+    if ( !this->viewMode()) {
+        const Row row = Property::instance()->row( index );
+        if ( row != Row::Invalid )
+            return Property::instance()->tagId( row );
+    }
 
-    // reuse document from cache if any
-    if ( this->cache.contains( index ) || !index.isValid())
-        return;
+    const auto it = this->prefetched.constFind( propertyId );
+    return it != this->prefetched.constEnd() ? it->first : Property::instance()->tagId( propertyId );
+}
+
+/**
+ * @brief PropertyDelegate::propertyData
+ * @param index
+ * @param propertyId
+ * @return
+ */
+QVariant PropertyDelegate::propertyData( const QModelIndex &index, const Id &propertyId ) const {
+    if ( !this->viewMode()) {
+        const Row row = Property::instance()->row( index );
+        if ( row != Row::Invalid )
+            return Property::instance()->propertyData( row );
+    }
+
+    const auto it = this->prefetched.constFind( propertyId );
+    return it != this->prefetched.constEnd() ? it->second : Property::instance()->propertyData( propertyId );
+}
+
+/**
+ * @brief PropertyDelegate::tagType
+ * @param tagId
+ * @return
+ */
+Tag::Types PropertyDelegate::tagType( const Id &tagId ) const {
+    const auto it = this->tagTypes.constFind( tagId );
+    if ( it != this->tagTypes.constEnd())
+        return it.value();
+
+    // read from the in-memory model
+    const Row row = Tag::instance()->row( tagId );
+    return row != Row::Invalid ? Tag::instance()->type( row ) : Tag::NoType;
+}
+
+/**
+ * @brief PropertyDelegate::propertyId
+ * @param index
+ * @return
+ */
+Id PropertyDelegate::propertyId( const QModelIndex &index ) const {
+    if ( !index.isValid())
+        return Id::Invalid;
 
-    // get data and tag/property info
-    Id propertyId = Id::Invalid;
-    Row propertyRow = Row::Invalid;
     if ( this->viewMode()) {
-        const QSortFilterProxyModel *proxyModel( qobject_cast<const QSortFilterProxyModel*>( index.model()));
-        const QSqlQueryModel *sourceModel( qobject_cast<const QSqlQueryModel*>( proxyModel->sourceModel()));
-        if ( !index.isValid() || sourceModel->data( proxyModel->mapToSource( index ), Qt::DisplayRole ).isNull())
-            return;
+        const QVariant data( index.data( Qt::DisplayRole ));
+        return data.isNull() ? Id::Invalid : data.value<Id>();
+    }
 
-        propertyId = sourceModel->data( proxyModel->mapToSource( index ), Qt::DisplayRole ).value<Id>();
-        //propertyId = index.data( Qt::DisplayRole ).value<Id>();
-    } else {
-        propertyRow = Property::instance()->row( index );
-        propertyId = Property::instance()->id( propertyRow );
+    return Property::instance()->id( Property::instance()->row( index ));
+}
+
+/**
+ * @brief PropertyDelegate::cacheKey
+ * @param index
+ * @param propertyId
+ * @return
+ */
+QString PropertyDelegate::cacheKey( const QModelIndex &index, const Id &propertyId ) const {
+    const QTableView *view( qobject_cast<QTableView *>( this->parent()));
+
+    // text flags (batch, override, duplicate) depend on neighbouring properties, not on the revision
+    const int flags = ( index.column() == Property::Name && !this->viewMode()) ?
+                static_cast<int>( Property::instance()->propertyFlags( Property::instance()->row( index ))) : 0;
+
+    return QString( "%1/%2/%3/%4/%5" ).arg( static_cast<int>( propertyId ))
+            .arg( index.column())
+            .arg( Property::instance()->revision( propertyId ))
+            .arg( flags )
+            .arg( view != nullptr ? view->columnWidth( index.column()) : 0 );
+}
+
+/**
+ * @brief PropertyDelegate::isSpecialWidget returns true if property is drawn as a NFPA diamond or GHS pictograms
+ * @param index
+ * @param propertyId
+ * @return
+ */
+bool PropertyDelegate::isSpecialWidget( const QModelIndex &index, const Id &propertyId ) const {
+    if ( index.column() != Property::PropertyData && !this->viewMode())
+        return false;
+
+    const Id tagId = this->tagId( index, propertyId );
+    if ( tagId == Id::Invalid )
+        return false;
+
+    const Tag::Types type = this->tagType( tagId );
+    return type == Tag::NFPA || type == Tag::GHS;
+}
+
+/**
+ * @brief PropertyDelegate::widgetSizeHint
+ * @param index
+ * @param propertyId
+ * @return
+ */
+QSize PropertyDelegate::widgetSizeHint( const QModelIndex &index, const Id &propertyId ) const {
+    const QStringList parms( this->propertyData( index, propertyId ).toString().split( " " ));
+
+    if ( this->tagType( this->tagId( index, propertyId )) == Tag::NFPA ) {
+        this->nfpaRenderer->setParameters( parms );
+        return this->nfpaRenderer->sizeHint();
     }
 
+    const QTableView *view( qobject_cast<QTableView *>( this->parent()));
+    this->ghsRenderer->setParameters( parms );
+    return this->ghsRenderer->sizeForWidth( view != nullptr ? view->columnWidth( index.column()) : GHSWidget::scale );
+}
+
+/**
+ * @brief PropertyDelegate::paintWidget paints NFPA/GHS properties directly, without creating index widgets
+ * @param painter
+ * @param option
+ * @param index
+ * @param propertyId
+ */
+void PropertyDelegate::paintWidget( QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index, const Id &propertyId ) const {
+    const QSize size( this->widgetSizeHint( index, propertyId ));
+    const bool isNFPA = this->tagType( this->tagId( index, propertyId )) == Tag::NFPA;
+
+    painter->save();
+    painter->setClipRect( option.rect );
+    painter->translate( this->viewMode() ? option.rect.center().x() - size.width() / 2 : option.rect.left(),
+                        option.rect.top() + ( option.rect.height() - size.height()) / 2 );
+    painter->setRenderHint( QPainter::Antialiasing, true );
+
+    if ( isNFPA )
+        this->nfpaRenderer->paint( painter );
+    else
+        this->ghsRenderer->paint( painter, painter->device()->devicePixelRatioF());
+
+    painter->restore();
+}
+
+/**
+ * @brief PropertyDelegate::document returns a cached document or builds a new one
+ * @param index
+ * @param font
+ * @return
+ */
+QTextDocument *PropertyDelegate::document( const QModelIndex &index, const QFont &font ) const {
+    const Id propertyId = this->propertyId( index );
     if ( propertyId == Id::Invalid )
-        return;
+        return nullptr;
+
+    const QString key( this->cacheKey( index, propertyId ));
+    QTextDocument *document( this->cache.object( key ));
+    if ( document != nullptr )
+        return document;
+
+    document = this->setupDocument( index, propertyId, font );
+    if ( document == nullptr )
+        return nullptr;
+
+    // NOTE: cache takes ownership of the document
+    this->cache.insert( key, document );
+    return document;
+}
+
+/**
+ * @brief PropertyDelegate::setupDocument
+ * @param index
+ * @param propertyId
+ * @param defaultFont
+ * @return
+ */
+QTextDocument *PropertyDelegate::setupDocument( const QModelIndex &index, const Id &propertyId, const QFont &defaultFont ) const {
+    QFont font( defaultFont );
 
-    const QVariant data( Property::instance()->propertyData( propertyId ));
-    const Id tagId = Property::instance()->tagId( propertyId );
-    const Tag::Types tagType = Tag::instance()->type( tagId );
+    const QVariant data( this->propertyData( index, propertyId ));
+    const Id tagId = this->tagId( index, propertyId );
+    const Tag::Types tagType = this->tagType( tagId );
 
     // create a new document
     auto *document( new QTextDocument());
+    bool success = false;
 
     // set special modifiers
     TextFlags flags;
     if ( index.column() == Property::Name && !this->viewMode() )
-       this->setTextFlags( flags, tagId, propertyRow );
+       this->setTextFlags( flags, tagId, Property::instance()->row( index ));
 
-    // special handling of pixmaps and formulas
     if ( tagType == Tag::Formula || tagId == PixmapTag ) {
-        // name column
+        // special handling of pixmaps and formulas
         if ( index.column() == Property::Name && !this->viewMode()) {
-            this->setupTextDocument( index, document, tagType == Tag::Formula ?
-                                         QApplication::translate( "Tag", Tag::instance()->name( tagId ).toUtf8().constData()) :
-                                         Property::instance()->name( propertyId ),
-                                     qAsConst( flags ),
-                                     font );
+            success = this->setupTextDocument( index, document, tagType == Tag::Formula ?
+                                                   QApplication::translate( "Tag", Tag::instance()->name( tagId ).toUtf8().constData()) :
+                                                   Property::instance()->name( propertyId ),
+                                               qAsConst( flags ),
+                                               font );
         } else if ( index.column() == Property::PropertyData || this->viewMode()) {
-            this->setupPixmapDocument( index, document, data.toByteArray(), Tag::instance()->type( tagId ) == Tag::Formula );
+            success = this->setupPixmapDocument( document, data.toByteArray(), this->tagType( tagId ) == Tag::Formula );
         }
-
-        return;
-    }
-
-    // handle custom properties
-    if ( tagId == Id::Invalid ) {
+    } else if ( tagId == Id::Invalid ) {
         // custom properties however do display their names
-        this->setupTextDocument( index, document, ( index.column() == Property::Name ) ? Property::instance()->name( propertyId ) : data.toString(), qAsConst( flags ), qAsConst( font ));
-        return;
-    }
-
-    // properties with built-in tags don't use property names, but rather tag names
-    const QString units( Tag::instance()->units( tagId ).remove( QRegularExpression( R"(<\s*br\s*\/>)" )));
-    QString stringData( data.toString());
-    if ( tagId != Id::Invalid ) {
-        const Tag::Types type = Tag::instance()->type( tagId );
-        if ( type == Tag::Real ) {
+        success = this->setupTextDocument( index, document, ( index.column() == Property::Name ) ? Property::instance()->name( propertyId ) : data.toString(), qAsConst( flags ), qAsConst( font ));
+    } else {
+        // properties with built-in tags don't use property names, but rather tag names
+        const QString units( Tag::instance()->units( tagId ).remove( QRegularExpression( R"(<\s*br\s*\/>)" )));
+        QString stringData( data.toString());
+        if ( tagType == Tag::Real ) {
             stringData.replace( QRegularExpression( "(\\d+)[,.](\\d+)" ),
-                                QString( "\\1%1\\2" ).arg( Variable::string( "decimalSeparator" )));
-        } else if ( type == Tag::State ) {
+                                QString( "\\1%1\\2" ).arg( Variable_::DecimalSeparator.value()));
+        } else if ( tagType == Tag::State ) {
             bool ok;
             int stateIndex = stringData.toInt( &ok );
 
@@ -139,35 +306,42 @@ void PropertyDelegate::setupDocument( const QModelIndex &index, const QFont &def
             default:
                 stringData = PropertyDelegate::tr( "Unknown" );
             }
-        } else if ( type == Tag::Date ) {
+        } else if ( tagType == Tag::Date ) {
             const QDate date( stringData.isEmpty() ? QDate() : QDate::fromJulianDay( stringData.toInt()));
             stringData = date.isValid() ? date.toString( QLocale::system().dateFormat( QLocale::ShortFormat )) : "";
         }
+
+        // setup document
+        success = this->setupTextDocument( index,
+                                           document,
+                                           ( index.column() == Property::Name && !this->viewMode() ?
+                                           QApplication::translate( "Tag", Tag::instance()->name( tagId ).toUtf8().constData()) :
+                                           ( HTMLUtils::simplify( qAsConst( stringData ) + ( this->viewMode() ? "" : units )))),
+                                           qAsConst( flags ),
+                                           font );
+    }
+
+    if ( !success ) {
+        delete document;
+        return nullptr;
     }
 
-    // setup document
-    this->setupTextDocument( index,
-                             document,
-                             ( index.column() == Property::Name && !this->viewMode() ?
-                             QApplication::translate( "Tag", Tag::instance()->name( tagId ).toUtf8().constData()) :
-                             ( HTMLUtils::simplify( qAsConst( stringData ) + ( this->viewMode() ? "" : units )))),
-                             qAsConst( flags ),
-                             font );
+    return document;
 }
 
 /**
  * @brief PropertyDelegate::setupPixmapDocument
  * @param document
  */
-void PropertyDelegate::setupPixmapDocument( const QModelIndex &index, QTextDocument *document, const QByteArray &data, bool isFormula ) const {
+bool PropertyDelegate::setupPixmapDocument( QTextDocument *document, const QByteArray &data, bool isFormula ) const {
     // failsafes
     if ( document == nullptr || data.isEmpty())
-        return;
+        return false;
 
     // read pixmap header
     PixmapInfo info;
     if ( !PixmapUtils::readHeader( data, &info ))
-        return;
+        return false;
 
     // get section width
     const int sectionWidth = PropertyDock::instance()->sectionSize( Property::PropertyData );
@@ -176,7 +350,7 @@ void PropertyDelegate::setupPixmapDocument( const QModelIndex &index, QTextDocum
     const int needsScaling = info.width > sectionWidth - 16;
     const int width = needsScaling ? sectionWidth - 16 : info.width;
     const int height = needsScaling ? static_cast<int>(( static_cast<qreal>( width ) / static_cast<qreal>( info.width )) * static_cast<qreal>( info.height )) : info.height;
-    const bool isDarkMode = Variable::isEnabled( "darkMode" );
+    const bool isDarkMode = Variable_::DarkMode.value();
     QString key( QString( "%1/%2%3.png" ).arg( info.crc ).arg( width ).arg( isDarkMode && isFormula ? "d" : "" ));
 
     // check if mipmap already exists in cache
@@ -187,7 +361,7 @@ void PropertyDelegate::setupPixmapDocument( const QModelIndex &index, QTextDocum
     if ( !isCached && ( needsScaling || ( isDarkMode && isFormula ))) {
         QPixmap pixmap;
         if ( !pixmap.loadFromData( qAsConst( pixmapData )))
-            return;
+            return false;
 
         // special handling of formulas
         if ( isFormula ) {
@@ -206,7 +380,7 @@ void PropertyDelegate::setupPixmapDocument( const QModelIndex &index, QTextDocum
         // convert it back to buffer
         pixmapData = PixmapUtils::toData( pixmap );
         if ( pixmapData.isEmpty())
-            return;
+            return false;
 
         // insert into cache
         Cache::instance()->insert( "property", key, pixmapData );
@@ -218,8 +392,7 @@ void PropertyDelegate::setupPixmapDocument( const QModelIndex &index, QTextDocum
                        .arg( height )
                        .arg( pixmapData.toBase64().constData()));
 
-    // just add to cache
-    this->cache[index] = document;
+    return true;
 }
 
 /**
@@ -228,10 +401,10 @@ void PropertyDelegate::setupPixmapDocument( const QModelIndex &index, QTextDocum
  * @param text
  * @param font
  */
-void PropertyDelegate::setupTextDocument( const QModelIndex &index, QTextDocument *document, const QString &text, const TextFlags &flags, const QFont &font ) const {
+bool PropertyDelegate::setupTextDocument( const QModelIndex &index, QTextDocument *document, const QString &text, const TextFlags &flags, const QFont &font ) const {
     // failsafes
     if ( document == nullptr || text.isEmpty())
-        return;
+        return false;
 
     // apply font and generate initial html
     QString html( QString( R"(<p style="font-size: %1pt; font-family: '%2'"><!--STAR-->%3</p>)" ).arg( QString::number( font.pointSize()), font.family(), qAsConst( text )));
@@ -263,8 +436,9 @@ void PropertyDelegate::setupTextDocument( const QModelIndex &index, QTextDocumen
     // set html to the document
     document->setHtml( qAsConst( html ));
 
-    // finialize and add to cache
+    // finialize document
     this->finializeDocument( index, document );
+    return true;
 }
 
 /**
@@ -278,9 +452,6 @@ void PropertyDelegate::finializeDocument( const QModelIndex &index, QTextDocumen
     document->setDocumentMargin( 2 );
     document->setTextWidth( view != nullptr ? static_cast<int>( view->columnWidth( index.column())) : 128 );
     document->setTextWidth( document->idealWidth());
-
-    // add to cache
-    this->cache[index] = document;
 }
 
 /**
@@ -289,53 +460,9 @@ void PropertyDelegate::finializeDocument( const QModelIndex &index, QTextDocumen
  * @param tagId
  * @param propertyId
  */
-void PropertyDelegate::setTextFlags(TextFlags &flags, const Id &tagId, const Row &propertyRow ) const {
-    // get reagent info
-    const Id reagentId = Property::instance()->reagentId( propertyRow );
-    const Id reagentParentId = Reagent::instance()->parentId( reagentId );
-
-    // check if property belongs to the batch
-    const bool isBatchProperty = Reagent::instance()->parentId( reagentId ) != Id::Invalid;
-
-    // check for overrides
-    if ( isBatchProperty ) {
-        QSqlQuery query;
-        query.exec( QString( "select * from %1 where %2=%3 and %4=%5 and %4!=-2" )
-                    .arg( Property::instance()->tableName(),
-                          Property::instance()->fieldName( Property::ReagentId ),
-                          QString::number( static_cast<int>( reagentParentId )),
-                          Property::instance()->fieldName( Property::TagId ),
-                          QString::number( static_cast<int>( tagId ))));
-        if ( query.next())
-            flags.setFlag( Override );
-    }
-
-    // check for duplicates
-    bool isDuplicate = false;
-    if ( tagId != Id::Invalid ) {
-        if ( !Tag::instance()->function( tagId ).isEmpty()) {
-            // check backwards all scriptable tags for duplicates
-            const int startIndex = static_cast<int>( propertyRow ) - 1;
-            if ( startIndex > 0 ) {
-                for ( int y = startIndex; y >= 0; y-- ) {
-                    const Row propRow = static_cast<Row>( y );
-                    const Id dupTagId = Property::instance()->tagId( propRow );
-                    if ( dupTagId == tagId ) {
-                        isDuplicate = true;
-                        break;
-                    }
-                }
-            }
-        }
-    }
-
-    // NOTE: batch properties are displayed in italic (at least for now)
-    if ( isBatchProperty && !isDuplicate )
-        flags.setFlag( TextFlag::Batch );
-
-    // TODO: add tooltip?
-    if ( isDuplicate )
-        flags.setFlag( TextFlag::Duplicate );
+void PropertyDelegate::setTextFlags( TextFlags &flags, const Id &, const Row &propertyRow ) const {
+    // NOTE: flags are computed for the whole selection when Property is re-selected
+    flags = TextFlags( static_cast<int>( Property::instance()->propertyFlags( propertyRow )));
 }
 
 /**
@@ -362,13 +489,17 @@ void PropertyDelegate::paint( QPainter *painter, const QStyleOptionViewItem &opt
     if ( qobject_cast<QTableView *>( this->parent())->indexWidget( index ) != nullptr )
         return;
 
-    // setup html document
-    this->setupDocument( index, painter->font());
-    if ( !this->cache.contains( index ))
+    // NFPA and GHS properties are painted directly
+    const Id propertyId = this->propertyId( index );
+    if ( propertyId != Id::Invalid && this->isSpecialWidget( index, propertyId )) {
+        this->paintWidget( painter, option, index, propertyId );
         return;
+    }
 
-    // get document
-    QTextDocument *document( this->cache[index] );
+    // setup html document
+    const QTextDocument *document( this->document( index, painter->font()));
+    if ( document == nullptr )
+        return;
 
     // draw html
     painter->save();
@@ -400,14 +531,7 @@ QSize PropertyDelegate::sizeHint( const QStyleOptionViewItem &item, const QModel
     }
 
     // prevents caching before the model initializes
-    Id propertyId = Id::Invalid;
-    if ( this->viewMode())
-        propertyId = index.data( Qt::DisplayRole ).value<Id>();
-    else {
-        const Row propertyRow = Property::instance()->row( index );
-        propertyId = Property::instance()->id( propertyRow );
-    }
-
+    const Id propertyId = this->propertyId( index );
     if ( propertyId == Id::Invalid )
         return QSize();
 
@@ -425,11 +549,15 @@ QSize PropertyDelegate::sizeHint( const QStyleOptionViewItem &item, const QModel
             return QSize();
     }
 
+    // NFPA and GHS properties are painted directly
+    if ( this->isSpecialWidget( index, propertyId ))
+        return this->widgetSizeHint( index, propertyId );
+
     // setup html document
-    this->setupDocument( index, item.font );
-    if ( !this->cache.contains( index ))
+    const QTextDocument *document( this->document( index, item.font ));
+    if ( document == nullptr )
         return QStyledItemDelegate::sizeHint( item, index );
 
     // return document size
-    return this->cache[index]->size().toSize();
+    return document->size().toSize();
 }
@@ -25,8 +25,15 @@
  */
 #include <QStyledItemDelegate>
 #include <QTextDocument>
-#include <QMap>
+#include <QCache>
 #include "table.h"
+#include "tag.h"
+
+//
+// classes
+//
+class NFPAWidget;
+class GHSWidget;
 
 /**
  * @brief The PropertyDelegate class
@@ -48,10 +55,10 @@ public:
     Q_DECLARE_FLAGS( TextFlags, TextFlag )
     Q_FLAG( TextFlags )
 
-    explicit PropertyDelegate( QObject *parent = nullptr ) : QStyledItemDelegate( parent ) {}
+    explicit PropertyDelegate( QObject *parent = nullptr );
+    ~PropertyDelegate() override;
     void paint( QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index ) const override;
     [[nodiscard]] QSize sizeHint( const QStyleOptionViewItem &item, const QModelIndex &index ) const override;
-    mutable QMap<QModelIndex, QTextDocument *> cache;
 
     /**
      * @brief viewMode
@@ -63,12 +70,16 @@ public slots:
     /**
      * @brief clearCache
      */
-    void clearCache() {
-        if ( this->cache.isEmpty())
-            return;
+    void clearCache() { this->cache.clear(); }
 
-        qDeleteAll( this->cache );
-        this->cache.clear();
+    /**
+     * @brief setPrefetched sets (tagId, propertyData) pairs and tag types that are used instead of queries
+     * @param properties
+     * @param tagTypes
+     */
+    void setPrefetched( const QHash<Id, QPair<Id, QVariant>> &properties, const QHash<Id, Tag::Types> &tagTypes ) {
+        this->prefetched = properties;
+        this->tagTypes = tagTypes;
     }
 
     /**
@@ -80,13 +91,30 @@ public slots:
     }
 
 private slots:
-    void setupDocument( const QModelIndex &index, const QFont &font ) const;
-    void setupPixmapDocument( const QModelIndex &index, QTextDocument *document, const QByteArray &data, bool isFormula = false ) const;
-    void setupTextDocument( const QModelIndex &index, QTextDocument *document, const QString &text, const TextFlags &flags, const QFont &font ) const;
+    [[nodiscard]] QTextDocument *document( const QModelIndex &index, const QFont &font ) const;
+    [[nodiscard]] QTextDocument *setupDocument( const QModelIndex &index, const Id &propertyId, const QFont &font ) const;
+    [[nodiscard]] bool setupPixmapDocument( QTextDocument *document, const QByteArray &data, bool isFormula = false ) const;
+    [[nodiscard]] bool setupTextDocument( const QModelIndex &index, QTextDocument *document, const QString &text, const TextFlags &flags, const QFont &font ) const;
     void finializeDocument( const QModelIndex &index, QTextDocument *document ) const;
     void setTextFlags( TextFlags &flags, const Id &tagId, const Row &propertyRow ) const;
 
 private:
-    mutable QMap<QString, QSize> sizeCache;
+    [[nodiscard]] Id propertyId( const QModelIndex &index ) const;
+    [[nodiscard]] Id tagId( const QModelIndex &index, const Id &propertyId ) const;
+    [[nodiscard]] QVariant propertyData( const QModelIndex &index, const Id &propertyId ) const;
+    [[nodiscard]] Tag::Types tagType( const Id &tagId ) const;
+    [[nodiscard]] QString cacheKey( const QModelIndex &index, const Id &propertyId ) const;
+    [[nodiscard]] bool isSpecialWidget( const QModelIndex &index, const Id &propertyId ) const;
+    [[nodiscard]] QSize widgetSizeHint( const QModelIndex &index, const Id &propertyId ) const;
+    void paintWidget( QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index, const Id &propertyId ) const;
+
+    // documents are keyed by property id, column, revision and width (least recently used are evicted)
+    mutable QCache<QString, QTextDocument> cache;
+    NFPAWidget *nfpaRenderer = nullptr;
+    GHSWidget *ghsRenderer = nullptr;
+
+    // prefetched (tagId, propertyData) pairs and tag types used in viewMode
+    QHash<Id, QPair<Id, QVariant>> prefetched;
+    QHash<Id, Tag::Types> tagTypes;
     bool m_viewMode = false;
 };
@@ -40,6 +40,8 @@
 #include "htmlutils.h"
 #include "textutils.h"
 #include "datepicker.h"
+#include "database.h"
+#include "querytracer.h"
 #include <QBuffer>
 #include <QFileDialog>
 #include <QInputDialog>
@@ -52,6 +54,7 @@
 #include <QSqlError>
 #include <QDesktopServices>
 #include <QPainter>
+#include <QScopedPointer>
 
 /**
  * @brief PropertyDock::PropertyDock
@@ -99,7 +102,8 @@ PropertyDock::PropertyDock( QWidget *parent ) : DockWidget( parent ), ui( new Ui
             for ( y = 0; y < Property::instance()->count(); y++ )
                 idList << Property::instance()->id( Property::instance()->row( y ));
 
-            // reorder tasks according to id list
+            // reorder tasks according to id list (in a single commit)
+            Transaction transaction;
             y = 0;
             for ( const Id id : qAsConst( idList )) {
                 Property::instance()->setTableOrder( Property::instance()->row( id ), y );
@@ -129,8 +133,11 @@ PropertyDock::PropertyDock( QWidget *parent ) : DockWidget( parent ), ui( new Ui
         const int order1 = Property::instance()->tableOrder( row1 );
 
         // swap order
-        Property::instance()->setTableOrder( Property::instance()->row( id0 ), order1 );
-        Property::instance()->setTableOrder( Property::instance()->row( id1 ), order0 );
+        {
+            Transaction transaction;
+            Property::instance()->setTableOrder( Property::instance()->row( id0 ), order1 );
+            Property::instance()->setTableOrder( Property::instance()->row( id1 ), order0 );
+        }
 
         Property::instance()->sort( Property::TableOrder, Qt::AscendingOrder );
         Property::instance()->select();
@@ -283,7 +290,6 @@ int PropertyDock::sectionSize( int column ) const {
  */
 void PropertyDock::updateView() {
     this->buttonTest();
-    this->setSpecialWidgets();
     this->ui->propertyView->resizeToContents();
 }
 
@@ -314,11 +320,13 @@ void PropertyDock::on_addPropButton_clicked() {
 
     // get UNFILTERED tags that have been set
     QSqlQuery query;
-    query.exec( QString( "select %1 from %2 where %3=%4 and %1>=0" )
-                        .arg( Property::instance()->fieldName( Property::TagId ),
-                              Property::instance()->tableName(),
-                              Property::instance()->fieldName( Property::ReagentId ),
-                              QString::number( static_cast<int>( reagentId ))));
+    if ( !QueryTracer::exec( query, QString( "select %1 from %2 where %3=%4 and %1>=0" )
+                             .arg( Property::instance()->fieldName( Property::TagId ),
+                                   Property::instance()->tableName(),
+                                   Property::instance()->fieldName( Property::ReagentId ),
+                                   QString::number( static_cast<int>( reagentId ))), "propertyDock" ))
+        return;
+
     QList<Id> allSetTags;
     while ( query.next())
         allSetTags << query.value( 0 ).value<Id>();
@@ -328,9 +336,11 @@ void PropertyDock::on_addPropButton_clicked() {
     QMenu *subMenu( menu.addMenu( PropertyDock::tr( "Add property" )));
 
     // get UNFILTERED tag list
-    query.exec( QString( "select %1 from %2" )
-                        .arg( Tag::instance()->fieldName( Tag::ID ),
-                              Tag::instance()->tableName()));
+    if ( !QueryTracer::exec( query, QString( "select %1 from %2" )
+                             .arg( Tag::instance()->fieldName( Tag::ID ),
+                                   Tag::instance()->tableName()), "propertyDock" ))
+        return;
+
     QList<Id> allTags;
     while ( query.next())
         allTags << query.value( 0 ).value<Id>();
@@ -431,7 +441,7 @@ void PropertyDock::on_propertyView_customContextMenuRequested( const QPoint &pos
              type == Tag::Formula ||
              tagId == Id::Invalid ) {
 
-            QAction *copyAction( menu.addAction( PropertyDock::tr( "Copy" ), this, [ this, index, row, type, tagId
+            QAction *copyAction( menu.addAction( PropertyDock::tr( "Copy" ), this, [ this, row, type, tagId
 #ifdef Q_CC_MSVC
             , mimeTag, mimeData, mimeName
 #endif
@@ -450,31 +460,37 @@ void PropertyDock::on_propertyView_customContextMenuRequested( const QPoint &pos
                                     QString( "\\1%1\\2" ).arg(
                                     Variable::string( "decimalSeparator" ))));
                 } else if ( type == Tag::GHS || type == Tag::NFPA ) {
-                    PropertyViewWidget *widget( qobject_cast<PropertyViewWidget*>( this->ui->propertyView->indexWidget( index )));
-                    if ( widget != nullptr ) {
-                        // upscale widget for a sharp image
-                        const qreal factor = 4.0;
-                        const QSizeF size( widget->sizeHint().width() * factor, widget->sizeHint().height() * factor );
-
-                        // make an empty pixmap
-                        QPixmap pixmap( size.toSize());
-                        pixmap.fill( Qt::transparent );
-                        pixmap.setDevicePixelRatio( factor );
-
-                        // draw widget contents
-                        QPainter painter( &pixmap );
-                        if ( type == Tag::GHS )
-                            qobject_cast<GHSWidget *>( widget )->paint( &painter, factor );
-                        else
-                            widget->render( &painter, QPoint(), QRegion(), QWidget::DrawChildren );
-
-                        painter.end();
-
-                        // add proper transparent image to clipboard
-                        const QByteArray pixmapData( PixmapUtils::toData( pixmap ));
-                        propertyData->setData( "PNG", pixmapData );
-                        propertyData->setData( "image/png", pixmapData );
-                    }
+                    const QStringList parms( data.toString().split( " " ));
+                    QScopedPointer<PropertyViewWidget> widget;
+                    if ( type == Tag::GHS )
+                        widget.reset( new GHSWidget( nullptr, parms ));
+                    else
+                        widget.reset( new NFPAWidget( nullptr, parms ));
+
+                    // upscale widget for a sharp image
+                    const qreal factor = 4.0;
+                    const QSize hint( type == Tag::GHS ? qobject_cast<GHSWidget *>( widget.data())->sizeForWidth( this->sectionSize( Property::PropertyData )) : widget->sizeHint());
+                    const QSizeF size( hint.width() * factor, hint.height() * factor );
+
+                    // make an empty pixmap
+                    QPixmap pixmap( size.toSize());
+                    pixmap.fill( Qt::transparent );
+                    pixmap.setDevicePixelRatio( factor );
+
+                    // draw widget contents
+                    QPainter painter( &pixmap );
+                    painter.setRenderHint( QPainter::Antialiasing, true );
+                    if ( type == Tag::GHS )
+                        qobject_cast<GHSWidget *>( widget.data())->paint( &painter, factor );
+                    else
+                        qobject_cast<NFPAWidget *>( widget.data())->paint( &painter );
+
+                    painter.end();
+
+                    // add proper transparent image to clipboard
+                    const QByteArray pixmapData( PixmapUtils::toData( pixmap ));
+                    propertyData->setData( "PNG", pixmapData );
+                    propertyData->setData( "image/png", pixmapData );
                 } else {
                     QGuiApplication::clipboard()->setText( HTMLUtils::toPlainText( data.toString()));
                 }
@@ -572,12 +588,10 @@ void PropertyDock::on_propertyView_customContextMenuRequested( const QPoint &pos
 
             if ( tagId != Id::Invalid ) {
                 QSqlQuery query;
-                query.exec( QString( "select %1 from %2 where %1=%3" ).arg(
-                                Tag::instance()->fieldName( Tag::ID ),
-                                Tag::instance()->tableName(),
-                                QString::number( static_cast<int>( tagId ))));
-
-                ok = query.next();
+                ok = QueryTracer::exec( query, QString( "select %1 from %2 where %1=%3" ).arg(
+                                            Tag::instance()->fieldName( Tag::ID ),
+                                            Tag::instance()->tableName(),
+                                            QString::number( static_cast<int>( tagId ))), "propertyDock" ) && query.next();
             }
 
             if ( ok ) {
@@ -641,52 +655,6 @@ void PropertyDock::on_removePropButton_clicked() {
     this->updateView();
 }
 
-/**
- * @brief PropertyDock::setSpecialWidgets
- */
-void PropertyDock::setSpecialWidgets() {
-    for ( int y = 0; y < Property::instance()->count(); y++ ) {
-        const Row row = Property::instance()->row( y );
-        const Id tagId = Property::instance()->tagId( row );
-
-        bool pixmap = false;
-        if ( tagId != Id::Invalid )
-            pixmap = Tag::instance()->type( tagId ) == Tag::Formula || tagId == PixmapTag;
-
-        if ( tagId == Id::Invalid || pixmap )
-            continue;
-
-        const Tag::Types type = Tag::instance()->type( tagId );
-        if ( type == Tag::NFPA || type == Tag::GHS ) {
-            const QModelIndex index( Property::instance()->index( y, Property::PropertyData ));
-            const QStringList parms( Property::instance()->propertyData( row ).toString().split( " " ));
-            QWidget *widget( this->ui->propertyView->indexWidget( index ));
-            bool hasWidget = widget != nullptr;
-
-            auto setWidget = [ this, index, hasWidget, parms ]( PropertyViewWidget *widget ) {
-                if ( widget == nullptr )
-                    return;
-
-                if ( hasWidget ) {
-                    widget->update( parms );
-                } else {
-                    // set widget and make sure to delete it on close
-                    this->ui->propertyView->setIndexWidget( index, widget );
-                    widget->setAttribute( Qt::WA_DeleteOnClose, true );
-                }
-            };
-
-            if ( type == Tag::NFPA ) {
-                NFPAWidget *nfpa( hasWidget ? dynamic_cast<NFPAWidget *>( widget ) : new NFPAWidget( nullptr, parms ));
-                setWidget( nfpa );
-            } else {
-                GHSWidget *ghs( hasWidget ? dynamic_cast<GHSWidget *>( widget ) : new GHSWidget( nullptr, parms ));
-                setWidget( ghs );
-            }
-        }
-    }
-}
-
 /**
  * @brief PropertyDock::setCurrentIndex
  * @param index
@@ -797,13 +765,12 @@ void PropertyDock::addProperty( const QString &name, const QVariant &value, cons
     // warn if property already exists (skip custom and pixmap properties)
     if ( tagId != Id::Invalid && tagId != PixmapTag ) {
         QSqlQuery query;
-        query.exec( QString( "select * from %1 where %2=%3 and %4=%5" )
-                    .arg( Property::instance()->tableName(),
-                          Property::instance()->fieldName( Property::ReagentId ),
-                          QString::number( static_cast<int>( reagentId )),
-                          Property::instance()->fieldName( Property::TagId ),
-                          QString::number( static_cast<int>( tagId ))));
-        if ( query.next()) {
+        if ( QueryTracer::exec( query, QString( "select * from %1 where %2=%3 and %4=%5" )
+                                .arg( Property::instance()->tableName(),
+                                      Property::instance()->fieldName( Property::ReagentId ),
+                                      QString::number( static_cast<int>( reagentId )),
+                                      Property::instance()->fieldName( Property::TagId ),
+                                      QString::number( static_cast<int>( tagId ))), "propertyDock" ) && query.next()) {
             if ( QMessageBox::question( this, PropertyDock::tr( "Duplicate property" ),
                                         PropertyDock::tr( "Reagent already has this property, add regardless?" )) == QMessageBox::No ) {
                 this->ui->propertyView->setUpdatesEnabled( true );
@@ -61,7 +61,6 @@ public:
 public slots:
     void updateView();
     void clearDocumentCache();
-    void setSpecialWidgets();
     void setCurrentIndex( const QModelIndex &index );
     void replacePixmap( const Row &row, bool isFormula = false );
     void saveHiddenTags();
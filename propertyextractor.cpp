@@ -0,0 +1,348 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "propertyextractor.h"
+#include "tag.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <algorithm>
+
+/**
+ * @brief PropertyExtractor::parse
+ * @param data
+ * @param errorString set on failure
+ * @return document root (undefined on failure)
+ */
+QJsonValue PropertyExtractor::parse( const QByteArray &data, QString *errorString ) {
+    // NOTE: must be UTF8, otherwise json parser fails
+    QJsonParseError error;
+    const QJsonDocument document( QJsonDocument::fromJson( QString( data ).toUtf8(), &error ));
+    if ( error.error != QJsonParseError::NoError ) {
+        if ( errorString != nullptr )
+            *errorString = error.errorString();
+
+        return QJsonValue( QJsonValue::Undefined );
+    }
+
+    return document.isArray() ? QJsonValue( document.array()) : document.object();
+}
+
+/**
+ * @brief PropertyExtractor::values returns [display value, captured values...] lists found under the given heading
+ * @param document
+ * @param heading TOCHeading
+ * @param name optional information name filter
+ * @param pattern optional regular expression for capturing values
+ * @param global capture all matches
+ * @return
+ */
+QList<QStringList> PropertyExtractor::values( const QJsonValue &document, const QString &heading, const QString &name, const QString &pattern, bool global ) {
+    QList<QJsonArray> matches;
+    PropertyExtractor::findTag( document, heading, matches );
+    QList<QStringList> values;
+    PropertyExtractor::extractValues( qAsConst( matches ), name, pattern, values, global );
+
+    return values;
+}
+
+/**
+ * @brief PropertyExtractor::extract extracts values of all tags that have an extraction script
+ * @param document
+ * @param tags limits extraction to these tags (all if empty)
+ * @return
+ */
+QMap<Id, QList<QStringList>> PropertyExtractor::extract( const QJsonValue &document, const QList<Id> &tags ) {
+    QMap<Id, QList<QStringList>> map;
+
+    for ( int y = 0; y < Tag::instance()->count(); y++ ) {
+        const auto row = static_cast<Row>( y );
+        const Id id( Tag::instance()->id( row ));
+
+        // check for selected tags for extraction
+        if ( !tags.isEmpty() && !tags.contains( id ))
+            continue;
+
+        // script format: heading;name;pattern;global
+        const QString script( Tag::instance()->script( row ).toString());
+        if ( script.isEmpty())
+            continue;
+
+        const QStringList args( script.split( ";" ));
+        const QString heading( args.count() >= 1 ? args.at( 0 ) : "" );
+        const QString name( args.count() >= 2 ? args.at( 1 ) : "" );
+        const QString pattern( args.count() >= 3 ? args.at( 2 ) : "" );
+        const bool global( args.count() >= 4 ? args.at( 3 ).toInt() : false );
+
+        const QList<QStringList> values( PropertyExtractor::values( document, heading, name, pattern, global ));
+        if ( !values.isEmpty())
+            map[id] = values;
+    }
+
+    return map;
+}
+
+/**
+ * @brief PropertyExtractor::propertyData converts extracted values (without the display value) to property data
+ * @param tagId
+ * @param values
+ * @return invalid variant if values of this tag type cannot be stored
+ */
+QVariant PropertyExtractor::propertyData( const Id &tagId, const QStringList &values ) {
+    if ( values.isEmpty())
+        return QVariant();
+
+    switch ( Tag::instance()->type( tagId )) {
+    case Tag::PubChemId:
+    case Tag::Text:
+    case Tag::Integer:
+    case Tag::Real:
+    case Tag::CAS:
+        return values.first();
+
+    case Tag::NFPA:
+        return values.join( " " );
+
+    case Tag::GHS:
+        return PropertyExtractor::parseGHS( values ).join( " " );
+
+    default:
+        break;
+    }
+
+    return QVariant();
+}
+
+/**
+ * @brief PropertyExtractor::parseGHS
+ * @param list
+ * @return
+ */
+QStringList PropertyExtractor::parseGHS( const QStringList &list ) {
+    QStringList parms;
+    for ( const QString &parm : list ) {
+        if ( parm.contains( QRegularExpression( "[Ee]xplosive" )))
+            parms << "GHS01";
+        if ( parm.contains( QRegularExpression( "[Ff]lammable" )))
+            parms << "GHS02";
+        if ( parm.contains( QRegularExpression( "[Oo]xidizing" )))
+            parms << "GHS03";
+        if ( parm.contains( QRegularExpression( "[Cc]ompressed\\s[Gg]as" )))
+            parms << "GHS04";
+        if ( parm.contains( QRegularExpression( "[Cc]orrosive" )))
+            parms << "GHS05";
+        if ( parm.contains( QRegularExpression( "[Tt]oxic" )))
+            parms << "GHS06";
+        if ( parm.contains( QRegularExpression( "[Hh]armful" )) ||
+             parm.contains( QRegularExpression( "[Ii]rritant" )))
+            parms << "GHS07";
+        if ( parm.contains( QRegularExpression( "[Hh]ealth\\s[Hh]azard" )))
+            parms << "GHS08";
+        if ( parm.contains( QRegularExpression( "[Ee]nvironmental\\s[Hh]azard" )))
+            parms << "GHS09";
+    }
+    return qAsConst( parms );
+}
+
+/**
+ * @brief PropertyExtractor::findTag finds a TOCHeading in json document
+ * @param value
+ * @param heading
+ * @param matches
+ */
+void PropertyExtractor::findTag( const QJsonValue &value, const QString &heading, QList<QJsonArray> &matches ) {
+    if ( value.isObject()) {
+        const QJsonObject object( value.toObject());
+
+        const QStringList keys( object.keys());
+        for ( const QString &key : keys ) {
+            const QJsonValue keyValue( object.value( key ));
+
+            if ( !QString::compare( key, "TOCHeading" )) {
+                if ( !keyValue.isArray() && !keyValue.isObject()) {
+                    if ( !QString::compare( keyValue.toVariant().toString(), heading )) {
+                        if ( object.contains( "Information" )) {
+                            const QJsonValue infoValue( object.value( "Information" ));
+                            if ( infoValue.isArray())
+                                matches << infoValue.toArray();
+                        }
+                    }
+                }
+            }
+
+            PropertyExtractor::findTag( keyValue, heading, matches );
+        }
+    } else if ( value.isArray()) {
+        const QJsonArray array( value.toArray());
+
+        for ( const QJsonValue &arrayValue : array )
+            PropertyExtractor::findTag( arrayValue, heading, matches );
+    }
+}
+
+/**
+ * @brief PropertyExtractor::extractValues gets string or numeric values from json
+ * @param matches
+ * @param name
+ * @param pattern
+ * @param out
+ * @param global
+ */
+void PropertyExtractor::extractValues( const QList<QJsonArray> &matches, const QString &name, const QString &pattern, QList<QStringList> &out, bool global ) {
+    QStringList values;
+
+    for ( const QJsonArray &array : matches ) {
+        for ( const QJsonValue &info : array ) {
+            if ( info.isObject()) {
+                const QJsonObject infoObject( info.toObject());
+
+                if ( !name.isEmpty() && infoObject.contains( "Name" )) {
+                    const QJsonValue nameValue( infoObject["Name"] );
+                    if ( !nameValue.isArray() && !nameValue.isObject()) {
+                        if ( QString::compare( nameValue.toString(), name ))
+                            continue;
+                    }
+                }
+
+                if ( infoObject.contains( "Value" )) {
+                    const QJsonValue value( infoObject["Value"] );
+
+                    if ( value.isObject()) {
+                        const QJsonObject valueObject( value.toObject());
+                        QString units;
+                        if ( valueObject.contains( "Unit" ))
+                            units = valueObject["Unit"].toVariant().toString();
+
+                        if ( valueObject.contains( "Number" )) {
+                            const QJsonValue numberTag( valueObject["Number"] );
+                            if ( numberTag.isArray()) {
+                                const QJsonArray numberArray( numberTag.toArray());
+                                for ( const QJsonValue &number : numberArray )
+                                    values << QString( "%1 %2" ).arg( number.toDouble()).arg( qAsConst( units ));
+                            }
+                        } else if ( valueObject.contains( "StringWithMarkup" )) {
+                            const QJsonValue &stringTag( valueObject["StringWithMarkup"] );
+                            if ( stringTag.isArray()) {
+
+                                const QJsonArray &stringArray( stringTag.toArray());
+                                for ( const QJsonValue &stringValue : stringArray ) {
+                                    if ( stringValue.isObject()) {
+                                        const QJsonObject &stringObject( stringValue.toObject());
+                                        QStringList extra;
+                                        if ( stringObject.keys().contains( "Markup" )) {
+                                            const QJsonValue &markupTag( stringObject["Markup"] );
+                                            if ( markupTag.isArray()) {
+                                                const QJsonArray &markupArray( markupTag.toArray());
+                                                if ( markupArray.count()) {
+                                                    for ( const QJsonValue &markupValue : markupArray ) {
+                                                        if ( markupValue.isObject()) {
+                                                            const QJsonObject &markupObject( markupValue.toObject());
+
+                                                            if ( markupObject.contains( "Type" )) {
+                                                                const QJsonValue &typeValue( markupObject["Type"] );
+                                                                if ( !typeValue.isArray() && !typeValue.isObject()) {
+                                                                    if ( !QString::compare( typeValue.toString(), "PubChem Internal Link" )) {
+                                                                        continue;
+                                                                    }
+                                                                }
+                                                            }
+
+                                                            if ( markupObject.contains( "Extra" )) {
+                                                                const QJsonValue &extraValue( markupObject["Extra"] );
+                                                                if ( !extraValue.isArray() && !extraValue.isObject()) {
+                                                                    extra << extraValue.toString();
+                                                                }
+                                                            }
+                                                        }
+                                                    }
+                                                }
+                                            }
+                                        }
+
+                                        if ( !extra.isEmpty()) {
+                                            values << extra.join( ", " );
+                                            continue;
+                                        }
+
+                                        if ( stringObject.contains( "String" ))
+                                            values << QString( "%1" ).arg( stringObject["String"].toVariant().toString());
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    values.removeDuplicates();
+
+    if ( !pattern.isEmpty()) {
+        const QRegularExpression re( pattern );
+
+        if ( !re.isValid())
+            return;
+
+        for ( const QString &value : qAsConst( values )) {
+            QStringList captured;
+
+            const QString stripped( QString( value ).remove( QRegularExpression( R"(\(\w+, \d{4}\))" )));
+            auto matcher = [ &captured, stripped, re, global, value ]( const QRegularExpressionMatch &match ) {
+                if ( match.hasMatch()) {
+                    int k = 0;
+
+                    if ( global )
+                        k = 1;
+
+                    for ( ; k < match.capturedTexts().count(); k++ ) {
+                        const QString matched( match.captured( k ).simplified());
+                        captured << matched;
+                    }
+                }
+            };
+
+            if ( global ) {
+                QRegularExpressionMatchIterator i( re.globalMatch( stripped ));
+                captured << "";
+                while ( i.hasNext())
+                    matcher( i.next());
+            } else {
+                matcher( re.match( stripped ));
+            }
+
+            if ( !out.contains( captured ) && !captured.isEmpty())
+                out.append( captured );
+        }
+    } else {
+        for ( const QString &value : qAsConst( values ))
+            out << ( QStringList() << value << value );
+    }
+
+
+    // de-prioritize imperial temperature units
+    std::sort( out.begin(), out.end(), []( const QStringList &l, const QStringList &r ) {
+        if ( l.isEmpty() || r.isEmpty())
+            return false;
+
+        return l.first().contains( "°F" ) < r.first().contains( "°F" );
+    } );
+}
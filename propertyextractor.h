@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QMap>
+#include <QStringList>
+#include "table.h"
+
+/**
+ * @brief The PropertyExtractor class extracts tag values from PubChem (PUG View) json documents
+ * using the extraction scripts of tags
+ */
+class PropertyExtractor final {
+    Q_DISABLE_COPY( PropertyExtractor )
+
+public:
+    // disable move
+    PropertyExtractor( PropertyExtractor&& ) = delete;
+    PropertyExtractor& operator=( PropertyExtractor&& ) = delete;
+
+    [[nodiscard]] static QJsonValue parse( const QByteArray &data, QString *errorString = nullptr );
+    [[nodiscard]] static QList<QStringList> values( const QJsonValue &document, const QString &heading, const QString &name = QString(), const QString &pattern = QString(), bool global = false );
+    [[nodiscard]] static QMap<Id, QList<QStringList>> extract( const QJsonValue &document, const QList<Id> &tags = QList<Id>());
+    [[nodiscard]] static QVariant propertyData( const Id &tagId, const QStringList &values );
+    [[nodiscard]] static QStringList parseGHS( const QStringList &list );
+
+private:
+    explicit PropertyExtractor() {}
+    static void findTag( const QJsonValue &value, const QString &heading, QList<QJsonArray> &matches );
+    static void extractValues( const QList<QJsonArray> &matches, const QString &name, const QString &pattern, QList<QStringList> &out, bool global );
+};
@@ -31,6 +31,7 @@
 #include "pixmaputils.h"
 #include "property.h"
 #include "tagselectiondialog.h"
+#include "propertyextractor.h"
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonValue>
@@ -270,247 +271,38 @@ bool PropertyFragment::getDataAndFormula( const int &id ) {
  * @param uncompressed
  */
 void PropertyFragment::readData( const QByteArray &uncompressed ) {
-    /**
-     * @brief findTag finds a TOCHeading in json document
-     */
-    std::function<void( const QJsonValue &, const QString &heading, QList<QJsonArray> &matches )> findTag;
-    findTag = [ &findTag ]( const QJsonValue &value, const QString &heading, QList<QJsonArray> &matches ) {
-        if ( value.isObject()) {
-            const QJsonObject object( value.toObject());
-
-            const QStringList keys( object.keys());
-            for ( const QString &key : keys ) {
-                const QJsonValue keyValue( object.value( key ));
-
-                if ( !QString::compare( key, "TOCHeading" )) {
-                    if ( !keyValue.isArray() && !keyValue.isObject()) {
-                        if ( !QString::compare( keyValue.toVariant().toString(), heading )) {
-                            if ( object.contains( "Information" )) {
-                                const QJsonValue infoValue( object.value( "Information" ));
-                                if ( infoValue.isArray())
-                                    matches << infoValue.toArray();
-                            }
-                        }
-                    }
-                }
-
-                findTag( keyValue, heading, matches );
-            }
-        } else if ( value.isArray()) {
-            const QJsonArray array( value.toArray());
-
-            for ( const QJsonValue &arrayValue : array )
-                findTag( arrayValue, heading, matches );
-        }
-    };
-
-    /**
-     * @brief extractValues gets string or numeric values from json
-     */
-    auto extractValues = []( const QList<QJsonArray> &matches, const QString &name, const QString &pattern, QList<QStringList> &out, bool global ) {
-        QStringList values;
-
-        for ( const QJsonArray &array : matches ) {
-            for ( const QJsonValue &info : array ) {
-                if ( info.isObject()) {
-                    const QJsonObject infoObject( info.toObject());
-
-                    if ( !name.isEmpty() && infoObject.contains( "Name" )) {
-                        const QJsonValue nameValue( infoObject["Name"] );
-                        if ( !nameValue.isArray() && !nameValue.isObject()) {
-                            if ( QString::compare( nameValue.toString(), name ))
-                                continue;
-                        }
-                    }
-
-                    if ( infoObject.contains( "Value" )) {
-                        const QJsonValue value( infoObject["Value"] );
-
-                        if ( value.isObject()) {
-                            const QJsonObject valueObject( value.toObject());
-                            QString units;
-                            if ( valueObject.contains( "Unit" ))
-                                units = valueObject["Unit"].toVariant().toString();
-
-                            if ( valueObject.contains( "Number" )) {
-                                const QJsonValue numberTag( valueObject["Number"] );
-                                if ( numberTag.isArray()) {
-                                    const QJsonArray numberArray( numberTag.toArray());
-                                    for ( const QJsonValue &number : numberArray )
-                                        values << QString( "%1 %2" ).arg( number.toDouble()).arg( qAsConst( units ));
-                                }
-                            } else if ( valueObject.contains( "StringWithMarkup" )) {
-                                const QJsonValue &stringTag( valueObject["StringWithMarkup"] );
-                                if ( stringTag.isArray()) {
-
-                                    const QJsonArray &stringArray( stringTag.toArray());
-                                    for ( const QJsonValue &stringValue : stringArray ) {
-                                        if ( stringValue.isObject()) {
-                                            const QJsonObject &stringObject( stringValue.toObject());
-                                            QStringList extra;
-                                            if ( stringObject.keys().contains( "Markup" )) {
-                                                const QJsonValue &markupTag( stringObject["Markup"] );
-                                                if ( markupTag.isArray()) {
-                                                    const QJsonArray &markupArray( markupTag.toArray());
-                                                    if ( markupArray.count()) {
-                                                        for ( const QJsonValue &markupValue : markupArray ) {
-                                                            if ( markupValue.isObject()) {
-                                                                const QJsonObject &markupObject( markupValue.toObject());
-
-                                                                if ( markupObject.contains( "Type" )) {
-                                                                    const QJsonValue &typeValue( markupObject["Type"] );
-                                                                    if ( !typeValue.isArray() && !typeValue.isObject()) {
-                                                                        if ( !QString::compare( typeValue.toString(), "PubChem Internal Link" )) {
-                                                                            continue;
-                                                                        }
-                                                                    }
-                                                                }
-
-                                                                if ( markupObject.contains( "Extra" )) {
-                                                                    const QJsonValue &extraValue( markupObject["Extra"] );
-                                                                    if ( !extraValue.isArray() && !extraValue.isObject()) {
-                                                                        extra << extraValue.toString();
-                                                                    }
-                                                                }
-                                                            }
-                                                        }
-                                                    }
-                                                }
-                                            }
-
-                                            if ( !extra.isEmpty()) {
-                                                values << extra.join( ", " );
-                                                continue;
-                                            }
-
-                                            if ( stringObject.contains( "String" ))
-                                                values << QString( "%1" ).arg( stringObject["String"].toVariant().toString());
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        values.removeDuplicates();
-
-        if ( !pattern.isEmpty()) {
-            const QRegularExpression re( pattern );
-
-            if ( !re.isValid())
-                return;
-
-            for ( const QString &value : qAsConst( values )) {
-                QStringList captured;
-
-                const QString stripped( QString( value ).remove( QRegularExpression( R"(\(\w+, \d{4}\))" )));
-                auto matcher = [ &captured, stripped, re, global, value ]( const QRegularExpressionMatch &match ) {
-                    if ( match.hasMatch()) {
-                        int k = 0;
-
-                        if ( global )
-                            k = 1;
-
-                        for ( ; k < match.capturedTexts().count(); k++ ) {
-                            const QString matched( match.captured( k ).simplified());
-                            captured << matched;
-                        }
-                    }
-                };
-
-                if ( global ) {
-                    QRegularExpressionMatchIterator i( re.globalMatch( stripped ));
-                    captured << "";
-                    while ( i.hasNext())
-                        matcher( i.next());
-                } else {
-                    matcher( re.match( stripped ));
-                }
-
-                if ( !out.contains( captured ) && !captured.isEmpty())
-                    out.append( captured );
-            }
-        } else {
-            for ( const QString &value : qAsConst( values ))
-                out << ( QStringList() << value << value );
-        }
-
-
-        // de-prioritize imperial temperature units
-        std::sort( out.begin(), out.end(), []( const QStringList &l, const QStringList &r ) {
-            if ( l.isEmpty() || r.isEmpty())
-                return false;
-
-            return l.first().contains( "°F" ) < r.first().contains( "°F" );
-        } );
-    };
-
-    // NOTE: must be UTF8, otherwise json parser fails
-    QJsonParseError error;
-    const QJsonDocument document( QJsonDocument::fromJson( QString( uncompressed ).toUtf8(), &error ));
-    if ( error.error != QJsonParseError::NoError ) {
-        this->host()->setErrorMessage( StructureFragment::tr( "JSON parse error: " ) + error.errorString());
+    QString errorString;
+    const QJsonValue document( PropertyExtractor::parse( uncompressed, &errorString ));
+    if ( document.isUndefined()) {
+        this->host()->setErrorMessage( StructureFragment::tr( "JSON parse error: " ) + errorString );
         return;
     }
 
-    const QJsonValue value( document.isArray() ? QJsonValue( document.array()) : document.object());
-    auto getPropertyFromJson = [ value, findTag, extractValues ]( const QString &tagName, const QString &valueName = QString(), const QString &pattern = QString(), bool global = false ) {
-        QList<QJsonArray> matches;
-        findTag( value, tagName, matches );
-        QList<QStringList> values;
-        extractValues( qAsConst( matches ), valueName, pattern, values, global );
-
-        return values;
-    };
-
     // get selected tags
     const QList<Id> selectedTags = ListUtils::toNumericList<Id>( Variable::value<QStringList>( "propertyFragment/selectedTags" ));
 
     // get properties and fill table widget
     QMap<QString, PropertyWidget*>propList;
+    const QMap<Id, QList<QStringList>> extracted( PropertyExtractor::extract( document, selectedTags ));
+    for ( auto it = extracted.constBegin(); it != extracted.constEnd(); ++it ) {
+        auto *group( new PropertyWidget( nullptr, it.value(), it.key()));
+        propList[QApplication::translate( "Tag", Tag::instance()->name( it.key()).toUtf8().constData())] = group;
+    }
+
+    // pubchem id is not a part of the document
     for ( int y = 0; y < Tag::instance()->count(); y++ ) {
         const auto row = static_cast<Row>( y );
 
-        // check for selected tags for extraction
-        if ( !selectedTags.isEmpty()) {
-            const Id id( Tag::instance()->id( row ));
-
-            // not in the list? - continue
-            if ( !selectedTags.contains( id ))
-                continue;
-        }
-
-        const QString script( Tag::instance()->script( row ).toString());
-        if ( !script.isEmpty()) {
-            const QStringList args( script.split( ";" ));
-
-            if ( args.isEmpty())
-                continue;
-
-            const QString tagName( args.count() >= 1 ? args.at( 0 ) : "" );
-            const QString valueName( args.count() >= 2 ? args.at( 1 ) : "" );
-            const QString pattern( args.count() >= 3 ? args.at( 2 ) : "" );
-            const bool global( args.count() >= 4 ? args.at( 3 ).toInt() : false );
-
-            const QList<QStringList> values( getPropertyFromJson( tagName, valueName, pattern, global ));
-            if ( values.isEmpty())
-                continue;
+        if ( Tag::instance()->type( row ) != Tag::PubChemId )
+            continue;
 
-            auto *group( new PropertyWidget( nullptr, values, Tag::instance()->id( row )));
-            //propList[Tag::instance()->name( row )] = group;
-            propList[QApplication::translate( "Tag", Tag::instance()->name( row ).toUtf8().constData())] = group;
+        if ( !selectedTags.isEmpty() && !selectedTags.contains( Tag::instance()->id( row )))
             continue;
-        }
 
-        if ( Tag::instance()->type( row ) == Tag::PubChemId ) {
-            const QString cid( QString::number( this->host()->structureFragment()->cid()));
-            const QList<QStringList> list = QList<QStringList>() << ( QStringList() << cid << cid );
-            auto *group( new PropertyWidget( nullptr, list, Tag::instance()->id( row )));
-            propList[QApplication::translate( "Tag", Tag::instance()->name( row ).toUtf8().constData())] = group;
-        }
+        const QString cid( QString::number( this->host()->structureFragment()->cid()));
+        const QList<QStringList> list = QList<QStringList>() << ( QStringList() << cid << cid );
+        auto *group( new PropertyWidget( nullptr, list, Tag::instance()->id( row )));
+        propList[QApplication::translate( "Tag", Tag::instance()->name( row ).toUtf8().constData())] = group;
     }
 
     int row = this->ui->propertyView->rowCount();
@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "propertyindex.h"
+#include "property.h"
+#include "main.h"
+#include "querytracer.h"
+#include <QSqlQuery>
+
+/**
+ * @brief PropertyIndex::PropertyIndex
+ */
+PropertyIndex::PropertyIndex() {
+    // keep posting lists up to date
+    PropertyIndex::connect( Property::instance(), &Table::entryAdded, this, &PropertyIndex::add );
+    PropertyIndex::connect( Property::instance(), &Table::entryAboutToBeRemoved, this, &PropertyIndex::remove );
+    PropertyIndex::connect( Property::instance(), &Table::entryChanged, this, &PropertyIndex::change );
+    PropertyIndex::connect( Property::instance(), &Table::invalidated, this, &PropertyIndex::clear );
+    PropertyIndex::connect( Property::instance(), &Table::orphansRemoved, this, &PropertyIndex::clear );
+
+    // add to garbage collector
+    GarbageMan::instance()->add( this );
+}
+
+/**
+ * @brief PropertyIndex::histogram returns number of properties per value of the given tag
+ * @param tagId
+ * @return
+ */
+QMap<QString, int> PropertyIndex::histogram( const Id &tagId ) {
+    this->build( tagId );
+
+    QMap<QString, int> histogram;
+    const QMap<QString, QList<Id>> &values( this->postings[tagId] );
+    for ( auto it = values.constBegin(); it != values.constEnd(); ++it )
+        histogram[it.key()] = it.value().count();
+
+    return histogram;
+}
+
+/**
+ * @brief PropertyIndex::reagents returns all reagents that have a property with the given tag
+ * @param tagId
+ * @return
+ */
+QSet<Id> PropertyIndex::reagents( const Id &tagId ) {
+    this->build( tagId );
+
+    QSet<Id> reagents;
+    for ( const QList<Id> &list : qAsConst( this->postings[tagId] ))
+        for ( const Id &id : list )
+            reagents << id;
+
+    return reagents;
+}
+
+/**
+ * @brief PropertyIndex::reagents returns reagents that have a property with the given tag and value
+ * @param tagId
+ * @param value
+ * @return
+ */
+QSet<Id> PropertyIndex::reagents( const Id &tagId, const QString &value ) {
+    this->build( tagId );
+
+    QSet<Id> reagents;
+    for ( const Id &id : this->postings[tagId].value( value ))
+        reagents << id;
+
+    return reagents;
+}
+
+/**
+ * @brief PropertyIndex::clear
+ */
+void PropertyIndex::clear() {
+    this->entries.clear();
+    this->postings.clear();
+}
+
+/**
+ * @brief PropertyIndex::build reads all property values of a tag on first use
+ * @param tagId
+ */
+void PropertyIndex::build( const Id &tagId ) {
+    if ( this->postings.contains( tagId ))
+        return;
+
+    // make sure an empty tag is not scanned again
+    this->postings[tagId] = QMap<QString, QList<Id>>();
+
+    QSqlQuery query;
+    QueryTracer::exec( query, QString( "select %1, %2, cast( %3 as text ) from %4 where %5=%6" )
+                .arg( Property::instance()->fieldName( Property::ID ),
+                      Property::instance()->fieldName( Property::ReagentId ),
+                      Property::instance()->fieldName( Property::PropertyData ),
+                      Property::instance()->tableName(),
+                      Property::instance()->fieldName( Property::TagId ),
+                      QString::number( static_cast<int>( tagId ))), "index" );
+
+    while ( query.next())
+        this->insert( query.value( 0 ).value<Id>(), tagId, query.value( 1 ).value<Id>(), query.value( 2 ).toString());
+}
+
+/**
+ * @brief PropertyIndex::insert
+ * @param propertyId
+ * @param tagId
+ * @param reagentId
+ * @param value
+ */
+void PropertyIndex::insert( const Id &propertyId, const Id &tagId, const Id &reagentId, const QString &value ) {
+    this->entries[propertyId] = Entry { tagId, reagentId, value };
+    this->postings[tagId][value] << reagentId;
+}
+
+/**
+ * @brief PropertyIndex::add
+ * @param propertyId
+ */
+void PropertyIndex::add( const Id &propertyId ) {
+    // ignore tags that have never been requested
+    const Id tagId = Property::instance()->tagId( propertyId );
+    if ( !this->postings.contains( tagId ))
+        return;
+
+    this->insert( propertyId,
+                  tagId,
+                  Property::instance()->reagentId( propertyId ),
+                  Property::instance()->propertyData( propertyId ).toString());
+}
+
+/**
+ * @brief PropertyIndex::remove
+ * @param propertyId
+ */
+void PropertyIndex::remove( const Id &propertyId ) {
+    if ( !this->entries.contains( propertyId ))
+        return;
+
+    const Entry entry( this->entries.take( propertyId ));
+    QMap<QString, QList<Id>> &values( this->postings[entry.tagId] );
+    QList<Id> &list( values[entry.value] );
+    list.removeOne( entry.reagentId );
+    if ( list.isEmpty())
+        values.remove( entry.value );
+}
+
+/**
+ * @brief PropertyIndex::change
+ * @param propertyId
+ * @param fieldId
+ */
+void PropertyIndex::change( const Id &propertyId, int fieldId ) {
+    if ( fieldId != Property::TagId && fieldId != Property::PropertyData && fieldId != Property::ReagentId )
+        return;
+
+    this->remove( propertyId );
+    this->add( propertyId );
+}
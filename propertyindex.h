@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QObject>
+#include <QMap>
+#include <QSet>
+#include "table.h"
+
+/**
+ * @brief The PropertyIndex class maintains per-tag value histograms and value->reagent posting lists
+ */
+class PropertyIndex final : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( PropertyIndex )
+
+public:
+    // disable move
+    PropertyIndex( PropertyIndex&& ) = delete;
+    PropertyIndex& operator=( PropertyIndex&& ) = delete;
+
+    /**
+     * @brief instance
+     * @return
+     */
+    static PropertyIndex *instance() {
+        static auto *instance( new PropertyIndex());
+        return instance;
+    }
+    ~PropertyIndex() override = default;
+
+    [[nodiscard]] QMap<QString, int> histogram( const Id &tagId );
+    [[nodiscard]] QSet<Id> reagents( const Id &tagId );
+    [[nodiscard]] QSet<Id> reagents( const Id &tagId, const QString &value );
+
+public slots:
+    void clear();
+
+private slots:
+    void add( const Id &propertyId );
+    void remove( const Id &propertyId );
+    void change( const Id &propertyId, int fieldId );
+
+private:
+    explicit PropertyIndex();
+    void build( const Id &tagId );
+    void insert( const Id &propertyId, const Id &tagId, const Id &reagentId, const QString &value );
+
+    /**
+     * @brief The Entry struct
+     */
+    struct Entry {
+        Id tagId;
+        Id reagentId;
+        QString value;
+    };
+
+    // indexed properties and their values
+    QHash<Id, Entry> entries;
+
+    // tagId -> value -> reagentIds (one entry per property, hence the list)
+    QHash<Id, QMap<QString, QList<Id>>> postings;
+};
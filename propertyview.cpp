@@ -55,7 +55,6 @@ PropertyView::PropertyView( QWidget *parent ) : QTableView( parent ) {
     this->resizeTimer.setSingleShot( true );
     QTimer::connect( &this->resizeTimer, &QTimer::timeout, this, [ this ]() {
         this->m_resizeInProgress = false;
-        this->setWidgetsEnabled( true );
         this->resizeToContents();
     } );
 }
@@ -76,27 +75,14 @@ PropertyView::~PropertyView() {
 void PropertyView::resizeEvent( QResizeEvent *event ) {
     this->resizeTimer.start( 200 );
     this->m_resizeInProgress = true;
-    this->setWidgetsEnabled( false );
     QTableView::resizeEvent( event );
 }
 
-/**
- * @brief PropertyView::setWidgetsEnabled
- * @param enabled
- */
-void PropertyView::setWidgetsEnabled( bool enabled ) {
-    for ( int y = 0; y < Property::instance()->count(); y++ ) {
-        QWidget *widget( this->indexWidget( Property::instance()->index( y, Property::PropertyData )));
-        if ( widget != nullptr )
-            widget->setUpdatesEnabled( enabled );
-    }
-}
-
 /**
  * @brief PropertyView::resizeToContents
  */
 void PropertyView::resizeToContents() {
-    this->clearDocumentCache();
+    // NOTE: cached documents are keyed by column width, so there is no need to clear them here
     for ( int y = 0; y < Property::instance()->count(); y++ ) {
         this->update( Property::instance()->index( y, Property::Name ));
         this->update( Property::instance()->index( y, Property::PropertyData ));
@@ -51,9 +51,6 @@ public:
 protected:
     void resizeEvent( QResizeEvent *event ) override;
 
-private slots:
-    void setWidgetsEnabled( bool enabled = true );
-
 public slots:
     void resizeToContents();
 
@@ -208,27 +208,7 @@ void PropertyWidget::add( const Id &id ) {
     if ( id == Id::Invalid )
         return;
 
-    switch ( Tag::instance()->type( this->tagId())) {
-        case Tag::PubChemId:
-        case Tag::Text:
-        case Tag::Integer:
-        case Tag::Real:
-        case Tag::CAS:
-            Property::instance()->add( QString(), this->tagId(), this->propertyValues[this->position()].first(), id );
-            break;
-
-        case Tag::NFPA:
-            Property::instance()->add( QString(), this->tagId(), this->propertyValues[this->position()].join( " " ),
-                                       id );
-            break;
-
-        case Tag::GHS:
-            Property::instance()->add( QString(), this->tagId(),
-                                       PropertyWidget::parseGHS( this->propertyValues[this->position()] ).join( " " ),
-                                       id );
-            break;
-
-        default:
-            return;
-    }
+    const QVariant data( PropertyExtractor::propertyData( this->tagId(), this->propertyValues[this->position()] ));
+    if ( data.isValid())
+        Property::instance()->add( QString(), this->tagId(), data, id );
 }
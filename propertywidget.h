@@ -28,6 +28,7 @@
 #include <QLabel>
 #include "nfpawidget.h"
 #include "ghswidget.h"
+#include "propertyextractor.h"
 
 /**
  * @brief The PropertyValueWidget class
@@ -64,31 +65,7 @@ public:
      * @param list
      * @return
      */
-    static QStringList parseGHS( const QStringList &list ) {
-        QStringList parms;
-        for ( const QString &parm : list ) {
-            if ( parm.contains( QRegularExpression( "[Ee]xplosive" )))
-                parms << "GHS01";
-            if ( parm.contains( QRegularExpression( "[Ff]lammable" )))
-                parms << "GHS02";
-            if ( parm.contains( QRegularExpression( "[Oo]xidizing" )))
-                parms << "GHS03";
-            if ( parm.contains( QRegularExpression( "[Cc]ompressed\\s[Gg]as" )))
-                parms << "GHS04";
-            if ( parm.contains( QRegularExpression( "[Cc]orrosive" )))
-                parms << "GHS05";
-            if ( parm.contains( QRegularExpression( "[Tt]oxic" )))
-                parms << "GHS06";
-            if ( parm.contains( QRegularExpression( "[Hh]armful" )) ||
-                 parm.contains( QRegularExpression( "[Ii]rritant" )))
-                parms << "GHS07";
-            if ( parm.contains( QRegularExpression( "[Hh]ealth\\s[Hh]azard" )))
-                parms << "GHS08";
-            if ( parm.contains( QRegularExpression( "[Ee]nvironmental\\s[Hh]azard" )))
-                parms << "GHS09";
-        }
-        return qAsConst( parms );
-    }
+    static QStringList parseGHS( const QStringList &list ) { return PropertyExtractor::parseGHS( list ); }
 
     /**
      * @brief pixmap
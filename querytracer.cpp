@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "querytracer.h"
+#include "variablehandle.h"
+#include "main.h"
+#include <QJsonArray>
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+
+/**
+ * @brief QueryTracer::QueryTracer
+ */
+QueryTracer::QueryTracer() : threshold( static_cast<qint64>( Variable::integer( "database/slowQueryThreshold" )) * 1000000 ) {
+    this->traces.reserve( QueryTracer::Capacity );
+
+    // add to garbage collector
+    GarbageMan::instance()->add( this );
+}
+
+/**
+ * @brief QueryTracer::exec executes and records a raw query
+ * @param query
+ * @param statement
+ * @param category
+ * @return
+ */
+bool QueryTracer::exec( QSqlQuery &query, const QString &statement, const char *category ) {
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool result = query.exec( statement );
+    const qint64 duration = timer.nsecsElapsed();
+    QueryTracer::instance()->record( statement, category, duration, QueryTracer::rowCount( query ));
+    return result;
+}
+
+/**
+ * @brief QueryTracer::exec executes and records a prepared query
+ * @param query
+ * @param category
+ * @return
+ */
+bool QueryTracer::exec( QSqlQuery &query, const char *category ) {
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool result = query.exec();
+    const qint64 duration = timer.nsecsElapsed();
+    QueryTracer::instance()->record( query.lastQuery(), category, duration, QueryTracer::rowCount( query ));
+    return result;
+}
+
+/**
+ * @brief QueryTracer::rowCount returns number of affected rows or, for scrollable selects, number of
+ * returned rows (the query is rewound afterwards)
+ * @param query
+ * @return -1 for failed and forward-only queries (these are counted through QueryTrace::next)
+ */
+int QueryTracer::rowCount( QSqlQuery &query ) {
+    if ( !query.isActive())
+        return -1;
+
+    if ( !query.isSelect())
+        return query.numRowsAffected();
+
+    if ( query.isForwardOnly())
+        return -1;
+
+    // NOTE: sqlite does not report size, rows are cached by the scrollable result anyway
+    const int rows = query.last() ? query.at() + 1 : 0;
+    query.seek( QSql::BeforeFirstRow );
+    return rows;
+}
+
+/**
+ * @brief QueryTracer::record
+ * @param statement
+ * @param category
+ * @param duration in nanoseconds
+ * @param rows returned or affected rows (-1 if not counted)
+ */
+void QueryTracer::record( const QString &statement, const char *category, qint64 duration, int rows ) {
+    const QString pattern( QueryTracer::normalize( statement ));
+
+    // NOTE: handle is bound to the GUI thread, queries run on the database thread use the last value read there
+    if ( QThread::currentThread() == this->thread())
+        this->threshold = static_cast<qint64>( Variable_::SlowQueryThreshold.value()) * 1000000;
+
+    if ( duration > this->threshold )
+        qCWarning( QueryTracer_::Slow ).noquote() << QueryTracer::tr( "slow query (%1 ms, %2): %3" ).arg( duration / 1.0e6, 0, 'f', 1 ).arg( category, pattern );
+
+    // NOTE: queries are also run on the database thread
+    QMutexLocker locker( &this->mutex );
+    const Trace trace { pattern, category, duration, rows };
+    if ( this->traces.count() < QueryTracer::Capacity ) {
+        this->traces << trace;
+    } else {
+        this->traces[this->head] = trace;
+        this->head = ( this->head + 1 ) % QueryTracer::Capacity;
+    }
+
+    Aggregate &aggregate( this->aggregates[pattern] );
+    if ( aggregate.samples.count() < QueryTracer::MaxSamples )
+        aggregate.samples << duration;
+    else
+        aggregate.samples[aggregate.count % QueryTracer::MaxSamples] = duration;
+
+    aggregate.count++;
+    aggregate.total += duration;
+}
+
+/**
+ * @brief QueryTracer::normalize replaces numeric and string literals with placeholders, so that
+ * statements built with QString::arg share the same template
+ * @param statement
+ * @return
+ */
+QString QueryTracer::normalize( const QString &statement ) {
+    QString pattern;
+    pattern.reserve( statement.length());
+
+    for ( int y = 0; y < statement.length(); y++ ) {
+        const QChar ch( statement.at( y ));
+
+        // string literals
+        if ( ch == '\'' ) {
+            for ( y++; y < statement.length(); y++ ) {
+                if ( statement.at( y ) == '\'' ) {
+                    // escaped quote
+                    if ( y + 1 < statement.length() && statement.at( y + 1 ) == '\'' ) {
+                        y++;
+                        continue;
+                    }
+                    break;
+                }
+            }
+            pattern.append( '?' );
+            continue;
+        }
+
+        // numbers that are not part of identifiers
+        const bool identifier = !pattern.isEmpty() && ( pattern.at( pattern.length() - 1 ).isLetterOrNumber() || pattern.at( pattern.length() - 1 ) == '_' );
+        if (( ch.isDigit() || ( ch == '-' && y + 1 < statement.length() && statement.at( y + 1 ).isDigit())) && !identifier ) {
+            for ( y++; y < statement.length() && ( statement.at( y ).isDigit() || statement.at( y ) == '.' ); y++ );
+            y--;
+            pattern.append( '?' );
+            continue;
+        }
+
+        pattern.append( ch );
+    }
+
+    return pattern.simplified();
+}
+
+/**
+ * @brief QueryTracer::percentile
+ * @param samples
+ * @param percent
+ * @return
+ */
+qint64 QueryTracer::percentile( QVector<qint64> samples, int percent ) {
+    if ( samples.isEmpty())
+        return 0;
+
+    const int index = qMin( samples.count() - 1, samples.count() * percent / 100 );
+    std::nth_element( samples.begin(), samples.begin() + index, samples.end());
+    return samples.at( index );
+}
+
+/**
+ * @brief QueryTracer::report returns per template aggregates sorted by total time
+ * @param limit
+ * @return
+ */
+QString QueryTracer::report( int limit ) const {
+    QMutexLocker locker( &this->mutex );
+
+    QList<QString> patterns( this->aggregates.keys());
+    std::sort( patterns.begin(), patterns.end(), [ this ]( const QString &left, const QString &right ) {
+        return this->aggregates[left].total > this->aggregates[right].total;
+    } );
+
+    int count = 0;
+    qint64 total = 0;
+    for ( const Aggregate &aggregate : this->aggregates ) {
+        count += aggregate.count;
+        total += aggregate.total;
+    }
+
+    QString report( QueryTracer::tr( "Queries: %1, total: %2 ms\n\n" ).arg( count ).arg( total / 1.0e6, 0, 'f', 1 ));
+    for ( const QString &pattern : patterns.mid( 0, limit )) {
+        const Aggregate &aggregate( this->aggregates[pattern] );
+        report.append( QString( "%1x, %2 ms, p50 %3 ms, p95 %4 ms, p99 %5 ms\n%6\n\n" )
+                       .arg( aggregate.count )
+                       .arg( aggregate.total / 1.0e6, 0, 'f', 1 )
+                       .arg( QueryTracer::percentile( aggregate.samples, 50 ) / 1.0e6, 0, 'f', 2 )
+                       .arg( QueryTracer::percentile( aggregate.samples, 95 ) / 1.0e6, 0, 'f', 2 )
+                       .arg( QueryTracer::percentile( aggregate.samples, 99 ) / 1.0e6, 0, 'f', 2 )
+                       .arg( pattern ));
+    }
+
+    return report;
+}
+
+/**
+ * @brief QueryTracer::toJson returns aggregates and recent traces (oldest first) for offline analysis
+ * @return
+ */
+QJsonObject QueryTracer::toJson() const {
+    QMutexLocker locker( &this->mutex );
+
+    QJsonArray aggregates;
+    for ( auto it = this->aggregates.constBegin(); it != this->aggregates.constEnd(); ++it ) {
+        QJsonObject object;
+        object["statement"] = it.key();
+        object["count"] = it.value().count;
+        object["totalMs"] = it.value().total / 1.0e6;
+        object["p50Ms"] = QueryTracer::percentile( it.value().samples, 50 ) / 1.0e6;
+        object["p95Ms"] = QueryTracer::percentile( it.value().samples, 95 ) / 1.0e6;
+        object["p99Ms"] = QueryTracer::percentile( it.value().samples, 99 ) / 1.0e6;
+        aggregates << object;
+    }
+
+    QJsonArray traces;
+    for ( int y = 0; y < this->traces.count(); y++ ) {
+        const Trace &trace( this->traces.at(( this->head + y ) % this->traces.count()));
+        QJsonObject object;
+        object["statement"] = trace.statement;
+        object["category"] = QString( trace.category );
+        object["durationMs"] = trace.duration / 1.0e6;
+        object["rows"] = trace.rows;
+        traces << object;
+    }
+
+    QJsonObject object;
+    object["aggregates"] = aggregates;
+    object["traces"] = traces;
+    return object;
+}
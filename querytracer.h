@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QMutex>
+#include <QObject>
+#include <QSqlQuery>
+#include <QVector>
+#include <atomic>
+#include <utility>
+
+/**
+ * @brief The QueryTracer_ namespace
+ */
+namespace QueryTracer_ {
+    const static QLoggingCategory Slow( "database.slow" );
+}
+
+/**
+ * @brief The QueryTracer class records duration of executed queries in a ring buffer and per statement template
+ */
+class QueryTracer final : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( QueryTracer )
+
+public:
+    /**
+     * @brief The Trace struct
+     */
+    struct Trace {
+        QString statement;
+        const char *category;
+        qint64 duration;
+        int rows;
+    };
+
+    /**
+     * @brief The Aggregate struct
+     */
+    struct Aggregate {
+        int count = 0;
+        qint64 total = 0;
+        QVector<qint64> samples;
+    };
+
+    // disable move
+    QueryTracer( QueryTracer&& ) = delete;
+    QueryTracer& operator=( QueryTracer&& ) = delete;
+
+    /**
+     * @brief instance
+     * @return
+     */
+    static QueryTracer *instance() {
+        static auto *instance( new QueryTracer());
+        return instance;
+    }
+    ~QueryTracer() override = default;
+
+    static bool exec( QSqlQuery &query, const QString &statement, const char *category );
+    static bool exec( QSqlQuery &query, const char *category );
+    void record( const QString &statement, const char *category, qint64 duration, int rows = -1 );
+    [[nodiscard]] static QString normalize( const QString &statement );
+    [[nodiscard]] QString report( int limit = 20 ) const;
+    [[nodiscard]] QJsonObject toJson() const;
+    static constexpr int Capacity = 4096;
+    static constexpr int MaxSamples = 1024;
+
+private:
+    explicit QueryTracer();
+    [[nodiscard]] static qint64 percentile( QVector<qint64> samples, int percent );
+    [[nodiscard]] static int rowCount( QSqlQuery &query );
+    mutable QMutex mutex;
+    QVector<Trace> traces;
+    int head = 0;
+    QHash<QString, Aggregate> aggregates;
+    std::atomic<qint64> threshold;
+};
+
+/**
+ * @brief The QueryTrace class times a query for its lifetime (use for forward-only queries, whose rows are only counted while iterating)
+ */
+class QueryTrace final {
+    Q_DISABLE_COPY( QueryTrace )
+
+public:
+    /**
+     * @brief QueryTrace
+     * @param statement
+     * @param category
+     */
+    explicit QueryTrace( QString statement, const char *category ) : statement( std::move( statement )), category( category ) { this->timer.start(); }
+
+    // disable move
+    QueryTrace( QueryTrace&& ) = delete;
+    QueryTrace& operator=( QueryTrace&& ) = delete;
+
+    /**
+     * @brief ~QueryTrace
+     */
+    ~QueryTrace() { QueryTracer::instance()->record( this->statement, this->category, this->timer.nsecsElapsed(), this->rows ); }
+
+    /**
+     * @brief setRows
+     * @param rows
+     */
+    void setRows( int rows ) { this->rows = rows; }
+
+    /**
+     * @brief next advances the query and counts returned rows
+     * @param query
+     * @return
+     */
+    bool next( QSqlQuery &query ) {
+        this->rows = qMax( this->rows, 0 );
+        if ( !query.next())
+            return false;
+
+        this->rows++;
+        return true;
+    }
+
+private:
+    QString statement;
+    const char *category;
+    QElapsedTimer timer;
+    int rows = -1;
+};
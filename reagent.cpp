@@ -23,8 +23,11 @@
 #include "field.h"
 #include "database.h"
 #include "labelset.h"
-#include "nodehistory.h"
+#include "property.h"
+#include "querytracer.h"
+#include "searchindex.h"
 #include <QSqlQuery>
+#include <algorithm>
 
 /**
  * @brief Reagent::Reagent
@@ -35,6 +38,9 @@ Reagent::Reagent() : Table( "reagent" ) {
     this->addField( FIELD( Reference, QString ) );
     this->addField( FIELD( ParentId, Int ));
     this->addField( FIELD( DateTime, Int ));
+
+    // batches are removed along with their parent (top level reagents have parentId -1)
+    this->addForeignKey( this->field( ParentId ), this, true );
 }
 
 /**
@@ -58,11 +64,11 @@ QList<Row> Reagent::children( const Row &row ) const {
 
     const Id id = this->id( row );
     QSqlQuery query;
-    query.exec( QString( "select %1 from %2 where %3=%4" )
+    QueryTracer::exec( query, QString( "select %1 from %2 where %3=%4" )
                         .arg( Reagent::instance()->fieldName( ID ),
                               Reagent::instance()->tableName(),
                               Reagent::instance()->fieldName( ParentId ),
-                              QString::number( static_cast<int>( id ))));
+                              QString::number( static_cast<int>( id ))), "reagent" );
     while ( query.next()) {
         list << this->row( query.value( 0 ).value<Id>());
     }
@@ -83,17 +89,12 @@ QList<Id> Reagent::labelIds( const Row &row ) const {
     if ( parentId != Id::Invalid )
         reagentId = parentId;
 
-    QSqlQuery query;
-    query.exec( QString( "select %1 from %2 where %3=%4" )
-                        .arg( LabelSet::instance()->fieldName( LabelSet::LabelId ),
-                              LabelSet::instance()->tableName(),
-                              LabelSet::instance()->fieldName( LabelSet::ReagentId ),
-                              QString::number( static_cast<int>( qAsConst( reagentId )))));
-    while ( query.next()) {
-        const auto id = query.value( 0 ).value<Id>();
+    // NOTE: uses in-memory reagent->label index instead of querying each reagent
+    const QSet<Id> labelIds( LabelSet::instance()->labels( reagentId ));
+    for ( const Id &id : labelIds )
         list << id;
-    }
 
+    std::sort( list.begin(), list.end());
     return list;
 }
 
@@ -101,16 +102,41 @@ QList<Id> Reagent::labelIds( const Row &row ) const {
  * @brief Reagent::removeOrphanedEntries
  */
 void Reagent::removeOrphanedEntries() {
-    // NOTE: labels do not have foreign ids, therefore they cannot be orphaned
-    //       batch deletion is handled elsewhere, so that there should not be
-    //       any orphaned batches
+    // NOTE: batches are removed by sqlite along with their parents, so there
+    //       should not be any orphaned batches
 }
 
 /**
- * @brief Reagent::remove
- * @param row
+ * @brief Reagent::remove removes reagents along with their batches, properties and labels in a single transaction
+ * @param ids
  */
-void Reagent::remove( const Row &row ) {
-    NodeHistory::instance()->removeFromHistory( this->id( row ));
-    Table::remove( row );
+void Reagent::remove( const QList<Id> &ids ) {
+    if ( ids.isEmpty())
+        return;
+
+    // collect batches, so that listeners (indexes, history) are notified about them as well
+    QStringList list;
+    for ( const Id &id : ids )
+        list << QString::number( static_cast<int>( id ));
+
+    QList<Id> batchIds;
+    QSqlQuery query;
+    QueryTracer::exec( query, QString( "select %1 from %2 where %3 in ( %4 )" )
+                       .arg( this->fieldName( ID ),
+                             this->tableName(),
+                             this->fieldName( ParentId ),
+                             list.join( ", " )), "reagent" );
+    while ( query.next()) {
+        const Id batchId = query.value( 0 ).value<Id>();
+        if ( !ids.contains( batchId ))
+            batchIds << batchId;
+    }
+
+    Transaction transaction;
+    SearchIndex::instance()->removeReagents( batchIds + ids );
+    Table::remove( batchIds + ids );
+
+    // refresh in-memory indexes of cascaded tables
+    Property::instance()->removeOrphanedEntries();
+    LabelSet::instance()->removeOrphanedEntries();
 }
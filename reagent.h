@@ -93,9 +93,12 @@ public:
         return QDateTime::fromSecsSinceEpoch( this->value( id, DateTime ).toInt());
     }
 
+    // single rows are removed by Table (history is updated through entryAboutToBeRemoved)
+    using Table::remove;
+
 public slots:
     void removeOrphanedEntries() override;
-    void remove( const Row &row ) override;
+    void remove( const QList<Id> &ids );
 
     /**
      * @brief setDateTime
@@ -26,6 +26,7 @@
 #include <QApplication>
 #include <QDebug>
 #include <QDate>
+#include <QTextOption>
 
 /**
  * @brief ReagentDelegate::paint
@@ -38,13 +39,6 @@ void ReagentDelegate::paint( QPainter *painter, const QStyleOptionViewItem &opti
     if (( this->model() == nullptr && !this->viewMode()) || !index.isValid())
         return QStyledItemDelegate::paint( painter, option, index );
 
-    // abort if resizing
-    if ( !this->viewMode()) {
-        const ReagentView *view( qobject_cast<ReagentView *>( this->parentView()));
-        if ( view->isResizeInProgress())
-            return;
-    }
-
     // draw custom selection highlight
     if ( option.state & QStyle::State_Selected ) {
         QColor highlight( QApplication::palette().highlight().color());
@@ -52,9 +46,9 @@ void ReagentDelegate::paint( QPainter *painter, const QStyleOptionViewItem &opti
         painter->fillRect( option.rect, QBrush( qAsConst( highlight )));
     }
 
-    // get the document
-    QTextDocument *document( this->cache[index] );
-    if ( document == nullptr )
+    // get the layout
+    const Layout *layout( this->layout( index ));
+    if ( layout == nullptr )
         return;
 
     // save painter state (we do transformations)
@@ -75,12 +69,16 @@ void ReagentDelegate::paint( QPainter *painter, const QStyleOptionViewItem &opti
     }
 
     // adjust position
-    //i//f ( document->defaultTextOption().alignment() == Qt::AlignRight )
-    //    x += 8;
-    painter->translate( x, option.rect.top() + static_cast<int>( option.rect.height() / 2 ) - document->size().height() / 2 );
-
-    // draw the actual html
-    document->drawContents( painter );
+    painter->translate( x, option.rect.top() + static_cast<int>( option.rect.height() / 2 ) - layout->size.height() / 2 );
+
+    // draw either plain text or the actual html
+    if ( layout->document.isNull()) {
+        painter->setFont( layout->font );
+        painter->setPen( QApplication::palette().text().color());
+        painter->drawStaticText( ReagentDelegate::Margin, ReagentDelegate::Margin, layout->text );
+    } else {
+        layout->document->drawContents( painter );
+    }
 
     // restore state
     painter->restore();
@@ -95,73 +93,138 @@ void ReagentDelegate::paint( QPainter *painter, const QStyleOptionViewItem &opti
 QSize ReagentDelegate::sizeHint( const QStyleOptionViewItem &option, const QModelIndex &index ) const {
     const QSize defaultSize( QStyledItemDelegate::sizeHint( option, index ));
 
+    const Layout *layout( this->layout( index ));
+    if ( layout == nullptr )
+        return defaultSize;
+
+    if ( this->viewMode())
+        return layout->size.toSize();
+
+    // return adjusted layout size
+    const auto pixmap( this->sourceModel()->data( this->model()->mapToSource( index ), ReagentModel::Pixmap ).value<QPixmap>());
+    return QSizeF( layout->size.width() + ( pixmap.isNull() ? 0 : pixmap.width()),
+                   layout->size.height()).toSize();
+}
+
+/**
+ * @brief ReagentDelegate::layout returns a cached layout keyed by reagent id, html revision (of the parent as well), width and font
+ * @param index
+ * @return
+ */
+ReagentDelegate::Layout *ReagentDelegate::layout( const QModelIndex &index ) const {
+    if ( !index.isValid())
+        return nullptr;
+
     // viewMode fetches html directtly from the reagent
     if ( this->viewMode()) {
-        //if ( !index.isValid() || index.data( Qt::DisplayRole ).isNull())
-        //    return defaultSize;
-
-        const QSortFilterProxyModel *proxyModel( qobject_cast<const QSortFilterProxyModel*>( index.model()));
-        const QSqlQueryModel *sourceModel( qobject_cast<const QSqlQueryModel*>( proxyModel->sourceModel()));
-        if ( !index.isValid() || sourceModel->data( proxyModel->mapToSource( index ), Qt::DisplayRole ).isNull())
-            return defaultSize;
+        if ( index.data( Qt::DisplayRole ).isNull())
+            return nullptr;
 
         // get reagent id
-        //const Id id = index.data( Qt::DisplayRole ).value<Id>();
-        const Id id = sourceModel->data( proxyModel->mapToSource( index ), Qt::DisplayRole ).value<Id>();
+        const Id id = index.data( Qt::DisplayRole ).value<Id>();
         if ( id == Id::Invalid )
-            return defaultSize;
-
-        // get reagent parentId
-        const Id parentId = Reagent::instance()->parentId( id );
+            return nullptr;
+
+        // batch names include the name of their parent, so its revision is a part of the key as well
+        const Row row = Reagent::instance()->row( id );
+        const Id parentId = row != Row::Invalid ? Reagent::instance()->parentId( row ) : Reagent::instance()->parentId( id );
+        const QString key( QString( "%1/%2/%3/%4" ).arg( static_cast<int>( id ))
+                           .arg( Reagent::instance()->revision( id ))
+                           .arg( Reagent::instance()->revision( parentId ))
+                           .arg( this->internalFont.key()));
+        Layout *layout( this->cache.object( key ));
+        if ( layout != nullptr )
+            return layout;
+
+        // batches are indented and italic
+        QFont font( this->internalFont );
+        font.setItalic( parentId != Id::Invalid );
+
+        layout = this->setupLayout( parentId != Id::Invalid ?
+                                        QString( 4, QChar::Nbsp ) + Reagent::instance()->name( id ) + QString( " (%1)" ).arg( Reagent::instance()->name( parentId ))
+                                      :
+                                        Reagent::instance()->name( id ), font, 0 );
+
+        // NOTE: cache takes ownership of the layout
+        this->cache.insert( key, layout );
+        return layout;
+    }
 
-        // setup html document and save to cache
-        QTextDocument *document( new QTextDocument());
-        document->setHtml( QString( parentId != Id::Invalid ? "&nbsp;&nbsp;&nbsp;&nbsp;" : "" ) + Reagent::instance()->name( id ) + ( parentId == Id::Invalid ? "" : QString( " (%1)" ).arg( Reagent::instance()->name( parentId ))));
+    if ( this->model() == nullptr || this->parentView() == nullptr )
+        return nullptr;
 
-        if ( parentId != Id::Invalid ) {
-            QFont font( this->internalFont );
-            font.setItalic( true );
-            document->setDefaultFont( font );
-        } else {
-            document->setDefaultFont( this->internalFont );
-        }
+    // otherwise html is fetched through model
+    const QModelIndex sourceIndex( this->model()->mapToSource( index ));
+    const QString html( this->sourceModel()->data( sourceIndex, ReagentModel::HTML ).toString());
+    const auto pixmap( this->sourceModel()->data( sourceIndex, ReagentModel::Pixmap ).value<QPixmap>());
+    const qint64 dateKey = this->sourceModel()->data( sourceIndex, ReagentModel::DateKey ).toLongLong();
+    int width = this->parentView()->columnWidth( 0 ) - this->parentView()->indentation() - ( pixmap.isNull() ? 0 : pixmap.width());
+    width -= width % ReagentDelegate::WidthBucket;
+
+    const QString key( QString( "%1/%2/%3/%4/%5" ).arg( this->sourceModel()->data( sourceIndex, ReagentModel::ID ).toInt())
+                       .arg( qHash( html ))
+                       .arg( dateKey )
+                       .arg( width )
+                       .arg( this->internalFont.key()));
+    Layout *layout( this->cache.object( key ));
+    if ( layout != nullptr )
+        return layout;
+
+    const QDate date( this->sourceModel()->data( sourceIndex, ReagentModel::DateTime ).toDate());
+    const QString dateString( date.isValid() ? QString( " (%1)" ).arg( date.toString( QLocale::system().dateFormat( QLocale::ShortFormat ))) : "" );
+    layout = this->setupLayout( html + dateString, this->internalFont, qMax( width, ReagentDelegate::WidthBucket ));
 
-        this->cache[index] = document;
+    // NOTE: cache takes ownership of the layout
+    this->cache.insert( key, layout );
+    return layout;
+}
 
-        // return document size
-        return document->size().toSize();
+/**
+ * @brief ReagentDelegate::setupLayout lays out plain text without QTextDocument, html otherwise
+ * @param html
+ * @param font
+ * @param width wrap width (no wrapping if zero)
+ * @return
+ */
+ReagentDelegate::Layout *ReagentDelegate::setupLayout( const QString &html, const QFont &font, int width ) const {
+    auto *layout( new Layout());
+    layout->font = font;
+
+    QTextOption textOption;
+    textOption.setWrapMode( width > 0 ? QTextOption::WordWrap : QTextOption::NoWrap );
+
+    // fast path for plain names
+    if ( ReagentDelegate::isPlainText( html )) {
+        layout->text.setText( html );
+        layout->text.setTextFormat( Qt::PlainText );
+        layout->text.setTextOption( textOption );
+        if ( width > 0 )
+            layout->text.setTextWidth( width - ReagentDelegate::Margin * 2 );
+
+        layout->text.prepare( QTransform(), font );
+        layout->size = layout->text.size() + QSizeF( ReagentDelegate::Margin * 2, ReagentDelegate::Margin * 2 );
+        return layout;
     }
 
-    // abort on invalid indexes
-    if ( this->model() == nullptr || !index.isValid() || this->parentView() == nullptr )
-        return defaultSize;
+    // setup html document
+    layout->document.reset( new QTextDocument());
+    layout->document->setDefaultFont( font );
+    layout->document->setDefaultTextOption( textOption );
+    if ( width > 0 )
+        layout->document->setTextWidth( width );
 
-    const ReagentView *view( qobject_cast<ReagentView *>( this->parentView()));
-    if ( view->isResizeInProgress())
-        return QSize();
+    layout->document->setHtml( html );
+    layout->size = QSizeF( width > 0 ? layout->document->idealWidth() : layout->document->size().width(),
+                           layout->document->size().height());
 
-    // otherwise html is fetched through model
-    const QFont font( this->internalFont );
-    QDate date( this->sourceModel()->data( this->model()->mapToSource( index ), ReagentModel::DateTime ).toDate());
-    const QString dateString( date.isValid() ? QString( " (%1)" ).arg( date.toString( QLocale::system().dateFormat( QLocale::ShortFormat ))) : "" );
-    const QString html( this->sourceModel()->data( this->model()->mapToSource( index ), ReagentModel::HTML ).toString());
+    return layout;
+}
 
-    // setup html document
-    auto *document( new QTextDocument());
-    const auto pixmap( this->sourceModel()->data( this->model()->mapToSource( index ), ReagentModel::Pixmap ).value<QPixmap>());
-    QTextOption textOption( document->defaultTextOption());
-    textOption.setWrapMode( QTextOption::WordWrap );
-    document->setDefaultTextOption( textOption );
-    document->setTextWidth( this->parentView()->columnWidth( 0 ) - this->parentView()->indentation() - ( pixmap.isNull() ? 0 : pixmap.width()));
-    document->setHtml( QString( R"(<p style="font-size: %1pt; font-family: '%2'">%3</p>)" )
-                       .arg( QString::number( font.pointSize()),
-                             font.family(),
-                             html + dateString ));
-
-    // save to cache
-    this->cache[index] = document;
-
-    // return adjusted document size
-    return QSizeF( document->idealWidth() + ( pixmap.isNull() ? 0 : pixmap.width()),
-                   document->size().height()).toSize();
+/**
+ * @brief ReagentDelegate::isPlainText returns true if html has neither tags nor entities
+ * @param html
+ * @return
+ */
+bool ReagentDelegate::isPlainText( const QString &html ) {
+    return !html.contains( '<' ) && !html.contains( '&' );
 }
@@ -22,9 +22,11 @@
  * includes
  */
 #include "reagentmodel.h"
+#include <QCache>
 #include <QListWidget>
 #include <QSortFilterProxyModel>
 #include <QStandardItem>
+#include <QStaticText>
 #include <QStyledItemDelegate>
 #include <QTextDocument>
 #include <QTreeView>
@@ -40,6 +42,9 @@ public:
     explicit ReagentDelegate( QObject *parent = nullptr ) : QStyledItemDelegate( parent ) {
         const QListWidget w;
         this->internalFont = QFont( QApplication::font( &w ));
+
+        // layouts are keyed by content and width, so they survive sorting and filtering
+        this->cache.setMaxCost( 4096 );
     }
 
     /**
@@ -76,13 +81,7 @@ public slots:
     /**
      * @brief clearCache
      */
-    void clearCache() {
-        if ( this->cache.isEmpty())
-            return;
-
-        qDeleteAll( this->cache );
-        this->cache.clear();
-    }
+    void clearCache() { this->cache.clear(); }
 
     /**
      * @brief setParentView
@@ -103,8 +102,28 @@ protected:
     [[nodiscard]] QSize sizeHint( const QStyleOptionViewItem &option, const QModelIndex &index ) const override;
 
 private:
+    /**
+     * @brief The Layout struct holds either prepared plain text or a html document
+     */
+    struct Layout {
+        QStaticText text;
+        QScopedPointer<QTextDocument> document;
+        QFont font;
+        QSizeF size;
+    };
+
+    [[nodiscard]] Layout *layout( const QModelIndex &index ) const;
+    [[nodiscard]] Layout *setupLayout( const QString &html, const QFont &font, int width ) const;
+    [[nodiscard]] static bool isPlainText( const QString &html );
+
+    // width is rounded down to buckets, so that resizing reuses layouts
+    static constexpr int WidthBucket = 16;
+
+    // matches default QTextDocument margin, so that both layouts are of the same size
+    static constexpr int Margin = 4;
+
     QSortFilterProxyModel *m_model = nullptr;
-    mutable QMap<QModelIndex, QTextDocument *> cache;
+    mutable QCache<QString, Layout> cache;
     QTreeView *m_view = nullptr;
     bool m_viewMode = false;
     QFont internalFont;
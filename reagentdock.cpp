@@ -26,6 +26,7 @@
 #include <QClipboard>
 #include <QMoveEvent>
 #include <QSqlQuery>
+#include "querytracer.h"
 #include <QMessageBox>
 #include <QTextEdit>
 #include <QPainter>
@@ -43,7 +44,10 @@
 #include "htmlutils.h"
 #include "textutils.h"
 #include "searchengine.h"
+#include "searchindex.h"
+#include "changelog.h"
 #include "datepicker.h"
+#include "database.h"
 
 /**
  * @brief ReagentDock::ReagentDock
@@ -64,8 +68,35 @@ ReagentDock::ReagentDock( QWidget *parent ) : DockWidget( parent ), ui( new Ui::
     // hide searchBox
     this->ui->searchEdit->hide();
 
+    // full-text search mode (matches references and property values as well)
+    this->searchModeAction = new QAction( QIcon::fromTheme( "property" ), ReagentDock::tr( "Search properties" ), this );
+    this->searchModeAction->setCheckable( true );
+    this->searchModeAction->setToolTip( ReagentDock::tr( "Search reagent names, references and property values" ));
+    this->searchModeAction->setVisible( SearchIndex::instance()->isAvailable());
+    this->ui->searchEdit->addAction( this->searchModeAction, QLineEdit::TrailingPosition );
+
     // implement search
-    QLineEdit::connect( this->ui->searchEdit, &QLineEdit::textChanged, [ this ]( const QString &filter ) {
+    auto search = [ this ]( const QString &filter ) {
+        if ( this->searchModeAction->isChecked()) {
+            this->view()->filterModel()->setFilterFixedString( QString());
+
+            if ( filter.isEmpty()) {
+                this->searchResults.clear();
+                this->view()->filterModel()->clearSearchFilter();
+                return;
+            }
+
+            // results are ranked, so select the best match
+            this->searchResults = SearchIndex::instance()->search( filter );
+            this->view()->filterModel()->setSearchFilter( this->searchResults );
+            this->view()->expandAll();
+            if ( !this->searchResults.isEmpty())
+                this->selectSearchResult( this->searchResults.first());
+
+            return;
+        }
+
+        this->view()->filterModel()->clearSearchFilter();
         this->view()->filterModel()->setFilterFixedString( filter );
 
         if ( !filter.isEmpty())
@@ -82,7 +113,9 @@ ReagentDock::ReagentDock( QWidget *parent ) : DockWidget( parent ), ui( new Ui::
             this->view()->scrollTo( nextIndex );
             return;
         }
-    } );
+    };
+    QLineEdit::connect( this->ui->searchEdit, &QLineEdit::textChanged, search );
+    QAction::connect( this->searchModeAction, &QAction::toggled, [ this, search ]() { search( this->ui->searchEdit->text()); } );
 
     // implement going through found entries
     QLineEdit::connect( this->ui->searchEdit, &QLineEdit::returnPressed, [ this ]() {
@@ -94,6 +127,22 @@ ReagentDock::ReagentDock( QWidget *parent ) : DockWidget( parent ), ui( new Ui::
             return;
         }
 
+        // go through full-text search results in the order of relevance
+        if ( this->searchModeAction->isChecked()) {
+            if ( this->searchResults.count() < 2 ) {
+                if ( this->searchResults.count() == 1 )
+                    this->on_buttonFind_clicked();
+
+                return;
+            }
+
+            const QModelIndexList selectedIndexes( this->view()->selectionModel()->selectedIndexes());
+            const int previous = selectedIndexes.isEmpty() ? -1 :
+                                                             this->searchResults.indexOf( this->view()->idFromIndex( this->view()->filterModel()->mapToSource( selectedIndexes.first())));
+            this->selectSearchResult( this->searchResults.at(( previous + 1 ) % this->searchResults.count()));
+            return;
+        }
+
         // previous selection is unavailable
         const QModelIndexList selectedIndexes( this->view()->selectionModel()->selectedIndexes());
         const QModelIndex &previousIndex( selectedIndexes.isEmpty() ? QModelIndex() : selectedIndexes.first());
@@ -117,6 +166,21 @@ ReagentDock::ReagentDock( QWidget *parent ) : DockWidget( parent ), ui( new Ui::
         this->view()->scrollTo( nextIndex );
     } );
 
+    // apply reagents changed by other instances (shared database mode only)
+    ReagentModel *model( this->view()->sourceModel());
+    ChangeLog::connect( ChangeLog::instance(), &ChangeLog::reagentAdded, model, &ReagentModel::add );
+    ChangeLog::connect( ChangeLog::instance(), &ChangeLog::reagentRemoved, model, [ model ]( const Id &id ) { model->remove( model->indexFromId( id )); } );
+    ChangeLog::connect( ChangeLog::instance(), &ChangeLog::reagentsReset, model, &ReagentModel::setupModelData );
+    ChangeLog::connect( ChangeLog::instance(), &ChangeLog::reagentChanged, model, [ model ]( const Id &id, int fieldId ) {
+        // batches are moved by re-adding
+        if ( fieldId == Reagent::ParentId ) {
+            model->remove( model->indexFromId( id ));
+            model->add( id );
+        } else {
+            model->update( id );
+        }
+    } );
+
     // add keyboard shortcut to reagent filter
     this->shortcut = new QShortcut( QKeySequence( ReagentDock::tr( "Ctrl+F", "Find" )), this );
     QShortcut::connect( this->shortcut, &QShortcut::activated, [ this ]() {
@@ -151,28 +215,31 @@ bool ReagentDock::checkForDuplicates( const QString &name, const QString &refere
     //
 
     QSqlQuery query;
+    bool ok;
     if ( reagentId == Id::Invalid ) {
         // reagent does not exist yet
-        query.exec( QString( "select %1, %2 from %3 where %4=%5" )
+        ok = QueryTracer::exec( query, QString( "select %1, %2 from %3 where %4=%5" )
                             .arg( Reagent::instance()->fieldName( Reagent::Name ),
                                   Reagent::instance()->fieldName( Reagent::Reference ),
                                   Reagent::instance()->tableName(),
                                   Reagent::instance()->fieldName( Reagent::ParentId ),
-                                  QString::number( static_cast<int>( Id::Invalid )))
-        );
+                                  QString::number( static_cast<int>( Id::Invalid ))), "reagentDock" );
     } else {
         // reagent does exist, we're just renaming it
-        query.exec( QString( "select %1, %2, %6 from %3 where %4=%5 and %6!=%7" )
+        ok = QueryTracer::exec( query, QString( "select %1, %2, %6 from %3 where %4=%5 and %6!=%7" )
                             .arg( Reagent::instance()->fieldName( Reagent::Name ),
                                   Reagent::instance()->fieldName( Reagent::Reference ),
                                   Reagent::instance()->tableName(),
                                   Reagent::instance()->fieldName( Reagent::ParentId ),
                                   QString::number( static_cast<int>( Id::Invalid )),
                                   Reagent::instance()->fieldName( Reagent::ID ),
-                                  QString::number( static_cast<int>( reagentId )))
-        );
+                                  QString::number( static_cast<int>( reagentId ))), "reagentDock" );
     }
 
+    // NOTE: duplicates cannot be ruled out if existing names cannot be read
+    if ( !ok )
+        return false;
+
     // check plainText names
     while ( query.next()) {
         const QString name_( HTMLUtils::toPlainText( query.value( 0 ).toString()));
@@ -199,13 +266,13 @@ bool ReagentDock::checkForDuplicates( const QString &name, const QString &refere
  */
 bool ReagentDock::checkBatchForDuplicates( const QString &name, const Id parentId ) const {
     QSqlQuery query;
-    query.exec( QString( "select %4 from %1 where %2=%3 and %4='%5'" )
+    if ( !QueryTracer::exec( query, QString( "select %4 from %1 where %2=%3 and %4='%5'" )
                         .arg( Reagent::instance()->tableName(),
                               Reagent::instance()->fieldName( Reagent::ParentId ),
                               QString::number( static_cast<int>( parentId )),
                               Reagent::instance()->fieldName( Reagent::Name ),
-                              name )
-    );
+                              name ), "reagentDock" ))
+        return false;
 
     if ( query.next()) {
         QMessageBox::warning( ReagentDock::instance(), ReagentDock::tr( "Cannot add or rename batch" ),
@@ -306,35 +373,22 @@ QMenu *ReagentDock::buildMenu( bool context ) {
             if ( parentId == Id::Invalid ) {
                 QMenu *labels( menu->addMenu( ReagentDock::tr( "Labels" )));
                 labels->setIcon( QIcon::fromTheme( "label" ));
+                const auto reagentId = item->data( ReagentModel::ID ).value<Id>();
+                const QList<Id> labelIds( Reagent::instance()->labelIds( Reagent::instance()->row( reagentId )));
                 for ( int y = 0; y < Label::instance()->count(); y++ ) {
                     const auto row = static_cast<Row>( y );
                     const Id menuLabelId = Label::instance()->id( row );
-                    const auto reagentId = item->data( ReagentModel::ID ).value<Id>();
-
-                    const QList<Id> labelIds( Reagent::instance()->labelIds( Reagent::instance()->row( reagentId )));
-                    bool hasLabel = false;
-                    for ( const Id &labelId : labelIds ) {
-                        if ( labelId == menuLabelId ) {
-                            hasLabel = true;
-                            break;
-                        }
-                    }
+                    const bool hasLabel = labelIds.contains( menuLabelId );
 
                     QAction *action(
                             labels->addAction( QIcon( Label::instance()->pixmap( Label::instance()->colour( row ))),
                                                QApplication::translate( "Label", Label::instance()->name( row ).toUtf8().constData(), nullptr ),
-                                               [ item, menuLabelId, reagentId, hasLabel ]() {
-                                                   if ( hasLabel ) {
+                                               [ menuLabelId, reagentId, hasLabel ]() {
+                                                   // NOTE: label strip is updated by the model
+                                                   if ( hasLabel )
                                                        LabelSet::instance()->remove( menuLabelId, reagentId );
-                                                       LabelSet::instance()->removeOrphanedEntries();
-                                                   } else
+                                                   else
                                                        LabelSet::instance()->add( menuLabelId, reagentId );
-
-                                                   // force icon reset without resetting the model
-                                                   //const_cast<QStandardItem*>( item )->setIcon( QIcon());
-                                                   // force pixmap reset without resetting the model
-                                                   const_cast<QStandardItem *>( item )->setData( QPixmap(),
-                                                                                                 ReagentModel::Pixmap );
                                                } ));
                     action->setCheckable( true );
                     if ( hasLabel )
@@ -438,14 +492,7 @@ Id ReagentDock::addReagent( const Id &parentId, const QString &reagentName, cons
 
     if ( ok ) {
         if ( !name.isEmpty()) {
-            // save filter
-            // NOTE: why? because when we add a reagent when filtered the row will always be invalid
-            //       due to non-existent label sets
-            //       this way filter is temporarily removed and restore after addition
-            const QString oldFilter( Reagent::instance()->filter());
-            if ( !Reagent::instance()->filter().isEmpty())
-                Reagent::instance()->setFilter( "" );
-
+            // NOTE: label filtering is done by the proxy model, so the reagent table is never filtered
             const Row row = Reagent::instance()->add( qAsConst( name ), qAsConst( reference ), parentId );
             if ( row == Row::Invalid )
                 return Id::Invalid;
@@ -455,6 +502,7 @@ Id ReagentDock::addReagent( const Id &parentId, const QString &reagentName, cons
 
             // add labels if any
             //qDebug() << "got labels" << labels;
+            Transaction transaction;
             for ( const Id &id : qAsConst( labels )) {
                 if ( id == Id::Invalid )
                     continue;
@@ -481,12 +529,6 @@ Id ReagentDock::addReagent( const Id &parentId, const QString &reagentName, cons
                 PropertyDock::instance()->updateView();
             }
 
-            // restore filter
-            if ( !oldFilter.isEmpty()) {
-                Reagent::instance()->setFilter( oldFilter );
-                this->view()->updateView();
-            }
-
             return reagentId;
         } else {
             QMessageBox::warning( this, ReagentDock::tr( "Cannot add reagent" ),
@@ -519,41 +561,6 @@ void ReagentDock::on_addButton_clicked() {
  * @brief ReagentDock::on_removeButton_clicked
  */
 void ReagentDock::on_removeButton_clicked() {
-    /**
-     * removeReagentsAndBatches lambda
-     */
-    auto removeReagentsAndBatches = [ this ]( const QStandardItem *item ) {
-        const auto reagentId = item->data( ReagentModel::ID ).value<Id>();
-        const Row reagentRow = Reagent::instance()->row( reagentId );
-        if ( reagentRow == Row::Invalid )
-            return;
-
-        // remove batches
-        if ( Reagent::instance()->parentId( reagentRow ) == Id::Invalid ) {
-            const QList<Row> children( Reagent::instance()->children( reagentRow ));
-            for ( const Row &batchRow : children ) {
-                Reagent::instance()->remove( batchRow );
-
-                // remove from depcrecated nodes
-                NodeHistory::instance()->deprecatedNodes.removeOne( Reagent::instance()->id( batchRow ));
-            }
-        }
-
-        // remove reagent
-        Reagent::instance()->remove( reagentRow );
-
-        // remove from open and closed nodes (we don't need dangling reagents)
-        NodeHistory::instance()->openNodes.removeOne( reagentId );
-        NodeHistory::instance()->hiddenNodes.removeOne( reagentId );
-
-        // remove orphans just in case
-        Reagent::instance()->removeOrphanedEntries();
-        Property::instance()->removeOrphanedEntries();
-
-        // clear selection
-        this->view()->selectReagent();
-    };
-
     //QMenu menu;
     const QModelIndexList list( this->view()->selectionModel()->selectedRows());
 
@@ -563,17 +570,22 @@ void ReagentDock::on_removeButton_clicked() {
                                     ReagentDock::tr( "Confirm removal" ),
                                     ReagentDock::tr( "Remove %1 selected reagents and their batches" ).arg( list.count())) == QMessageBox::Yes ) {
         //menu.addAction( ReagentDock::tr( "Remove %1 selected reagents and their batches" ).arg( list.count()),
-        //                this, [ this, list, removeReagentsAndBatches ]() {
+        //                this, [ this, list ]() {
             QModelIndexList sourceList;
+            QList<Id> reagentIds;
             for ( const QModelIndex &filter : list ) {
                 const QModelIndex &index( this->view()->filterModel()->mapToSource( filter ));
                 sourceList << index;
 
                 const QStandardItem *item( this->view()->itemFromIndex( index ));
                 if ( item != nullptr )
-                    removeReagentsAndBatches( item );
+                    reagentIds << item->data( ReagentModel::ID ).value<Id>();
             }
 
+            // remove reagents, batches, properties and labels in a single transaction
+            Reagent::instance()->remove( qAsConst( reagentIds ));
+            this->view()->selectReagent();
+
             // remove items without resetting model
             this->view()->sourceModel()->remove( qAsConst( sourceList ));
         }// )->setIcon( QIcon::fromTheme( "remove" ));
@@ -599,8 +611,9 @@ void ReagentDock::on_removeButton_clicked() {
         //menu.addAction( ReagentDock::tr( parentId == Id::Invalid ?
         //                                     "Remove reagent '%1' and its batches" :
         //                                     "Remove batch '%1'"
-        //                                     ).arg( TextUtils::elidedString( item->text())), this, [ this, item, index, parentId, removeReagentsAndBatches ]() {
-            removeReagentsAndBatches( item );
+        //                                     ).arg( TextUtils::elidedString( item->text())), this, [ this, item, index, parentId ]() {
+            Reagent::instance()->remove( QList<Id>() << item->data( ReagentModel::ID ).value<Id>());
+            this->view()->selectReagent();
 
             // remove items without resetting model
             this->view()->sourceModel()->remove( index );
@@ -647,6 +660,19 @@ void ReagentDock::on_buttonFind_clicked() {
     }
 }
 
+/**
+ * @brief ReagentDock::selectSearchResult
+ * @param reagentId
+ */
+void ReagentDock::selectSearchResult( const Id &reagentId ) {
+    const QModelIndex index( this->view()->filterModel()->mapFromSource( this->view()->indexFromId( reagentId )));
+    if ( !index.isValid())
+        return;
+
+    this->view()->selectionModel()->select( index, QItemSelectionModel::ClearAndSelect );
+    this->view()->scrollTo( index );
+}
+
 /**
  * @brief ReagentDock::on_editButton_clicked
  */
@@ -683,9 +709,7 @@ void ReagentDock::on_editButton_clicked() {
             Reagent::instance()->setName( reagentRow, name );
 
             // rename without resetting the model
-            const QString generatedName( ReagentModel::generateName( name ));
-            item->setText( HTMLUtils::toPlainText( generatedName ));
-            item->setData( generatedName, ReagentModel::HTML );
+            this->view()->sourceModel()->update( reagentId );
         }
     } else {
         ReagentDialog rd( this, previousName, previousReference, ReagentDialog::EditMode );
@@ -700,8 +724,6 @@ void ReagentDock::on_editButton_clicked() {
         Reagent::instance()->setReference( reagentRow, reference );
 
         // rename without resetting the model
-        const QString generatedName( ReagentModel::generateName( name, reference ));
-        item->setText( HTMLUtils::toPlainText( generatedName ));
-        item->setData( generatedName, ReagentModel::HTML );
+        this->view()->sourceModel()->update( reagentId );
     }
 }
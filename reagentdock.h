@@ -72,9 +72,12 @@ private slots:
     void on_removeButton_clicked();
     void on_buttonFind_clicked();
     void on_editButton_clicked();
+    void selectSearchResult( const Id &reagentId );
 
 private:
     explicit ReagentDock( QWidget *parent = nullptr );
     Ui::ReagentDock *ui;
     QShortcut *shortcut;
+    QAction *searchModeAction;
+    QList<Id> searchResults;
 };
@@ -23,10 +23,36 @@
 #include "reagent.h"
 #include "label.h"
 #include "labeldock.h"
+#include "labelset.h"
 #include "reagentdock.h"
 #include "htmlutils.h"
+#include "startupprofiler.h"
+#include <QCollator>
 #include <QDebug>
 #include <QTextEdit>
+#include <algorithm>
+
+/**
+ * @brief ReagentModel::ReagentModel
+ * @param parent
+ */
+ReagentModel::ReagentModel( QObject *parent ) : QStandardItemModel( parent ) {
+    this->setupModelData();
+
+    // keep label strips in sync
+    ReagentModel::connect( LabelSet::instance(), &LabelSet::labelsChanged, this, &ReagentModel::updateLabels );
+    ReagentModel::connect( LabelSet::instance(), &Table::invalidated, this, [ this ]() { this->updateLabels(); } );
+    ReagentModel::connect( Label::instance(), &Table::entryChanged, this, [ this ]() { this->updateLabels(); } );
+}
+
+/**
+ * @brief ReagentModel::~ReagentModel
+ */
+ReagentModel::~ReagentModel() {
+    ReagentModel::disconnect( LabelSet::instance(), &LabelSet::labelsChanged, this, &ReagentModel::updateLabels );
+    ReagentModel::disconnect( LabelSet::instance(), &Table::invalidated, this, nullptr );
+    ReagentModel::disconnect( Label::instance(), &Table::entryChanged, this, nullptr );
+}
 
 /**
  * @brief ReagentModel::headerData
@@ -65,16 +91,12 @@ QVariant ReagentModel::data( const QModelIndex &index, int role ) const {
         if ( reagentId == Id::Invalid )
             return QVariant();
 
-        const QList<Id> labelIds( Reagent::instance()->labelIds( Reagent::instance()->row( reagentId )));
-        if ( labelIds.isEmpty())
+        const QPixmap labels( ReagentModel::labelPixmap( reagentId ));
+        if ( labels.isNull())
             return QVariant();
 
-        QList<QColor> colours;
-        for ( const Id &id : labelIds )
-            colours << Label::instance()->colour( id );
-
-        item->setData( Label::instance()->pixmap( qAsConst( colours )), ReagentModel::Pixmap );
-        return item->data( ReagentModel::Pixmap ).value<QPixmap>();
+        item->setData( labels, ReagentModel::Pixmap );
+        return labels;
     }
 
     return QStandardItemModel::data( index, role );
@@ -115,6 +137,7 @@ void ReagentModel::setupModelData() {
         reagent->setData( static_cast<int>( reagentId ), ID );
         reagent->setData( static_cast<int>( Id::Invalid ), ParentId );
         reagent->setData( generatedName, HTML );
+        reagent->setData( ReagentModel::labelPixmap( reagentId ), Pixmap );
 
         // go through batches (children of the reagent)
         for ( const Row &child : Reagent::instance()->children( row )) {
@@ -126,12 +149,62 @@ void ReagentModel::setupModelData() {
 
             ReagentModel::addItem( batchId, reagentId, reagent );
         }
+        this->updateSortKeys( reagent );
 
         // add reagent to treeView
         this->invisibleRootItem()->appendRow( reagent );
     }
 
+    this->updateSortKeys( this->invisibleRootItem());
     this->endResetModel();
+    StartupProfiler::instance()->mark( "reagent model" );
+}
+
+/**
+ * @brief ReagentModel::labelPixmap composes label strip of the given reagent
+ * @param reagentId
+ * @return
+ */
+QPixmap ReagentModel::labelPixmap( const Id &reagentId ) {
+    const QSet<Id> labelIds( LabelSet::instance()->labels( reagentId ));
+    if ( labelIds.isEmpty())
+        return QPixmap();
+
+    // NOTE: colours are read from the selected label table in its order (no per-label queries)
+    QList<QColor> colours;
+    for ( int y = 0; y < Label::instance()->count(); y++ ) {
+        const Row row = Label::instance()->row( y );
+        if ( labelIds.contains( Label::instance()->id( row )))
+            colours << Label::instance()->colour( row );
+    }
+
+    return Label::instance()->pixmap( qAsConst( colours ));
+}
+
+/**
+ * @brief ReagentModel::updateLabels recomposes label strip of a reagent (or resets all strips if none given)
+ * @param reagentId
+ */
+void ReagentModel::updateLabels( const Id &reagentId ) {
+    if ( reagentId != Id::Invalid ) {
+        QStandardItem *item( this->itemFromIndex( this->indexFromId( reagentId )));
+        if ( item != nullptr )
+            item->setData( ReagentModel::labelPixmap( reagentId ), Pixmap );
+
+        return;
+    }
+
+    const int count = this->invisibleRootItem()->rowCount();
+    if ( count == 0 )
+        return;
+
+    // strips are recomposed on demand, so just notify once
+    {
+        const QSignalBlocker blocker( this );
+        for ( int y = 0; y < count; y++ )
+            this->invisibleRootItem()->child( y )->setData( QPixmap(), Pixmap );
+    }
+    emit this->dataChanged( this->index( 0, 0 ), this->index( count - 1, 0 ), QVector<int>() << Pixmap );
 }
 
 /**
@@ -190,17 +263,86 @@ QString ReagentModel::generateName( const QString &name, const QString &referenc
  */
 void ReagentModel::add( const Id &id ) {
     const Id parentId = Reagent::instance()->parentId( id );
+    QStandardItem *parentItem( this->invisibleRootItem());
     if ( parentId != Id::Invalid ) {
         const QModelIndex index( this->indexFromId( parentId ));
         if ( !index.isValid())
             return;
 
-        ReagentModel::addItem( id, parentId, this->itemFromIndex( index ));
-    } else {
-        ReagentModel::addItem( id, Id::Invalid, this->invisibleRootItem());
+        parentItem = this->itemFromIndex( index );
+    }
+
+    ReagentModel::addItem( id, parentId, parentItem );
+    this->updateSortKeys( parentItem );
+    this->invalidateOrder();
+}
+
+/**
+ * @brief ReagentModel::update refreshes name and date of an existing item
+ * @param id
+ */
+void ReagentModel::update( const Id &id ) {
+    QStandardItem *item( this->itemFromIndex( this->indexFromId( id )));
+    if ( item == nullptr )
+        return;
+
+    const Id parentId = Reagent::instance()->parentId( id );
+    const QString generatedName( parentId == Id::Invalid ?
+                                     ReagentModel::generateName( Reagent::instance()->name( id ),
+                                                                 Reagent::instance()->reference( id ))
+                                   :
+                                     Reagent::instance()->name( id ));
+    item->setText( HTMLUtils::toPlainText( generatedName ));
+    item->setData( Reagent::instance()->dateTime( id ), DateTime );
+    item->setData( Reagent::instance()->dateTime( id ).toMSecsSinceEpoch(), DateKey );
+    item->setData( NodeHistory::instance()->isDeperecated( id ) ? QString( "<s>%1</s>" ).arg( generatedName ) : generatedName, HTML );
+
+    // name or date might have changed
+    this->updateSortKeys( item->parent() != nullptr ? item->parent() : this->invisibleRootItem());
+    this->invalidateOrder();
+}
+
+/**
+ * @brief ReagentModel::updateSortKeys ranks siblings using locale-aware collation, so that sorting
+ * compares integers instead of strings
+ * @param parentItem
+ */
+void ReagentModel::updateSortKeys( QStandardItem *parentItem ) {
+    if ( parentItem == nullptr )
+        return;
+
+    QCollator collator;
+    collator.setCaseSensitivity( Qt::CaseInsensitive );
+
+    // generate collation keys once per item
+    const int count = parentItem->rowCount();
+    QVector<QCollatorSortKey> keys;
+    QVector<int> order;
+    keys.reserve( count );
+    order.reserve( count );
+    for ( int y = 0; y < count; y++ ) {
+        keys << collator.sortKey( parentItem->child( y )->text());
+        order << y;
     }
 
-    ReagentDock::instance()->view()->filterModel()->sort( 0, Qt::AscendingOrder );
+    std::stable_sort( order.begin(), order.end(), [ &keys ]( int left, int right ) {
+        return keys.at( left ).compare( keys.at( right )) < 0;
+    } );
+
+    // NOTE: keys are internal, so there is no need to notify (proxy) model about each change
+    const QSignalBlocker blocker( this );
+    for ( int y = 0; y < count; y++ ) {
+        QStandardItem *item( parentItem->child( order.at( y )));
+        if ( item->data( SortKey ) != QVariant( y ))
+            item->setData( y, SortKey );
+    }
+}
+
+/**
+ * @brief ReagentModel::invalidateOrder resorts reagent view after sort keys have changed
+ */
+void ReagentModel::invalidateOrder() {
+    ReagentDock::instance()->view()->filterModel()->invalidate();
 }
 
 /**
@@ -219,6 +361,7 @@ void ReagentModel::addItem( const Id &id, const Id &parentId, QStandardItem *par
     item->setData( static_cast<int>( id ), ID );
     item->setData( static_cast<int>( parentId ), ParentId );
     item->setData( Reagent::instance()->dateTime( id ), DateTime );
+    item->setData( Reagent::instance()->dateTime( id ).toMSecsSinceEpoch(), DateKey );
     item->setData( NodeHistory::instance()->isDeperecated( id ) ? QString( "<s>%1</s>" ).arg( generatedName ) : generatedName, HTML );
     parentItem->appendRow( item );
 }
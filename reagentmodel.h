@@ -43,23 +43,22 @@ public:
         ParentId,
         HTML,
         Pixmap,
-        DateTime
+        DateTime,
+        SortKey,
+        DateKey
     };
 
     /**
      * @brief TreeModel
      * @param parent
      */
-    explicit ReagentModel( QObject *parent = nullptr ) : QStandardItemModel( parent ) { this->setupModelData(); }
+    explicit ReagentModel( QObject *parent = nullptr );
 
     // disable move
     ReagentModel( ReagentModel&& ) = delete;
     ReagentModel& operator=( ReagentModel&& ) = delete;
 
-    /**
-     * @brief ~TreeModel
-     */
-    ~ReagentModel() override = default;
+    ~ReagentModel() override;
 
     /**
      * @brief columnCount
@@ -74,6 +73,7 @@ public:
 
 public slots:
     void add( const Id &id );
+    void update( const Id &id );
     static void addItem( const Id &id, const Id &parentId, QStandardItem *parentItem );
     void setupModelData();
 
@@ -83,4 +83,10 @@ public slots:
      */
     void remove( const QModelIndex &index ) { this->remove( QModelIndexList() << index ); }
     void remove( const QModelIndexList &list );
+    void updateLabels( const Id &reagentId = Id::Invalid );
+
+private:
+    [[nodiscard]] static QPixmap labelPixmap( const Id &reagentId );
+    void updateSortKeys( QStandardItem *parentItem );
+    void invalidateOrder();
 };
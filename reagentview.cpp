@@ -25,6 +25,7 @@
 #include "reagent.h"
 #include "reagentdelegate.h"
 #include "reagentdock.h"
+#include "labelset.h"
 
 /**
  * @brief ReagentView::ReagentView
@@ -61,11 +62,9 @@ ReagentView::ReagentView( QWidget *parent ) : QTreeView( parent ) {
     this->resizeTimer.setSingleShot( true );
     QTimer::connect( &this->resizeTimer, &QTimer::timeout, this, [ this ]() {
         this->m_resizeInProgress = false;
-        this->delegate->clearCache();
 
-        // force update (triggered by sort)
-        this->filterModel()->sort( 0, Qt::DescendingOrder );
-        this->filterModel()->sort( 0, Qt::AscendingOrder );
+        // relayout items, since their size hints depend on width
+        this->scheduleDelayedItemsLayout();
     } );
 }
 
@@ -82,7 +81,6 @@ ReagentView::~ReagentView() {
  * @brief ReagentView::updateView
  */
 void ReagentView::updateView() {
-    this->delegate->clearCache();
     NodeHistory::instance()->setEnabled( false );
     this->sourceModel()->setupModelData();
 
@@ -192,13 +190,116 @@ void ReagentView::mouseReleaseEvent( QMouseEvent *event ) {
  * @param event
  */
 void ReagentView::resizeEvent( QResizeEvent *event ) {
-
     this->m_resizeInProgress = true;
     this->resizeTimer.start( 128 );
 
     QTreeView::resizeEvent( event );
 }
 
+/**
+ * @brief SortFilterProxyModel::SortFilterProxyModel
+ * @param parent
+ */
+SortFilterProxyModel::SortFilterProxyModel( QObject *parent ) : QSortFilterProxyModel( parent ) {
+    // keep label filter in sync with label assignments
+    auto update = [ this ]() {
+        if ( this->labelFilter() != NoLabelFilter )
+            this->updateLabelFilter();
+    };
+    // NOTE: label set is only invalidated when reloaded (changes made by other instances)
+    SortFilterProxyModel::connect( LabelSet::instance(), &LabelSet::labelsChanged, this, update );
+    SortFilterProxyModel::connect( LabelSet::instance(), &Table::invalidated, this, update );
+}
+
+/**
+ * @brief SortFilterProxyModel::setLabelFilter filters reagents by labels in memory (empty list disables label filtering)
+ * @param labelIds
+ * @param filter
+ */
+void SortFilterProxyModel::setLabelFilter( const QList<Id> &labelIds, const LabelFilter &filter ) {
+    this->labelIds = labelIds;
+    this->m_labelFilter = ( labelIds.isEmpty() && filter != NoLabels ) ? NoLabelFilter : filter;
+    this->updateLabelFilter();
+}
+
+/**
+ * @brief SortFilterProxyModel::updateLabelFilter
+ */
+void SortFilterProxyModel::updateLabelFilter() {
+    this->labelledReagents = ( this->labelFilter() == AnyLabel || this->labelFilter() == AllLabels ) ?
+                LabelSet::instance()->reagents( this->labelIds, this->labelFilter() == AllLabels ) : QSet<Id>();
+    this->invalidateFilter();
+}
+
+/**
+ * @brief SortFilterProxyModel::filterAcceptsLabels
+ * @param sourceRow
+ * @param sourceParent
+ * @return
+ */
+bool SortFilterProxyModel::filterAcceptsLabels( int sourceRow, const QModelIndex &sourceParent ) const {
+    if ( this->labelFilter() == NoLabelFilter )
+        return true;
+
+    const QModelIndex index( this->sourceModel()->index( sourceRow, 0, sourceParent ));
+    const Id id = index.data( ReagentModel::ID ).value<Id>();
+    const Id parentId = index.data( ReagentModel::ParentId ).value<Id>();
+
+    // reagents without labels (batches are shown only if their parents have no labels either)
+    if ( this->labelFilter() == NoLabels )
+        return !LabelSet::instance()->hasLabels( id ) && ( parentId == Id::Invalid || !LabelSet::instance()->hasLabels( parentId ));
+
+    // labelled reagents and their batches
+    return this->labelledReagents.contains( id ) || ( parentId != Id::Invalid && this->labelledReagents.contains( parentId ));
+}
+
+/**
+ * @brief SortFilterProxyModel::setSearchFilter shows only the given reagents, their batches and parents
+ * @param reagentIds
+ */
+void SortFilterProxyModel::setSearchFilter( const QList<Id> &reagentIds ) {
+    this->searchResults.clear();
+    this->searchParents.clear();
+    for ( const Id &id : reagentIds ) {
+        this->searchResults << id;
+
+        const Id parentId = Reagent::instance()->parentId( id );
+        if ( parentId != Id::Invalid )
+            this->searchParents << parentId;
+    }
+
+    this->m_searchFilter = true;
+    this->invalidateFilter();
+}
+
+/**
+ * @brief SortFilterProxyModel::clearSearchFilter
+ */
+void SortFilterProxyModel::clearSearchFilter() {
+    if ( !this->isSearchFilterEnabled())
+        return;
+
+    this->m_searchFilter = false;
+    this->searchResults.clear();
+    this->searchParents.clear();
+    this->invalidateFilter();
+}
+
+/**
+ * @brief SortFilterProxyModel::filterAcceptsSearch
+ * @param sourceRow
+ * @param sourceParent
+ * @return
+ */
+bool SortFilterProxyModel::filterAcceptsSearch( int sourceRow, const QModelIndex &sourceParent ) const {
+    const QModelIndex index( this->sourceModel()->index( sourceRow, 0, sourceParent ));
+    const Id id = index.data( ReagentModel::ID ).value<Id>();
+    const Id parentId = index.data( ReagentModel::ParentId ).value<Id>();
+
+    return this->searchResults.contains( id ) || this->searchParents.contains( id ) ||
+            ( parentId != Id::Invalid && this->searchResults.contains( parentId ));
+}
+
 /**
  * @brief SortFilterProxyModel::lessThan
  * @param left
@@ -206,19 +307,16 @@ void ReagentView::resizeEvent( QResizeEvent *event ) {
  * @return
  */
 bool SortFilterProxyModel::lessThan( const QModelIndex &left, const QModelIndex &right ) const {
-    const QStandardItem *leftItem( qobject_cast<ReagentModel *>( this->sourceModel())->itemFromIndex( left ));
-    const QStandardItem *rightItem( qobject_cast<ReagentModel *>( this->sourceModel())->itemFromIndex( right ));
-
-    if ( leftItem->data( ReagentModel::ParentId ).value<Id>() == Id::Invalid && rightItem->data( ReagentModel::ParentId ).value<Id>() == Id::Invalid )
-        return QSortFilterProxyModel::lessThan( left, right );
-
-    const QDateTime leftDate( leftItem->data( ReagentModel::DateTime ).toDateTime());
-    const QDateTime rightDate( rightItem->data( ReagentModel::DateTime ).toDateTime());
+    // NOTE: sort keys are precomputed by the model (siblings are either all reagents or all batches)
+    if ( left.data( ReagentModel::ParentId ).value<Id>() != Id::Invalid ) {
+        const qint64 leftDate = left.data( ReagentModel::DateKey ).toLongLong();
+        const qint64 rightDate = right.data( ReagentModel::DateKey ).toLongLong();
 
-    if ( leftDate == rightDate )
-        return QSortFilterProxyModel::lessThan( left, right );
+        if ( leftDate != rightDate )
+            return leftDate < rightDate;
+    }
 
-    return leftDate < rightDate;
+    return left.data( ReagentModel::SortKey ).toInt() < right.data( ReagentModel::SortKey ).toInt();
 }
 
 /**
@@ -228,6 +326,13 @@ bool SortFilterProxyModel::lessThan( const QModelIndex &left, const QModelIndex
  * @return
  */
 bool SortFilterProxyModel::filterAcceptsRow( int sourceRow, const QModelIndex &sourceParent ) const {
+    if ( !this->filterAcceptsLabels( sourceRow, sourceParent ))
+        return false;
+
+    // full-text search replaces name filtering
+    if ( this->isSearchFilterEnabled())
+        return this->filterAcceptsSearch( sourceRow, sourceParent );
+
     if ( QSortFilterProxyModel::filterAcceptsRow( sourceRow, sourceParent ))
         return true;
 
@@ -35,9 +35,48 @@ class SortFilterProxyModel : public QSortFilterProxyModel {
     Q_OBJECT
 
 public:
-    explicit SortFilterProxyModel( QObject *parent = nullptr ) : QSortFilterProxyModel( parent ) {}
+    /**
+     * @brief The LabelFilter enum
+     */
+    enum LabelFilter {
+        NoLabelFilter = -1,
+        AnyLabel,
+        AllLabels,
+        NoLabels
+    };
+    Q_ENUM( LabelFilter )
+
+    explicit SortFilterProxyModel( QObject *parent = nullptr );
     bool lessThan( const QModelIndex &left, const QModelIndex &right ) const override;
     bool filterAcceptsRow( int sourceRow, const QModelIndex &sourceParent ) const override;
+
+    /**
+     * @brief labelFilter
+     * @return
+     */
+    [[nodiscard]] LabelFilter labelFilter() const { return this->m_labelFilter; }
+
+    /**
+     * @brief isSearchFilterEnabled returns true if reagents are filtered by full-text search results
+     * @return
+     */
+    [[nodiscard]] bool isSearchFilterEnabled() const { return this->m_searchFilter; }
+
+public slots:
+    void setLabelFilter( const QList<Id> &labelIds = QList<Id>(), const LabelFilter &filter = AnyLabel );
+    void updateLabelFilter();
+    void setSearchFilter( const QList<Id> &reagentIds );
+    void clearSearchFilter();
+
+private:
+    [[nodiscard]] bool filterAcceptsLabels( int sourceRow, const QModelIndex &sourceParent ) const;
+    [[nodiscard]] bool filterAcceptsSearch( int sourceRow, const QModelIndex &sourceParent ) const;
+    LabelFilter m_labelFilter = NoLabelFilter;
+    QList<Id> labelIds;
+    QSet<Id> labelledReagents;
+    bool m_searchFilter = false;
+    QSet<Id> searchResults;
+    QSet<Id> searchParents;
 };
 
 /**
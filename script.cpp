@@ -21,15 +21,16 @@
  * includes
  */
 #include "main.h"
-#include "mainwindow.h"
 #include "property.h"
 #include "reagent.h"
 #include "script.h"
 #include "tag.h"
+#include "querytracer.h"
 #include <QRegularExpression>
 #include <QSqlQuery>
 #include "htmlutils.h"
 #include "variable.h"
+#include "variablehandle.h"
 #include <QtMath>
 
 /**
@@ -44,10 +45,24 @@ Script::Script() {
     // add database related tables to the engine
     this->engine.globalObject().setProperty( "JS", this->engine.newQObject( this ));
 
-    // add system related (debug) commands
+    // add math functions
     this->engine.globalObject().setProperty( "math", this->engine.newQObject( this->math ));
+}
+
+/**
+ * @brief Script::setSystem adds system related (debug) commands
+ * NOTE: these depend on the main window, so the application provides them (takes ownership)
+ * @param system
+ */
+void Script::setSystem( QObject *system ) {
+    delete this->system;
+    this->system = system;
+
 #ifdef QT_DEBUG
-    this->engine.globalObject().setProperty( "sys", this->engine.newQObject( this->system ));
+    if ( system != nullptr ) {
+        QJSEngine::setObjectOwnership( system, QJSEngine::CppOwnership );
+        this->engine.globalObject().setProperty( "sys", this->engine.newQObject( system ));
+    }
 #endif
 }
 
@@ -57,52 +72,76 @@ Script::Script() {
  * @return
  */
 QJSValue Script::evaluate( const QString &script ) {
-    QJSValue result;
-
-    // pre-process script to ensure no javascript keywords are used
-    const QRegularExpression keywords(
-            "\\b(abstract|arguments|await|boolean|break|byte|case|catch|char|class|const|continue|debugger|default|delete|do|double|else|enum|eval|export|extends|false|final|finally|float|for|function|goto|if|implements|import|in|instanceof|int|interface|let|long|native|new|null|package|private|protected|public|return|short|static|super|switch|synchronized|this|throw|throws|transient|true|try|typeof|var|void|volatile|while|with|yield|Array|Date|eval|function|hasOwnProperty|Infinity|isFinite|isNaN|isPrototypeOf|length|Math|NaN|name|Number|Object|prototype|String|toString|undefined|valueOf|alert|all|anchor|anchors|area|assign|blur|button|checkbox|clearInterval|clearTimeout|clientInformation|close|closed|confirm|constructor|crypto|decodeURI|decodeURIComponent|defaultStatus|document|element|elements|embed|embeds|encodeURI|encodeURIComponent|escape|event|fileUpload|focus|form|forms|frame|innerHeight|innerWidth|layer|layers|link|location|mimeTypes|navigate|navigator|frames|frameRate|hidden|history|image|images|offscreenBuffering|open|opener|option|outerHeight|outerWidth|packages|pageXOffset|pageYOffset|parent|parseFloat|parseInt|password|pkcs11|plugin|prompt|propertyIsEnum|radio|reset|screenX|screenY|scroll|secure|select|self|setInterval|setTimeout|status|submit|taint|text|textarea|top|unescape|untaint|window)\\b" );
-    const QRegularExpressionMatch match( keywords.match( script ));
-    if ( match.hasMatch())
-        result =
+    QString errorString;
+    const QString processed( this->preprocess( script, &errorString ));
+    if ( !errorString.isEmpty()) {
+        return
 #if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
                 this->engine.newErrorObject( QJSValue::SyntaxError,
 #else
                 QJSValue(
 #endif
-                Script::tr( "keyword \"%1\" is not allowed" ).arg( match.captured( 1 )));
+                errorString );
+    }
+
+    // evaluate script
+    QJSValue result( this->engine.evaluate( processed ));
+
+    // do some rounding up to avoid ugly numbers
+    if ( result.isNumber())
+        result = Script::formatNumber( result.toNumber(), Variable_::DecimalSeparator.value());
+
+    return result;
+}
+
+/**
+ * @brief Script::preprocess converts calculator syntax into plain javascript
+ * @param script
+ * @param errorString
+ * @return
+ */
+QString Script::preprocess( const QString &script, QString *errorString ) const {
+    // pre-process script to ensure no javascript keywords are used
+    const QRegularExpression keywords(
+            "\\b(abstract|arguments|await|boolean|break|byte|case|catch|char|class|const|continue|debugger|default|delete|do|double|else|enum|eval|export|extends|false|final|finally|float|for|function|goto|if|implements|import|in|instanceof|int|interface|let|long|native|new|null|package|private|protected|public|return|short|static|super|switch|synchronized|this|throw|throws|transient|true|try|typeof|var|void|volatile|while|with|yield|Array|Date|eval|function|hasOwnProperty|Infinity|isFinite|isNaN|isPrototypeOf|length|Math|NaN|name|Number|Object|prototype|String|toString|undefined|valueOf|alert|all|anchor|anchors|area|assign|blur|button|checkbox|clearInterval|clearTimeout|clientInformation|close|closed|confirm|constructor|crypto|decodeURI|decodeURIComponent|defaultStatus|document|element|elements|embed|embeds|encodeURI|encodeURIComponent|escape|event|fileUpload|focus|form|forms|frame|innerHeight|innerWidth|layer|layers|link|location|mimeTypes|navigate|navigator|frames|frameRate|hidden|history|image|images|offscreenBuffering|open|opener|option|outerHeight|outerWidth|packages|pageXOffset|pageYOffset|parent|parseFloat|parseInt|password|pkcs11|plugin|prompt|propertyIsEnum|radio|reset|screenX|screenY|scroll|secure|select|self|setInterval|setTimeout|status|submit|taint|text|textarea|top|unescape|untaint|window)\\b" );
+    const QRegularExpressionMatch match( keywords.match( script ));
+    if ( match.hasMatch()) {
+        if ( errorString != nullptr )
+            *errorString = Script::tr( "keyword \"%1\" is not allowed" ).arg( match.captured( 1 ));
+
+        return QString();
+    }
 
     // unfortunately we have to do this every time unless we start caching tag functions
     // which also is painful, since we have to track each add/edit/remove
     // performance is a non-issue, so this can remain as-is for now
     // the other option (mapping globalObject properties via wrapper function is
     // also not the preferred way, since we also have to track tag updates)
-    if ( !result.isError()) {
-        const QStringList functions( Tag::instance()->getFunctionList());
-        // do replacement magic:
-        //  1) replace proto-functions with JS.getProperty( functionName, args, .. )
-        //  2) replace comma decimal separator with a dot
-        //  3) simplify string to remove trailing whitespace and newline
-        const QString processed( QString( script ).replace(
-                QRegularExpression( QString( R"((%1)\s*\(\s*\")" ).arg( functions.join( "|" ))),
-                R"(JS.getProperty( "\1", ")" ).replace(
-                QRegularExpression( R"((\d+),(\d+)(?=(?:[^"]|"[^"]*")*$))" ), "\\1.\\2" ).replace(
-                QRegularExpression( R"((?<!")\b(ans)\b(?!"))" ), "JS.ans()" ).replace(
-                QRegularExpression( QString( R"((?<!")\b(%1\s*\(.+?(?=\))\)))" ).arg( this->getMathFunctionList().join( "|" ))), "math.\\1" )
-                                 .simplified());
-
-        // evaluate script
-        result = this->engine.evaluate( processed );
-
-        // do some rounding up to avoid ugly numbers
-        if ( result.isNumber()) {
-            result = QString::number( result.toNumber(), 'g', 12 )
-                    .replace( QRegularExpression( "(\\d+)[,.](\\d+)" ),
-                              QString( "\\1%1\\2" ).arg( Variable::string( "decimalSeparator" )));
-        }
-    }
+    const QStringList functions( Tag::instance()->getFunctionList());
+
+    // do replacement magic:
+    //  1) replace proto-functions with JS.getProperty( functionName, args, .. )
+    //  2) replace comma decimal separator with a dot
+    //  3) simplify string to remove trailing whitespace and newline
+    return QString( script ).replace(
+            QRegularExpression( QString( R"((%1)\s*\(\s*\")" ).arg( functions.join( "|" ))),
+            R"(JS.getProperty( "\1", ")" ).replace(
+            QRegularExpression( R"((\d+),(\d+)(?=(?:[^"]|"[^"]*")*$))" ), "\\1.\\2" ).replace(
+            QRegularExpression( R"((?<!")\b(ans)\b(?!"))" ), "JS.ans()" ).replace(
+            QRegularExpression( QString( R"((?<!")\b(%1\s*\(.+?(?=\))\)))" ).arg( this->getMathFunctionList().join( "|" ))), "math.\\1" )
+                             .simplified();
+}
 
-    return result;
+/**
+ * @brief Script::formatNumber rounds the result and applies the given decimal separator
+ * @param value
+ * @param decimalSeparator
+ * @return
+ */
+QString Script::formatNumber( qreal value, const QString &decimalSeparator ) {
+    return QString::number( value, 'g', 12 )
+            .replace( QRegularExpression( "(\\d+)[,.](\\d+)" ),
+                      QString( "\\1%1\\2" ).arg( decimalSeparator ));
 }
 
 /**
@@ -273,12 +312,11 @@ Script::getPropertyInternal( const QString &functionName, const QString &referen
  */
 Id Script::getPropertyId( const QString &name ) const {
     QSqlQuery query;
-    query.exec( QString( "select %1 from %2 where %3='%4'" )
+    QueryTracer::exec( query, QString( "select %1 from %2 where %3='%4'" )
                         .arg( Tag::instance()->fieldName( Tag::ID ),
                               Tag::instance()->tableName(),
                               Tag::instance()->fieldName( Tag::Function ),
-                              name )
-    );
+                              name ), "script" );
     return query.next() ? query.value( 0 ).value<Id>() : Id::Invalid;
 }
 
@@ -291,15 +329,14 @@ Id Script::getPropertyId( const QString &name ) const {
 Id Script::getReagentId( const QString &reference, const Id &parentId ) const {
     // first pass (no rich text)
     QSqlQuery query;
-    query.exec( QString( "select %1 from %2 where ( %3='%4' or %5='%4' ) and ( %6=%7 )" )
+    QueryTracer::exec( query, QString( "select %1 from %2 where ( %3='%4' or %5='%4' ) and ( %6=%7 )" )
                         .arg( Reagent::instance()->fieldName( Reagent::ID ),
                               Reagent::instance()->tableName(),
                               Reagent::instance()->fieldName( Reagent::Reference ),
                               reference,
                               Reagent::instance()->fieldName( Reagent::Name ),
                               Reagent::instance()->fieldName( Reagent::ParentId ),
-                              QString::number( static_cast<int>( parentId )))
-    );
+                              QString::number( static_cast<int>( parentId ))), "script" );
 
     if ( query.next())
         return query.value( 0 ).value<Id>();
@@ -308,14 +345,13 @@ Id Script::getReagentId( const QString &reference, const Id &parentId ) const {
     // second pass (handles rich text)
     //
     // get all names and reference
-    query.exec( QString( "select %1, %2, %3 from %4 where %5=%6" )
+    QueryTracer::exec( query, QString( "select %1, %2, %3 from %4 where %5=%6" )
                         .arg( Reagent::instance()->fieldName( Reagent::ID ),
                               Reagent::instance()->fieldName( Reagent::Name ),
                               Reagent::instance()->fieldName( Reagent::Reference ),
                               Reagent::instance()->tableName(),
                               Reagent::instance()->fieldName( Reagent::ParentId ),
-                              QString::number( static_cast<int>( parentId )))
-    );
+                              QString::number( static_cast<int>( parentId ))), "script" );
 
     // build a map of plainText names as keys and ids as values
     QMap<QString, Id> map;
@@ -343,7 +379,7 @@ Id Script::getReagentId( const QString &reference, const Id &parentId ) const {
  */
 QVariant Script::getPropertyValue( const Id &tagId, const Id &reagentId, const Id &parentId ) const {
     QSqlQuery query;
-    query.exec( QString( "select %1 from %2 where ( %3=%4 and %5=%6 ) "
+    QueryTracer::exec( query, QString( "select %1 from %2 where ( %3=%4 and %5=%6 ) "
                          "or ( %3=%4 and %5=%7 and ( select count(*) from %2 where ( %3=%4 and %5=%6 )) = 0 )" )
                         .arg( Property::instance()->fieldName( Property::PropertyData ),// 1
                               Property::instance()->tableName(),                        // 2
@@ -351,8 +387,8 @@ QVariant Script::getPropertyValue( const Id &tagId, const Id &reagentId, const I
                               QString::number( static_cast<int>( tagId )),              // 4
                               Property::instance()->fieldName( Property::ReagentId ),   // 5
                               QString::number( static_cast<int>( reagentId )),          // 6
-                              QString::number( static_cast<int>( parentId )))           // 7
-    );
+                              QString::number( static_cast<int>( parentId ))),          // 7
+                       "script" );
 
     return query.next() ? query.value( 0 ) : QVariant();
 }
@@ -363,6 +399,9 @@ QVariant Script::getPropertyValue( const Id &tagId, const Id &reagentId, const I
  */
 QStringList Script::getSystemFunctionList() const {
     QStringList functions;
+    if ( this->system == nullptr )
+        return functions;
+
     for ( int y = 0; y < this->system->metaObject()->methodCount(); y++ ) {
         QMetaMethod method( this->system->metaObject()->method( y ));
 
@@ -25,7 +25,6 @@
 #include <QJSEngine>
 #include <QTime>
 #include "scriptmath.h"
-#include "system.h"
 #include "table.h"
 
 /**
@@ -64,7 +63,11 @@ public:
         delete this->math;
     }
 
+    void setSystem( QObject *system );
+
     [[nodiscard]] QJSValue evaluate( const QString &script );
+    [[nodiscard]] QString preprocess( const QString &script, QString *errorString = nullptr ) const;
+    [[nodiscard]] static QString formatNumber( qreal value, const QString &decimalSeparator );
     Q_INVOKABLE QJSValue ans();
     Q_INVOKABLE QJSValue getProperty( const QString &functionName, const QString &reference );
     Q_INVOKABLE QJSValue getProperty( const QString &functionName, const QString &reference, const QString &batchName );
@@ -79,6 +82,6 @@ public:
 private:
     explicit Script();
     QJSEngine engine;
-    System *system = new System();
+    QObject *system = nullptr;
     ScriptMath *math = new ScriptMath();
 };
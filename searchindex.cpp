@@ -0,0 +1,361 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "searchindex.h"
+#include "reagent.h"
+#include "property.h"
+#include "tag.h"
+#include "htmlutils.h"
+#include "main.h"
+#include "querytracer.h"
+#include "database.h"
+#include <QRegularExpression>
+#include <QSqlQuery>
+#include <QSet>
+
+/**
+ * @brief plainText strips html from stored values
+ * @param string
+ * @return
+ */
+static QString plainText( const QString &string ) {
+    // avoid expensive html parsing for plain strings
+    return ( string.contains( '<' ) || string.contains( '&' ) ? HTMLUtils::toPlainText( string ) : string ).simplified();
+}
+
+/**
+ * @brief propertyContent returns searchable text of a property
+ * @param tagId
+ * @param name
+ * @param data
+ * @param type
+ * @return
+ */
+static QString propertyContent( const Id &tagId, const QString &name, const QString &data, const Tag::Types &type ) {
+    // pictograms, pixmaps and structures have no searchable text
+    const bool textual = tagId != PixmapTag && type != Tag::GHS && type != Tag::NFPA && type != Tag::Formula;
+    const QString value( textual ? plainText( data ) : QString());
+
+    // custom properties are found by their names as well
+    return tagId == Id::Invalid ? QString( "%1 %2" ).arg( plainText( name ), value ).trimmed() : value;
+}
+
+/**
+ * @brief SearchIndex::SearchIndex
+ */
+SearchIndex::SearchIndex() {
+    // add to garbage collector
+    GarbageMan::instance()->add( this );
+
+    // NOTE: fts5 is compiled into Qt's bundled sqlite, but not necessarily into the system one
+    QSqlQuery query;
+    this->m_available = QueryTracer::exec( query, QString( "create virtual table if not exists %1 using fts5( content, reagentId unindexed, tokenize = 'unicode61', prefix = '2 3' )" )
+                                     .arg( SearchIndex::TableName ), "search" );
+    if ( !this->isAvailable()) {
+        qWarning() << SearchIndex::tr( "full-text search is not available" );
+        return;
+    }
+
+    // entries are inserted one by one, so the statement is prepared once
+    this->insertQuery.prepare( QString( "insert or replace into %1( rowid, content, reagentId ) values( ?, ?, ? )" ).arg( SearchIndex::TableName ));
+
+    // keep index up to date with reagents
+    SearchIndex::connect( Reagent::instance(), &Table::entryAdded, this, &SearchIndex::updateReagent );
+    // NOTE: removed reagents are dropped from the index by Reagent::remove (batches and properties included)
+    SearchIndex::connect( Reagent::instance(), &Table::entryChanged, this, [ this ]( const Id &reagentId, int fieldId ) {
+        if ( fieldId == Reagent::Name || fieldId == Reagent::Reference )
+            this->updateReagent( reagentId );
+    } );
+    SearchIndex::connect( Reagent::instance(), &Table::invalidated, this, &SearchIndex::invalidate );
+
+    // keep index up to date with properties
+    SearchIndex::connect( Property::instance(), &Table::entryAdded, this, &SearchIndex::updateProperty );
+    SearchIndex::connect( Property::instance(), &Table::entryAboutToBeRemoved, this, &SearchIndex::removeProperty );
+    SearchIndex::connect( Property::instance(), &Table::entryChanged, this, [ this ]( const Id &propertyId, int fieldId ) {
+        if ( fieldId == Property::Name || fieldId == Property::TagId || fieldId == Property::PropertyData || fieldId == Property::ReagentId )
+            this->updateProperty( propertyId );
+    } );
+    SearchIndex::connect( Property::instance(), &Table::invalidated, this, &SearchIndex::invalidate );
+
+    // properties of removed tags are removed by sqlite through foreign keys
+    SearchIndex::connect( Tag::instance(), &Table::entryAboutToBeRemoved, this, &SearchIndex::removeTag );
+
+    // index is stored in the database, so it is only rebuilt if it has gone out of sync (or is new)
+    this->dirty = this->isStale();
+}
+
+/**
+ * @brief SearchIndex::isStale compares number of indexed entries with number of reagents and properties
+ * @return
+ */
+bool SearchIndex::isStale() const {
+    QSqlQuery query;
+    QueryTracer::exec( query, QString( "select ( select count(*) from %1 ) != ( select count(*) from %2 ) + ( select count(*) from %3 where typeof( %4 ) != 'blob' )" )
+                .arg( SearchIndex::TableName,
+                      Reagent::instance()->tableName(),
+                      Property::instance()->tableName(),
+                      Property::instance()->fieldName( Property::PropertyData )), "search" );
+
+    return !query.next() || query.value( 0 ).toBool();
+}
+
+/**
+ * @brief SearchIndex::rebuild reindexes all reagents and properties in a single transaction
+ */
+void SearchIndex::rebuild() {
+    if ( !this->isAvailable())
+        return;
+
+    Transaction transaction;
+    QSqlQuery query;
+    QueryTracer::exec( query, QString( "delete from %1" ).arg( SearchIndex::TableName ), "search" );
+
+    // reagent names and references
+    QueryTracer::exec( query, QString( "select %1, %2, %3 from %4" )
+                .arg( Reagent::instance()->fieldName( Reagent::ID ),
+                      Reagent::instance()->fieldName( Reagent::Name ),
+                      Reagent::instance()->fieldName( Reagent::Reference ),
+                      Reagent::instance()->tableName()), "search" );
+    while ( query.next()) {
+        const Id reagentId = query.value( 0 ).value<Id>();
+        this->insert( SearchIndex::reagentRowId( reagentId ), reagentId, QString( "%1 %2" ).arg( plainText( query.value( 1 ).toString()), plainText( query.value( 2 ).toString())).trimmed());
+    }
+
+    // textual property values (tag types are read once)
+    QHash<Id, Tag::Types> types;
+    QueryTracer::exec( query, QString( "select %1, %2, %3, %4, %5 from %6 where typeof( %5 ) != 'blob'" )
+                .arg( Property::instance()->fieldName( Property::ID ),
+                      Property::instance()->fieldName( Property::ReagentId ),
+                      Property::instance()->fieldName( Property::TagId ),
+                      Property::instance()->fieldName( Property::Name ),
+                      Property::instance()->fieldName( Property::PropertyData ),
+                      Property::instance()->tableName()), "search" );
+    while ( query.next()) {
+        const Id tagId = query.value( 2 ).value<Id>();
+        if ( tagId != Id::Invalid && !types.contains( tagId ))
+            types[tagId] = tagId == PixmapTag ? Tag::NoType : Tag::instance()->type( tagId );
+
+        this->insert( SearchIndex::propertyRowId( query.value( 0 ).value<Id>()),
+                      query.value( 1 ).value<Id>(),
+                      propertyContent( tagId, query.value( 3 ).toString(), query.value( 4 ).toString(), types.value( tagId, Tag::Text )));
+    }
+
+    this->dirty = false;
+}
+
+/**
+ * @brief SearchIndex::search returns ids of matching reagents ordered by relevance
+ * @param text search string (words are matched as prefixes)
+ * @param limit
+ * @return
+ */
+QList<Id> SearchIndex::search( const QString &text, int limit ) {
+    if ( !this->isAvailable())
+        return QList<Id>();
+
+    if ( this->dirty )
+        this->rebuild();
+
+    // split each word into tokens the same way unicode61 tokenizer does
+    const QRegularExpression separator( "\\W+", QRegularExpression::UseUnicodePropertiesOption );
+    QStringList phrases;
+    QStringList tokens;
+    for ( const QString &word : text.split( ' ' )) {
+        QStringList parts( word.split( separator ));
+        parts.removeAll( QString());
+        if ( parts.isEmpty())
+            continue;
+
+        // NOTE: quotes cannot appear in tokens, so phrases do not need escaping
+        phrases << QString( "\"%1\"*" ).arg( parts.join( " " ));
+        tokens << parts;
+    }
+
+    if ( phrases.isEmpty())
+        return QList<Id>();
+
+    // all words as prefixes first
+    const QList<Id> ids( this->match( phrases.join( " " ), limit ));
+    if ( !ids.isEmpty())
+        return ids;
+
+    // fuzzy fallback: any token with shortened prefixes (tolerates typos at word endings)
+    QStringList relaxed;
+    for ( const QString &token : qAsConst( tokens ))
+        relaxed << QString( "\"%1\"*" ).arg( token.length() > 4 ? token.left( token.length() - 2 ) : token );
+
+    return this->match( relaxed.join( " OR " ), limit );
+}
+
+/**
+ * @brief SearchIndex::match runs a full-text query and returns unique reagent ids ordered by rank
+ * @param expression fts5 match expression
+ * @param limit
+ * @return
+ */
+QList<Id> SearchIndex::match( const QString &expression, int limit ) const {
+    QSqlQuery query;
+    query.prepare( QString( "select reagentId from %1 where %1 match ? order by rank limit %2" )
+                   .arg( SearchIndex::TableName, QString::number( limit * 4 )));
+    query.addBindValue( expression );
+
+    QList<Id> ids;
+    if ( !QueryTracer::exec( query, "search" ))
+        return ids;
+
+    // a single reagent can match through several of its properties
+    QSet<Id> unique;
+    while ( query.next() && ids.count() < limit ) {
+        const Id id = query.value( 0 ).value<Id>();
+        if ( unique.contains( id ))
+            continue;
+
+        unique << id;
+        ids << id;
+    }
+
+    return ids;
+}
+
+/**
+ * @brief SearchIndex::insert
+ * @param rowId
+ * @param reagentId
+ * @param content
+ */
+void SearchIndex::insert( qint64 rowId, const Id &reagentId, const QString &content ) {
+    this->insertQuery.addBindValue( rowId );
+    this->insertQuery.addBindValue( content );
+    this->insertQuery.addBindValue( static_cast<int>( reagentId ));
+    QueryTracer::exec( this->insertQuery, "search" );
+}
+
+/**
+ * @brief SearchIndex::remove
+ * @param rowId
+ */
+void SearchIndex::remove( qint64 rowId ) {
+    QSqlQuery query;
+    QueryTracer::exec( query, QString( "delete from %1 where rowid=%2" ).arg( SearchIndex::TableName, QString::number( rowId )), "search" );
+}
+
+/**
+ * @brief SearchIndex::updateReagent
+ * @param reagentId
+ */
+void SearchIndex::updateReagent( const Id &reagentId ) {
+    if ( this->dirty )
+        return;
+
+    QSqlQuery query;
+    QueryTracer::exec( query, QString( "select %1, %2 from %3 where %4=%5" )
+                .arg( Reagent::instance()->fieldName( Reagent::Name ),
+                      Reagent::instance()->fieldName( Reagent::Reference ),
+                      Reagent::instance()->tableName(),
+                      Reagent::instance()->fieldName( Reagent::ID ),
+                      QString::number( static_cast<int>( reagentId ))), "search" );
+    if ( query.next())
+        this->insert( SearchIndex::reagentRowId( reagentId ), reagentId, QString( "%1 %2" ).arg( plainText( query.value( 0 ).toString()), plainText( query.value( 1 ).toString())).trimmed());
+}
+
+/**
+ * @brief SearchIndex::removeReagents removes reagents and their properties from the index
+ *
+ * Must be called before properties are removed. Entries are deleted by rowid, since
+ * reagentId is not indexed and filtering on it would scan the whole index.
+ * @param reagentIds
+ */
+void SearchIndex::removeReagents( const QList<Id> &reagentIds ) {
+    if ( !this->isAvailable() || this->dirty || reagentIds.isEmpty())
+        return;
+
+    QStringList list;
+    QStringList rowIds;
+    for ( const Id &id : reagentIds ) {
+        list << QString::number( static_cast<int>( id ));
+        rowIds << QString::number( SearchIndex::reagentRowId( id ));
+    }
+
+    QSqlQuery query;
+    QueryTracer::exec( query, QString( "delete from %1 where rowid in ( %2 )" ).arg( SearchIndex::TableName, rowIds.join( ", " )), "search" );
+    QueryTracer::exec( query, QString( "delete from %1 where rowid in ( select %2 * 2 from %3 where %4 in ( %5 ))" )
+                .arg( SearchIndex::TableName,
+                      Property::instance()->fieldName( Property::ID ),
+                      Property::instance()->tableName(),
+                      Property::instance()->fieldName( Property::ReagentId ),
+                      list.join( ", " )), "search" );
+}
+
+/**
+ * @brief SearchIndex::removeTag removes properties of a tag that is about to be removed from the index
+ * @param tagId
+ */
+void SearchIndex::removeTag( const Id &tagId ) {
+    if ( this->dirty )
+        return;
+
+    QSqlQuery query;
+    QueryTracer::exec( query, QString( "delete from %1 where rowid in ( select %2 * 2 from %3 where %4=%5 )" )
+                .arg( SearchIndex::TableName,
+                      Property::instance()->fieldName( Property::ID ),
+                      Property::instance()->tableName(),
+                      Property::instance()->fieldName( Property::TagId ),
+                      QString::number( static_cast<int>( tagId ))), "search" );
+}
+
+/**
+ * @brief SearchIndex::updateProperty
+ * @param propertyId
+ */
+void SearchIndex::updateProperty( const Id &propertyId ) {
+    if ( this->dirty )
+        return;
+
+    QSqlQuery query;
+    QueryTracer::exec( query, QString( "select %1, %2, %3, %4, typeof( %4 ) from %5 where %6=%7" )
+                .arg( Property::instance()->fieldName( Property::ReagentId ),
+                      Property::instance()->fieldName( Property::TagId ),
+                      Property::instance()->fieldName( Property::Name ),
+                      Property::instance()->fieldName( Property::PropertyData ),
+                      Property::instance()->tableName(),
+                      Property::instance()->fieldName( Property::ID ),
+                      QString::number( static_cast<int>( propertyId ))), "search" );
+    if ( !query.next())
+        return;
+
+    if ( query.value( 4 ).toString() == "blob" ) {
+        this->remove( SearchIndex::propertyRowId( propertyId ));
+        return;
+    }
+
+    const Id tagId = query.value( 1 ).value<Id>();
+    const Tag::Types type = ( tagId == Id::Invalid || tagId == PixmapTag ) ? Tag::Text : Tag::instance()->type( tagId );
+    this->insert( SearchIndex::propertyRowId( propertyId ), query.value( 0 ).value<Id>(), propertyContent( tagId, query.value( 2 ).toString(), query.value( 3 ).toString(), type ));
+}
+
+/**
+ * @brief SearchIndex::removeProperty
+ * @param propertyId
+ */
+void SearchIndex::removeProperty( const Id &propertyId ) {
+    if ( !this->dirty )
+        this->remove( SearchIndex::propertyRowId( propertyId ));
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QObject>
+#include <QSqlQuery>
+#include "table.h"
+
+/**
+ * @brief The SearchIndex class maintains an SQLite FTS5 index over reagent names, references and property values
+ */
+class SearchIndex final : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( SearchIndex )
+
+public:
+    // disable move
+    SearchIndex( SearchIndex&& ) = delete;
+    SearchIndex& operator=( SearchIndex&& ) = delete;
+
+    /**
+     * @brief instance
+     * @return
+     */
+    static SearchIndex *instance() {
+        static auto *instance( new SearchIndex());
+        return instance;
+    }
+    ~SearchIndex() override = default;
+
+    /**
+     * @brief isAvailable returns false if sqlite was built without FTS5
+     * @return
+     */
+    [[nodiscard]] bool isAvailable() const { return this->m_available; }
+    [[nodiscard]] QList<Id> search( const QString &text, int limit = 256 );
+    static constexpr const char *TableName = "reagentSearch";
+
+public slots:
+    void rebuild();
+
+    /**
+     * @brief invalidate marks index for rebuild on the next search
+     */
+    void invalidate() { this->dirty = true; }
+    void removeReagents( const QList<Id> &reagentIds );
+
+private slots:
+    void updateReagent( const Id &reagentId );
+    void removeTag( const Id &tagId );
+    void updateProperty( const Id &propertyId );
+    void removeProperty( const Id &propertyId );
+
+private:
+    explicit SearchIndex();
+    [[nodiscard]] bool isStale() const;
+    [[nodiscard]] QList<Id> match( const QString &expression, int limit ) const;
+    void insert( qint64 rowId, const Id &reagentId, const QString &content );
+    void remove( qint64 rowId );
+
+    /**
+     * @brief reagentRowId reagents and properties share the index, hence odd and even rowids
+     * @param reagentId
+     * @return
+     */
+    [[nodiscard]] static qint64 reagentRowId( const Id &reagentId ) { return static_cast<qint64>( reagentId ) * 2 + 1; }
+
+    /**
+     * @brief propertyRowId
+     * @param propertyId
+     * @return
+     */
+    [[nodiscard]] static qint64 propertyRowId( const Id &propertyId ) { return static_cast<qint64>( propertyId ) * 2; }
+
+    bool m_available = false;
+    bool dirty = false;
+    QSqlQuery insertQuery;
+};
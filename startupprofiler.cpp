@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "startupprofiler.h"
+#include "main.h"
+
+/**
+ * @brief StartupProfiler::StartupProfiler
+ */
+StartupProfiler::StartupProfiler() {
+    this->timer.start();
+
+    // add to garbage collector
+    GarbageMan::instance()->add( this );
+}
+
+/**
+ * @brief StartupProfiler::mark ends the current phase (marks made after startup are ignored)
+ * @param phase
+ */
+void StartupProfiler::mark( const QString &phase ) {
+    if ( this->isFinished())
+        return;
+
+    const qint64 now = this->timer.nsecsElapsed();
+    this->m_phases << qMakePair( phase, now - this->last );
+    this->last = now;
+
+    qCDebug( StartupProfiler_::Debug ).noquote() << QString( "%1 - %2 ms" ).arg( phase ).arg( this->m_phases.last().second / 1.0e6, 0, 'f', 1 );
+}
+
+/**
+ * @brief StartupProfiler::finish
+ */
+void StartupProfiler::finish() {
+    if ( this->isFinished())
+        return;
+
+    this->m_finished = true;
+    qCInfo( StartupProfiler_::Debug ).noquote() << StartupProfiler::tr( "started in %1 ms" ).arg( this->last / 1.0e6, 0, 'f', 1 );
+}
+
+/**
+ * @brief StartupProfiler::report returns phases and their durations as plain text
+ * @return
+ */
+QString StartupProfiler::report() const {
+    QString report;
+    for ( const auto &phase : this->m_phases )
+        report.append( QString( "%1: %2 ms\n" ).arg( phase.first ).arg( phase.second / 1.0e6, 0, 'f', 1 ));
+
+    report.append( StartupProfiler::tr( "Total: %1 ms" ).arg( this->last / 1.0e6, 0, 'f', 1 ));
+    return report;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QPair>
+
+/**
+ * @brief The StartupProfiler_ namespace
+ */
+namespace StartupProfiler_ {
+    const static QLoggingCategory Debug( "startup" );
+}
+
+/**
+ * @brief The StartupProfiler class measures time spent in each phase of startup
+ */
+class StartupProfiler final : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( StartupProfiler )
+
+public:
+    // disable move
+    StartupProfiler( StartupProfiler&& ) = delete;
+    StartupProfiler& operator=( StartupProfiler&& ) = delete;
+
+    /**
+     * @brief instance
+     * @return
+     */
+    static StartupProfiler *instance() {
+        static auto *instance( new StartupProfiler());
+        return instance;
+    }
+    ~StartupProfiler() override = default;
+
+    void mark( const QString &phase );
+    void finish();
+
+    /**
+     * @brief phases returns phase names and their durations in nanoseconds
+     * @return
+     */
+    [[nodiscard]] QList<QPair<QString, qint64>> phases() const { return this->m_phases; }
+
+    /**
+     * @brief isFinished
+     * @return
+     */
+    [[nodiscard]] bool isFinished() const { return this->m_finished; }
+    [[nodiscard]] QString report() const;
+
+private:
+    explicit StartupProfiler();
+    QElapsedTimer timer;
+    qint64 last = 0;
+    bool m_finished = false;
+    QList<QPair<QString, qint64>> m_phases;
+};
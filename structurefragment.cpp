@@ -32,9 +32,6 @@
 #include "reagentdialog.h"
 #include "fragmentnavigation.h"
 #include "reagentdock.h"
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
 
 // TODO: disable property fragment on error
 
@@ -43,10 +40,36 @@
  * @param cidList
  * @param parent
  */
-StructureFragment::StructureFragment( QWidget *parent ) : Fragment( parent ), ui( new Ui::StructureFragment ) {
+StructureFragment::StructureFragment( QWidget *parent ) : Fragment( parent ), ui( new Ui::StructureFragment ), prefetcher( new StructurePrefetcher( this )), thumbnails( new ThumbnailModel( this )) {
     // setup ui
     this->ui->setupUi( this );
 
+    // setup thumbnail grid (hidden until requested)
+    this->ui->gridView->setModel( this->thumbnails );
+    this->ui->gridView->hide();
+    QAction::connect( this->ui->actionGrid, &QAction::toggled, this, [ this ]( bool checked ) {
+        this->ui->gridView->setVisible( checked );
+        this->ui->structureWidget->setVisible( !checked );
+        if ( checked )
+            this->ui->gridView->setCurrentIndex( this->thumbnails->index( this->index()));
+
+        this->host()->adjustSize();
+    } );
+
+    // picking a structure from the grid browses to it, double click returns to the single structure view
+    QListView::connect( this->ui->gridView, &QListView::clicked, this, [ this ]( const QModelIndex &index ) {
+        if ( !index.isValid() || index.row() == this->index())
+            return;
+
+        this->m_index = index.row();
+        this->validate();
+        this->getNameAndFormula();
+    } );
+    QListView::connect( this->ui->gridView, &QListView::doubleClicked, this, [ this ]() { this->ui->actionGrid->setChecked( false ); } );
+
+    // neighbouring structures are fetched in the background
+    StructurePrefetcher::connect( this->prefetcher, &StructurePrefetcher::prefetched, this, &StructureFragment::prefetched );
+
     // set tip icons
     const QPixmap pixmap( QIcon::fromTheme( "info" ).pixmap( 16, 16 ));
     const QList<QLabel*> tips( QList<QLabel*>() << this->ui->tipIcon );
@@ -94,6 +117,10 @@ StructureFragment::~StructureFragment() {
     QAction::disconnect( this->ui->actionPrevious, &QAction::triggered,  this, nullptr );
     QAction::disconnect( this->ui->actionNext, &QAction::triggered,  this, nullptr );
     QAction::disconnect( this->ui->actionFetch, &QAction::triggered,  this, nullptr );
+    QAction::disconnect( this->ui->actionGrid, &QAction::toggled,  this, nullptr );
+    QListView::disconnect( this->ui->gridView, &QListView::clicked, this, nullptr );
+    QListView::disconnect( this->ui->gridView, &QListView::doubleClicked, this, nullptr );
+    StructurePrefetcher::disconnect( this->prefetcher, &StructurePrefetcher::prefetched, this, &StructureFragment::prefetched );
 
     delete this->ui;
 }
@@ -150,9 +177,18 @@ void StructureFragment::getNameAndFormula() {
     // get current id (selected reagent)
     const int cid = cidList.at( this->index());
     this->ui->cidEdit->setText( QString::number( cid ));
-
-    // get formula
-    if ( Cache::instance()->contains( Cache::FormulaContext, QString( "%1.png" ).arg( this->cid()))) {
+    this->ui->gridView->setCurrentIndex( this->thumbnails->index( this->index()));
+
+    // fetch neighbours in the background
+    this->prefetcher->prefetch( this->index());
+
+    // get formula (processed, being prefetched, cached or from network)
+    if ( this->prefetcher->contains( cid )) {
+        qDebug() << "    prefetch->formula (BROWSER)" << this->queryName();
+        this->setFormula( QPixmap::fromImage( this->prefetcher->image( cid )), cid );
+    } else if ( this->prefetcher->isFormulaPending( cid )) {
+        qDebug() << "    waiting for prefetch->formula (BROWSER)" << this->queryName();
+    } else if ( Cache::instance()->contains( Cache::FormulaContext, QString( "%1.png" ).arg( this->cid()))) {
         qDebug() << "    cache->formula (BROWSER)" << this->queryName();
         this->readFormula( Cache::instance()->getData( Cache::FormulaContext, QString( "%1.png" ).arg( this->cid())), this->cid());
     } else {
@@ -161,7 +197,9 @@ void StructureFragment::getNameAndFormula() {
     }
 
     // get name
-    if ( Cache::instance()->contains( Cache::NameContext, QString( "%1" ).arg( this->cid()))) {
+    if ( this->prefetcher->isNamePending( cid )) {
+        qDebug() << "    waiting for prefetch->name (BROWSER)" << this->queryName();
+    } else if ( Cache::instance()->contains( Cache::NameContext, QString( "%1" ).arg( this->cid()))) {
         qDebug() << "    cache->name (BROWSER)" << this->queryName();
         this->readName( Cache::instance()->getData( Cache::NameContext, QString( "%1" ).arg( this->cid())), this->cid());
     } else {
@@ -187,7 +225,19 @@ void StructureFragment::readFormula( const QByteArray &data, const int id ) {
 
     const QPixmap cropped( PixmapUtils::cropAndRemoveAlpha( qAsConst( pixmap ), QColor::fromRgb( 245, 245, 245, 255 )));
     const bool darkMode = Variable::isEnabled( "darkMode" );
-    this->ui->structurePixmap->setPixmap( darkMode ? PixmapUtils::invert( cropped ) : cropped );
+    this->setFormula( darkMode ? PixmapUtils::invert( cropped ) : cropped, id );
+}
+
+/**
+ * @brief StructureFragment::setFormula displays a processed structure
+ * @param pixmap
+ * @param id
+ */
+void StructureFragment::setFormula( const QPixmap &pixmap, const int id ) {
+    if ( this->cid() != id || id <= 0 )
+        return;
+
+    this->ui->structurePixmap->setPixmap( pixmap );
 
     // trigger size adjustment
     this->ui->structurePixmap->hide();
@@ -235,48 +285,13 @@ bool StructureFragment::parseFormulaRequest( const QByteArray &data, const int i
  */
 bool StructureFragment::parseNameRequest( const QByteArray &data, const int id ) {
     if ( !data.isEmpty()) {
-        //const QString name( data );
         qDebug() << "    network->name (browser)" << this->queryName();
 
-
-        const QJsonDocument document( QJsonDocument::fromJson( data ));
-        const QJsonValue value( document.isArray() ? QJsonValue( document.array()) : document.object());
-        if ( value.isObject()) {
-            const QJsonObject valueObject( value.toObject());
-
-            if ( valueObject.contains( "InformationList" )) {
-                const QJsonValue infoListValue( valueObject["InformationList"] );
-
-                if ( infoListValue.isObject()) {
-                    const QJsonObject infoListObject( infoListValue.toObject());
-
-                    if ( infoListObject.contains( "Information" )) {
-                        const QJsonValue infoValue( infoListObject["Information"] );
-
-                        if ( infoValue.isArray()) {
-                            const QJsonArray infoArray( infoValue.toArray());
-
-                            for ( const QJsonValue &val : infoArray ) {
-                                if ( !val.isObject())
-                                    continue;
-
-                                const QJsonObject obj( val.toObject());
-                                if ( !obj.contains( "Title" ))
-                                    continue;
-
-                                const QString name( obj["Title"].toString());
-                                if ( name.isEmpty())
-                                    continue;
-
-
-                                Cache::instance()->insert( Cache::NameContext, QString( "%1" ).arg( id ), QString( name ).replace( ";", " " ).toUtf8().constData());
-                                this->readName( name, id );
-                                return true;
-                            }
-                        }
-                    }
-                }
-            }
+        const QString name( StructurePrefetcher::parseName( data ));
+        if ( !name.isEmpty()) {
+            Cache::instance()->insert( Cache::NameContext, QString( "%1" ).arg( id ), QString( name ).replace( ";", " " ).toUtf8().constData());
+            this->readName( name, id );
+            return true;
         }
     }
 
@@ -344,6 +359,33 @@ void StructureFragment::replyReceived( const QString &, NetworkManager::Types ty
     }
 }
 
+/**
+ * @brief StructureFragment::prefetched finishes loading of the current id if it was waiting for the prefetcher
+ * @param id
+ */
+void StructureFragment::prefetched( int id ) {
+    if ( this->cid() != id || id <= 0 )
+        return;
+
+    // get formula from prefetcher, cache or network (if prefetch failed)
+    if ( this->status().testFlag( FetchFormula ) && !this->prefetcher->isFormulaPending( id )) {
+        if ( this->prefetcher->contains( id ))
+            this->setFormula( QPixmap::fromImage( this->prefetcher->image( id )), id );
+        else if ( Cache::instance()->contains( Cache::FormulaContext, QString( "%1.png" ).arg( id )))
+            this->readFormula( Cache::instance()->getData( Cache::FormulaContext, QString( "%1.png" ).arg( id )), id );
+        else
+            this->sendFormulaRequest();
+    }
+
+    // get name from cache or network (if prefetch failed)
+    if ( this->status().testFlag( FetchName ) && !this->prefetcher->isNamePending( id )) {
+        if ( Cache::instance()->contains( Cache::NameContext, QString( "%1" ).arg( id )))
+            this->readName( Cache::instance()->getData( Cache::NameContext, QString( "%1" ).arg( id )), id );
+        else
+            this->sendNameRequest();
+    }
+}
+
 /**
  * @brief StructureFragment::validate
  */
@@ -388,6 +430,10 @@ void StructureFragment::setup( const QList<int> &list ) {
 
     // check list of ids provided by the search fragment
     this->cidList = list;
+    this->prefetcher->setCids( list );
+    this->thumbnails->setCids( list );
+    this->ui->actionGrid->setChecked( false );
+    this->ui->actionGrid->setVisible( this->cidList.count() > 1 );
     if ( this->cidList.isEmpty())
         return;
 
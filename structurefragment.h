@@ -24,6 +24,8 @@
 #include "fragment.h"
 #include "networkmanager.h"
 #include "extractiondialog.h"
+#include "structureprefetcher.h"
+#include "thumbnailmodel.h"
 
 /**
  * @brief The Ui namespace
@@ -79,6 +81,8 @@ private slots:
     void sendFormulaRequest();
     void sendNameRequest();
     void readFormula( const QByteArray &data, const int id );
+    void setFormula( const QPixmap &pixmap, const int id );
+    void prefetched( int id );
     void readName( const QString &queryName, const int id );
     bool parseFormulaRequest( const QByteArray &data, const int id );
     bool parseNameRequest( const QByteArray &data, const int id );
@@ -101,6 +105,8 @@ private:
     [[nodiscard]] int index() const { return this->m_index; }
 
     Ui::StructureFragment *ui;
+    StructurePrefetcher *prefetcher;
+    ThumbnailModel *thumbnails;
     QList<int> cidList;
     int m_index = 0;
     Status m_status = Idle;
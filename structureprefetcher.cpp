@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "structureprefetcher.h"
+#include "imageutils.h"
+#include "variable.h"
+#include "variablehandle.h"
+#include "cache.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QThread>
+
+/**
+ * @brief StructureTask::run
+ */
+void StructureTask::run() {
+    // abort if search has changed while task was queued
+    if ( this->counter->load() != this->generation )
+        return;
+
+    const QImage image( StructurePrefetcher::process( this->data, this->darkMode ));
+    if ( this->counter->load() != this->generation )
+        return;
+
+    // NOTE: target must implement processed( int, int, QImage ) slot
+    QMetaObject::invokeMethod( this->target, "processed", Qt::QueuedConnection,
+                               Q_ARG( int, this->cid ),
+                               Q_ARG( int, this->generation ),
+                               Q_ARG( QImage, image ));
+}
+
+/**
+ * @brief StructurePrefetcher::StructurePrefetcher
+ * @param parent
+ */
+StructurePrefetcher::StructurePrefetcher( QObject *parent ) : QObject( parent ) {
+    // leave enough threads for the rest of the application
+    this->pool.setMaxThreadCount( qMax( 1, QThread::idealThreadCount() / 2 ));
+
+    StructurePrefetcher::connect( NetworkManager::instance(), &NetworkManager::finished, this, &StructurePrefetcher::replyReceived );
+    StructurePrefetcher::connect( NetworkManager::instance(), &NetworkManager::error, this, &StructurePrefetcher::error );
+}
+
+/**
+ * @brief StructurePrefetcher::~StructurePrefetcher
+ */
+StructurePrefetcher::~StructurePrefetcher() {
+    StructurePrefetcher::disconnect( NetworkManager::instance(), &NetworkManager::finished, this, &StructurePrefetcher::replyReceived );
+    StructurePrefetcher::disconnect( NetworkManager::instance(), &NetworkManager::error, this, &StructurePrefetcher::error );
+
+    // tasks reference this object, so they must finish first
+    this->cancel();
+    this->pool.waitForDone();
+}
+
+/**
+ * @brief StructurePrefetcher::process decodes a structure, crops it and removes background
+ * @param data png data
+ * @param darkMode invert colours
+ * @return
+ */
+QImage StructurePrefetcher::process( const QByteArray &data, bool darkMode ) {
+    QImage image;
+    if ( !image.loadFromData( data ) || image.isNull())
+        return QImage();
+
+    // NOTE: same as PixmapUtils::cropAndRemoveAlpha, but QPixmap cannot be used outside the GUI thread
+    QImage out( ImageUtils::colourToAlpha( ImageUtils::autoCrop( qAsConst( image ), true ), QColor::fromRgb( 245, 245, 245, 255 )));
+    if ( darkMode )
+        out.invertPixels();
+
+    return out;
+}
+
+/**
+ * @brief StructurePrefetcher::parseName extracts compound title from a PubChem description reply
+ * @param data
+ * @return
+ */
+QString StructurePrefetcher::parseName( const QByteArray &data ) {
+    const QJsonDocument document( QJsonDocument::fromJson( data ));
+    const QJsonValue value( document.isArray() ? QJsonValue( document.array()) : document.object());
+    if ( !value.isObject())
+        return QString();
+
+    const QJsonValue infoValue( value.toObject()["InformationList"].toObject()["Information"] );
+    if ( !infoValue.isArray())
+        return QString();
+
+    const QJsonArray infoArray( infoValue.toArray());
+    for ( const QJsonValue &val : infoArray ) {
+        const QString name( val.toObject()["Title"].toString());
+        if ( !name.isEmpty())
+            return name;
+    }
+
+    return QString();
+}
+
+/**
+ * @brief StructurePrefetcher::setCids starts browsing a new list of ids
+ * @param list
+ */
+void StructurePrefetcher::setCids( const QList<int> &list ) {
+    this->cancel();
+    this->cidList = list;
+}
+
+/**
+ * @brief StructurePrefetcher::prefetch fetches the next and previous structures around the given index
+ * @param index
+ */
+void StructurePrefetcher::prefetch( int index ) {
+    if ( index < 0 || index >= this->cidList.count())
+        return;
+
+    // processed and queued structures are no longer valid if theme has changed
+    const bool darkMode = Variable_::DarkMode.value();
+    if ( darkMode != this->darkMode ) {
+        this->darkMode = darkMode;
+        this->generation.ref();
+        this->pool.clear();
+        this->pendingFormulas.clear();
+        this->images.clear();
+
+        // raw data is cached, so structures are simply reprocessed
+        NetworkManager::instance()->abort( NetworkManager::FormulaRequestPrefetch );
+    }
+
+    // drop structures that have moved far out of the window
+    const QList<int> cids( this->images.keys());
+    for ( const int cid : cids ) {
+        if ( qAbs( this->cidList.indexOf( cid ) - index ) > StructurePrefetcher::LookAhead * 2 )
+            this->images.remove( cid );
+    }
+
+    // NOTE: current id is fetched by the fragment itself, so start with the closest neighbours
+    for ( int offset = 1; offset <= StructurePrefetcher::LookAhead; offset++ ) {
+        for ( const int y : { index + offset, index - offset } ) {
+            if ( y < 0 || y >= this->cidList.count())
+                continue;
+
+            const int cid = this->cidList.at( y );
+
+            // get name
+            if ( !this->pendingNames.contains( cid ) && !Cache::instance()->contains( Cache::NameContext, QString( "%1" ).arg( cid ))) {
+                this->pendingNames << cid;
+                NetworkManager::instance()->execute( QString( "https://pubchem.ncbi.nlm.nih.gov/rest/pug/compound/cid/%1/description/JSON" ).arg( cid ), NetworkManager::NameRequestPrefetch, cid );
+            }
+
+            // get formula
+            if ( this->images.contains( cid ) || this->pendingFormulas.contains( cid ))
+                continue;
+
+            this->pendingFormulas << cid;
+            if ( Cache::instance()->contains( Cache::FormulaContext, QString( "%1.png" ).arg( cid )))
+                this->schedule( cid, Cache::instance()->getData( Cache::FormulaContext, QString( "%1.png" ).arg( cid )));
+            else
+                NetworkManager::instance()->execute( QString( "https://pubchem.ncbi.nlm.nih.gov/rest/pug/compound/cid/%1/PNG" ).arg( cid ), NetworkManager::FormulaRequestPrefetch, cid );
+        }
+    }
+}
+
+/**
+ * @brief StructurePrefetcher::cancel aborts all outstanding requests and processing
+ */
+void StructurePrefetcher::cancel() {
+    this->generation.ref();
+    this->pool.clear();
+    this->pendingFormulas.clear();
+    this->pendingNames.clear();
+    this->images.clear();
+
+    NetworkManager::instance()->abort( NetworkManager::FormulaRequestPrefetch );
+    NetworkManager::instance()->abort( NetworkManager::NameRequestPrefetch );
+}
+
+/**
+ * @brief StructurePrefetcher::schedule queues structure processing on a worker thread
+ * @param cid
+ * @param data
+ */
+void StructurePrefetcher::schedule( int cid, const QByteArray &data ) {
+    this->pool.start( new StructureTask( this, this->generation.load(), &this->generation, cid, data, this->darkMode ));
+}
+
+/**
+ * @brief StructurePrefetcher::replyReceived
+ * @param type
+ * @param userData
+ * @param data
+ */
+void StructurePrefetcher::replyReceived( const QString &, NetworkManager::Types type, const QVariant &userData, const QByteArray &data ) {
+    const int cid = userData.toInt();
+
+    switch ( type ) {
+    case NetworkManager::NameRequestPrefetch:
+    {
+        if ( !this->pendingNames.remove( cid ))
+            return;
+
+        const QString name( StructurePrefetcher::parseName( data ));
+        if ( !name.isEmpty())
+            Cache::instance()->insert( Cache::NameContext, QString( "%1" ).arg( cid ), QString( name ).replace( ";", " " ).toUtf8().constData());
+
+        emit this->prefetched( cid );
+    }
+        break;
+
+    case NetworkManager::FormulaRequestPrefetch:
+        if ( !this->pendingFormulas.contains( cid ))
+            return;
+
+        if ( data.isEmpty()) {
+            this->pendingFormulas.remove( cid );
+            emit this->prefetched( cid );
+            return;
+        }
+
+        Cache::instance()->insert( Cache::FormulaContext, QString( "%1.png" ).arg( cid ), data );
+        this->schedule( cid, data );
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief StructurePrefetcher::error
+ * @param type
+ * @param userData
+ */
+void StructurePrefetcher::error( const QString &, NetworkManager::Types type, const QVariant &userData, const QString & ) {
+    const int cid = userData.toInt();
+
+    if (( type == NetworkManager::NameRequestPrefetch && this->pendingNames.remove( cid )) ||
+        ( type == NetworkManager::FormulaRequestPrefetch && this->pendingFormulas.remove( cid )))
+        emit this->prefetched( cid );
+}
+
+/**
+ * @brief StructurePrefetcher::processed receives processed structures from worker threads
+ * @param cid
+ * @param generation
+ * @param image
+ */
+void StructurePrefetcher::processed( int cid, int generation, const QImage &image ) {
+    if ( generation != this->generation.load() || !this->pendingFormulas.remove( cid ))
+        return;
+
+    if ( !image.isNull())
+        this->images[cid] = image;
+
+    emit this->prefetched( cid );
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QAtomicInt>
+#include <QHash>
+#include <QImage>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+#include "networkmanager.h"
+
+/**
+ * @brief The StructureTask class crops, keys and inverts a structure on a worker thread
+ */
+class StructureTask final : public QRunnable {
+public:
+    /**
+     * @brief StructureTask
+     * @param target receiver of the processed image
+     * @param generation current generation of the target
+     * @param counter generation counter of the target (checked before delivering results)
+     * @param cid
+     * @param data
+     * @param darkMode
+     */
+    StructureTask( QObject *target, int generation, const QAtomicInt *counter, int cid, const QByteArray &data, bool darkMode ) :
+        target( target ), generation( generation ), counter( counter ), cid( cid ), data( data ), darkMode( darkMode ) {}
+    void run() override;
+
+private:
+    QObject *target;
+    int generation;
+    const QAtomicInt *counter;
+    int cid;
+    QByteArray data;
+    bool darkMode;
+};
+
+/**
+ * @brief The StructurePrefetcher class fetches and pre-processes structures around the current position of a cid list
+ */
+class StructurePrefetcher final : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( StructurePrefetcher )
+
+public:
+    explicit StructurePrefetcher( QObject *parent = nullptr );
+
+    // disable move
+    StructurePrefetcher( StructurePrefetcher&& ) = delete;
+    StructurePrefetcher& operator=( StructurePrefetcher&& ) = delete;
+
+    ~StructurePrefetcher() override;
+
+    /**
+     * @brief contains returns true if structure of the given cid has been processed
+     * @param cid
+     * @return
+     */
+    [[nodiscard]] bool contains( int cid ) const { return this->images.contains( cid ); }
+
+    /**
+     * @brief image returns processed (cropped, keyed and inverted if needed) structure
+     * @param cid
+     * @return
+     */
+    [[nodiscard]] QImage image( int cid ) const { return this->images.value( cid ); }
+
+    /**
+     * @brief isFormulaPending returns true if structure of the given cid is being fetched or processed
+     * @param cid
+     * @return
+     */
+    [[nodiscard]] bool isFormulaPending( int cid ) const { return this->pendingFormulas.contains( cid ); }
+
+    /**
+     * @brief isNamePending returns true if name of the given cid is being fetched
+     * @param cid
+     * @return
+     */
+    [[nodiscard]] bool isNamePending( int cid ) const { return this->pendingNames.contains( cid ); }
+    [[nodiscard]] static QImage process( const QByteArray &data, bool darkMode );
+    [[nodiscard]] static QString parseName( const QByteArray &data );
+    static constexpr const int LookAhead = 3;
+
+signals:
+    void prefetched( int cid );
+
+public slots:
+    void setCids( const QList<int> &list );
+    void prefetch( int index );
+    void cancel();
+
+private slots:
+    void replyReceived( const QString &, NetworkManager::Types type, const QVariant &userData, const QByteArray &data );
+    void error( const QString &, NetworkManager::Types type, const QVariant &userData, const QString & );
+    void processed( int cid, int generation, const QImage &image );
+
+private:
+    void schedule( int cid, const QByteArray &data );
+
+    QList<int> cidList;
+    QSet<int> pendingFormulas;
+    QSet<int> pendingNames;
+    QHash<int, QImage> images;
+    QThreadPool pool;
+    QAtomicInt generation;
+    bool darkMode = false;
+};
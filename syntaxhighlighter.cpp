@@ -24,6 +24,7 @@
 #include "tag.h"
 #include "variable.h"
 #include <QSqlQuery>
+#include "querytracer.h"
 #include <QApplication>
 #include <utility>
 #include "mainwindow.h"
@@ -35,10 +36,12 @@
 SyntaxHighlighter::SyntaxHighlighter( QTextDocument *parent ) : QSyntaxHighlighter( parent ) {
     QSqlQuery query;
 
-    query.exec( QString( "select %1, %2 from %3 where %2 not null" )
+    if ( !QueryTracer::exec( query, QString( "select %1, %2 from %3 where %2 not null" )
                         .arg( Tag::instance()->fieldName( Tag::ID ),
                               Tag::instance()->fieldName( Tag::Function ),
-                              Tag::instance()->tableName()));
+                              Tag::instance()->tableName()), "syntaxHighlighter" ))
+        return;
+
     while ( query.next())
         this->keywords << qAsConst( query ).value( 1 ).toString();
 }
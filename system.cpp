@@ -27,8 +27,11 @@
 #include "label.h"
 #include "tableentry.h"
 #include "variable.h"
+#include "startupprofiler.h"
+#include "querytracer.h"
 #include <QDebug>
 #include <QFile>
+#include <QJsonDocument>
 #include <QRegularExpression>
 #include <QMessageBox>
 #include <QSqlQuery>
@@ -70,8 +73,12 @@ void System::dbInfo() {
     int reagents = 0, properties = 0;
 
     // avoid filters
-    QSqlQuery queryR( "select count(*) from " + Reagent::instance()->tableName()); queryR.exec(); if ( queryR.next()) reagents = queryR.value( 0 ).toInt();
-    QSqlQuery queryP( "select count(*) from " + Property::instance()->tableName()); queryP.exec(); if ( queryP.next()) properties = queryP.value( 0 ).toInt();
+    QSqlQuery query;
+    if ( QueryTracer::exec( query, "select count(*) from " + Reagent::instance()->tableName(), "system" ) && query.next())
+        reagents = query.value( 0 ).toInt();
+
+    if ( QueryTracer::exec( query, "select count(*) from " + Property::instance()->tableName(), "system" ) && query.next())
+        properties = query.value( 0 ).toInt();
 
     const QString string( QString( "Reagents: %1\nProperties: %2\nLabels: %3\nTables: %4\nPath: %5" )
                           .arg( reagents ).arg( properties ).arg( Label::instance()->count()).arg( TableEntry::instance()->count()).arg( Variable::string( "databasePath" )));
@@ -80,6 +87,37 @@ void System::dbInfo() {
     QMessageBox::information( MainWindow::instance(), System::tr( "Database info" ), string );
 }
 
+/**
+ * @brief System::startupInfo displays time spent in each phase of startup
+ */
+void System::startupInfo() {
+    QMessageBox::information( MainWindow::instance(), System::tr( "Startup info" ), StartupProfiler::instance()->report());
+}
+
+/**
+ * @brief System::queryInfo displays the most expensive query templates of this session
+ */
+void System::queryInfo() {
+    QMessageBox box( QMessageBox::Information, System::tr( "Query info" ), QueryTracer::instance()->report( 5 ), QMessageBox::Ok, MainWindow::instance());
+    box.setDetailedText( QueryTracer::instance()->report( 100 ));
+    box.exec();
+}
+
+/**
+ * @brief System::dumpQueries writes query statistics and recent traces to a JSON file
+ * @param fileName
+ * @return
+ */
+bool System::dumpQueries( const QString &fileName ) {
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ))
+        return false;
+
+    file.write( QJsonDocument( QueryTracer::instance()->toJson()).toJson());
+    file.close();
+    return true;
+}
+
 /**
  * @brief System::clearCommandHistory
  */
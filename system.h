@@ -34,6 +34,9 @@ public:
     Q_INVOKABLE void print( const QString &message );
     Q_INVOKABLE void replaceGreeting();
     Q_INVOKABLE void dbInfo();
+    Q_INVOKABLE void startupInfo();
+    Q_INVOKABLE void queryInfo();
+    Q_INVOKABLE bool dumpQueries( const QString &fileName );
     Q_INVOKABLE void clearCommandHistory();
     Q_INVOKABLE void printVariableValue( const QString &key );
 };
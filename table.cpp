@@ -23,7 +23,9 @@
 #include "table.h"
 #include "database.h"
 #include "field.h"
+#include "querytracer.h"
 #include <QDebug>
+#include <QSqlError>
 #include <QSqlQuery>
 
 /**
@@ -31,7 +33,11 @@
  * @return
  */
 int Table::count() const {
-    return Database::instance()->hasInitialised() ? this->rowCount() : 0;
+    if ( !Database::instance()->hasInitialised())
+        return 0;
+
+    this->load();
+    return this->rowCount();
 }
 
 /**
@@ -73,11 +79,11 @@ QVariant Table::value( const Id &id, int fieldId ) const {
         return -1;
 
     QSqlQuery query;
-    query.exec( QString( "select %1, %2 from %3 where %1=%4" )
+    QueryTracer::exec( query, QString( "select %1, %2 from %3 where %1=%4" )
                         .arg( this->fieldName( this->primaryField()->id()),
                               this->fieldName( fieldId ),
                               this->tableName(),
-                              QString::number( static_cast<int>( id ))));
+                              QString::number( static_cast<int>( id ))), "table" );
 
     return query.next() ? query.value( 1 ) : "";
 }
@@ -87,12 +93,15 @@ QVariant Table::value( const Id &id, int fieldId ) const {
  * @return
  */
 bool Table::select() {
+    QueryTrace trace( this->selectStatement(), "select" );
     const bool result = QSqlTableModel::select();
+    this->m_loaded = true;
 
     // fetch more
     while ( this->canFetchMore())
         this->fetchMore();
 
+    trace.setRows( this->rowCount());
     return result;
 }
 
@@ -102,6 +111,7 @@ bool Table::select() {
  * @return
  */
 Row Table::row( const Id &id ) const {
+    this->load();
     const QModelIndexList list(
             this->match( this->index( 0, 0 ), IDRole, static_cast<int>( id ), 1, Qt::MatchExactly ));
     return this->row( list.isEmpty() ? QModelIndex() : list.first());
@@ -115,6 +125,16 @@ void Table::addUniqueConstraint( const QList<QSharedPointer<Field_>> &constraine
     this->constraints << constrainedFields;
 }
 
+/**
+ * @brief Table::addForeignKey deletes entries along with the entry of the parent table they reference
+ * @param field
+ * @param parent
+ * @param sentinels field may hold negative ids that are not in the parent table
+ */
+void Table::addForeignKey( const QSharedPointer<Field_> &field, const Table *parent, bool sentinels ) {
+    this->foreignKeys << ForeignKey { field, parent, sentinels };
+}
+
 /**
  * @brief Table::data
  * @param index
@@ -250,9 +270,27 @@ Row Table::add( const QVariantList &arguments ) {
             this->m_hasPrimary = true;
     }
 
-    this->submit();
+    // NOTE: last_insert_rowid would otherwise return id of an earlier insert
+    if ( !this->submit()) {
+        qCCritical( Database_::Debug ) << Table::tr( "cannot submit row to table \"%1\", reason - \"%2\"" ).arg( this->tableName(), this->lastError().text());
+        this->revert();
+        this->endInsertRows();
+        return Row::Invalid;
+    }
     this->endInsertRows();
+
+    // get id of the newly inserted entry (sqlite-specific)
+    QSqlQuery query;
+    QueryTracer::exec( query, "select last_insert_rowid()", "table" );
+    const Id id = query.next() ? query.value( 0 ).value<Id>() : Id::Invalid;
+
     this->select();
+    this->m_generation++;
+
+    // notify listeners (indexes) about the new entry
+    if ( this->hasPrimaryField() && id != Id::Invalid )
+        emit this->entryAdded( id );
+
     return this->row( row );
 }
 
@@ -329,8 +367,44 @@ void Table::remove( const Row &row ) {
     if ( !this->isValid() || row == Row::Invalid )
         return;
 
-    this->removeRow( static_cast<int>( row ));
+    const Id id = this->hasPrimaryField() ? this->value( row, this->primaryField()->id()).value<Id>() : Id::Invalid;
+    if ( this->hasPrimaryField())
+        emit this->entryAboutToBeRemoved( id );
+
+    const bool success = this->removeRow( static_cast<int>( row ));
+    this->select();
+    this->m_generation++;
+
+    if ( success && this->hasPrimaryField())
+        emit this->entryRemoved( id );
+}
+
+/**
+ * @brief Table::remove removes multiple entries with a single query and reselects the table once
+ * @param ids
+ */
+void Table::remove( const QList<Id> &ids ) {
+    if ( !this->isValid() || !this->hasPrimaryField() || ids.isEmpty())
+        return;
+
+    QStringList list;
+    for ( const Id &id : ids ) {
+        emit this->entryAboutToBeRemoved( id );
+        list << QString::number( static_cast<int>( id ));
+    }
+
+    // NOTE: dependent entries are removed by sqlite through foreign keys
+    QSqlQuery query;
+    const bool success = QueryTracer::exec( query, QString( "delete from %1 where %2 in ( %3 )" )
+                                            .arg( this->tableName(), this->primaryField()->name(), list.join( ", " )), "table" );
+
     this->select();
+    this->m_generation++;
+
+    if ( success ) {
+        for ( const Id &id : ids )
+            emit this->entryRemoved( id );
+    }
 }
 
 /**
@@ -342,8 +416,64 @@ void Table::setValue( const Row &row, int fieldId, const QVariant &value ) {
     if ( !this->isValid() || row == Row::Invalid )
         return;
 
+    // bump revision so that views can invalidate their cached representations
+    const Id id = this->hasPrimaryField() ? this->value( row, this->primaryField()->id()).value<Id>() : Id::Invalid;
+    if ( this->hasPrimaryField())
+        this->revisions[id]++;
+    this->m_generation++;
+
     this->setData( this->index( static_cast<int>( row ), fieldId ), value );
     this->submit();
+
+    if ( this->hasPrimaryField())
+        emit this->entryChanged( id, fieldId );
+}
+
+/**
+ * @brief Table::applyUpdate reselects a single entry that has been modified by another instance
+ * @param id
+ * @param fieldId
+ */
+void Table::applyUpdate( const Id &id, int fieldId ) {
+    const Row row = this->row( id );
+    if ( !this->isValid() || row == Row::Invalid )
+        return;
+
+    this->revisions[id]++;
+    this->m_generation++;
+    this->selectRow( static_cast<int>( row ));
+    emit this->entryChanged( id, fieldId );
+}
+
+/**
+ * @brief Table::applyChanges selects entries that have been added or removed by another instance
+ * (table is reselected once for all of them)
+ * @param inserted
+ * @param removed
+ */
+void Table::applyChanges( const QList<Id> &inserted, const QList<Id> &removed ) {
+    if ( !this->isValid() || ( inserted.isEmpty() && removed.isEmpty()))
+        return;
+
+    QList<Id> present;
+    for ( const Id &id : removed ) {
+        if ( this->row( id ) == Row::Invalid )
+            continue;
+
+        emit this->entryAboutToBeRemoved( id );
+        present << id;
+    }
+
+    this->select();
+    this->m_generation++;
+
+    for ( const Id &id : qAsConst( present ))
+        emit this->entryRemoved( id );
+
+    for ( const Id &id : inserted ) {
+        if ( this->row( id ) != Row::Invalid )
+            emit this->entryAdded( id );
+    }
 }
 
 /**
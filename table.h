@@ -24,6 +24,7 @@
 #include <QSqlRelationalTableModel>
 #include <QSharedPointer>
 #include <QSqlRecord>
+#include <QHash>
 
 //
 // classes
@@ -41,6 +42,14 @@ enum class Id : int {
 QDebug operator<<( QDebug debug, const Id &id );
 using _Id = Id;
 
+/**
+ * @brief qHash allows strong-typed ids to be used in QHash and QSet
+ * @param id
+ * @param seed
+ * @return
+ */
+inline uint qHash( const Id &id, uint seed = 0 ) { return ::qHash( static_cast<int>( id ), seed ); }
+
 Q_DECLARE_METATYPE( Id )
 
 /**
@@ -119,6 +128,17 @@ public:
     }
     bool select() override;
 
+    /**
+     * @brief isLoaded returns false if a lazy table has not been selected yet
+     * @return
+     */
+    [[nodiscard]] bool isLoaded() const { return this->m_loaded; }
+
+    /**
+     * @brief load selects a lazy table on first use
+     */
+    void load() const { if ( !this->isLoaded()) const_cast<Table *>( this )->select(); }
+
     /**
      * @brief primaryField
      * @return
@@ -149,7 +169,21 @@ public:
     }
     [[nodiscard]] Row row( const Id &id ) const;
 
+    /**
+     * @brief revision returns a counter that is bumped every time an entry is modified
+     * @param id
+     * @return
+     */
+    [[nodiscard]] int revision( const Id &id ) const { return this->revisions.value( id, 0 ); }
+
+    /**
+     * @brief generation returns a counter that is bumped every time a row is added, removed or modified
+     * @return
+     */
+    [[nodiscard]] int generation() const { return this->m_generation; }
+
     [[maybe_unused]] void addUniqueConstraint( const QList<QSharedPointer<Field_>> &constrainedFields );
+    void addForeignKey( const QSharedPointer<Field_> &field, const Table *parent, bool sentinels = false );
     [[maybe_unused]][[nodiscard]] QSqlQuery prepare() const;
     [[maybe_unused]] void bind( QSqlQuery &query, const QVariantList &arguments );
 
@@ -163,23 +197,65 @@ public slots:
                    const QString &format = QString( "text" ), bool unique = false, bool autoValue = false );
     Row add( const QVariantList &arguments );
     virtual void remove( const Row &row );
+    void remove( const QList<Id> &ids );
     void setValue( const Row &row, int fieldId, const QVariant &value );
 
+    // changes made to the database by other instances
+    void applyChanges( const QList<Id> &inserted, const QList<Id> &removed );
+    void applyUpdate( const Id &id, int fieldId );
+
+    /**
+     * @brief reload reselects the whole table after it has been modified elsewhere
+     */
+    virtual void reload() { this->select(); this->invalidate(); }
+
     /**
      * @brief removeOrphanedEntries
      */
     virtual void removeOrphanedEntries() {}
 
+signals:
+    void entryAdded( const Id &id );
+    void entryAboutToBeRemoved( const Id &id );
+    void entryRemoved( const Id &id );
+    void entryChanged( const Id &id, int fieldId );
+    void invalidated();
+    void orphansRemoved();
+
 protected:
+    /**
+     * @brief invalidate must be called after entries are modified through raw queries
+     */
+    void invalidate() { this->m_generation++; emit this->invalidated(); }
+
+    /**
+     * @brief invalidateOrphans must be called after dependent entries have been removed by sqlite through foreign keys
+     */
+    void invalidateOrphans() { this->m_generation++; emit this->orphansRemoved(); }
+
     QMap<int, QSharedPointer<Field_>> fields;
     [[nodiscard]] QSharedPointer<Field_> field( int id ) const;
     [[nodiscard]] bool contains( const QSharedPointer<Field_> &field, const QVariant &value ) const;
 
 private:
     bool m_valid = false;
+    bool m_loaded = true;
     bool m_hasPrimary = false;
     QSharedPointer<Field_> m_primaryField;
     QList<QList<QSharedPointer<Field_>>> constraints;
+
+    /**
+     * @brief The ForeignKey struct (sentinel keys may hold negative ids that are not in the parent table,
+     * so they are cascaded with triggers instead of foreign key constraints)
+     */
+    struct ForeignKey {
+        QSharedPointer<Field_> field;
+        const Table *parent;
+        bool sentinels;
+    };
+    QList<ForeignKey> foreignKeys;
+    QHash<Id, int> revisions;
+    int m_generation = 0;
 };
 
 // declare enums
@@ -25,9 +25,12 @@
 #include "tag.h"
 #include "tableproperty.h"
 #include "tableviewer.h"
+#include "database.h"
+#include "querytracer.h"
 #include <QMessageBox>
 #include <QDebug>
 #include <QSqlQuery>
+#include <QSqlError>
 #include <QCheckBox>
 
 //
@@ -44,6 +47,7 @@
 TableDialog::TableDialog( QWidget *parent ) : QDialog( parent ), ui( new Ui::TableDialog ) {
     this->ui->setupUi( this );
     this->ui->widget->setWindowFlags( Qt::Widget );
+    TableEntry::instance()->load();
     this->ui->tableView->setModel( TableEntry::instance());
     this->ui->tableView->setModelColumn( TableEntry::Name );
     this->ui->dockWidget->close();
@@ -112,10 +116,14 @@ TableDialog::TableDialog( QWidget *parent ) : QDialog( parent ), ui( new Ui::Tab
                 if ( id == Id::Invalid )
                     return;
 
-                QSqlQuery().exec( QString( "delete from %1 where %2=%3" )
-                                          .arg( TableProperty::instance()->tableName(),
-                                                TableProperty::instance()->fieldName( TableProperty::TableId ),
-                                                QString::number( static_cast<int>( id ))));
+                QSqlQuery query;
+                if ( !QueryTracer::exec( query, QString( "delete from %1 where %2=%3" )
+                                         .arg( TableProperty::instance()->tableName(),
+                                               TableProperty::instance()->fieldName( TableProperty::TableId ),
+                                               QString::number( static_cast<int>( id ))), "tableDialog" )) {
+                    qCWarning( Database_::Debug ) << TableDialog::tr( "could not clear table properties, reason - \"%1\"" ).arg( query.lastError().text());
+                    return;
+                }
                 saveState( id );
             } else if ( this->mode() == Add ) {
                 const Row row = TableEntry::instance()->add( this->ui->nameEdit->text(), static_cast<TableEntry::Modes>( this->ui->modeCombo->currentIndex()));
@@ -250,14 +258,15 @@ void TableDialog::populate() {
 
                 // find all TableProperty entries matching tableId
                 QSqlQuery query;
-                query.exec( QString( "select %1, %2 from %3 where %4=%5 order by %6" )
+                if ( !QueryTracer::exec( query, QString( "select %1, %2 from %3 where %4=%5 order by %6" )
                             .arg( TableProperty::instance()->fieldName( TableProperty::TagId ),
                                   TableProperty::instance()->fieldName( TableProperty::Tab ),
                                   TableProperty::instance()->tableName(),
                                   TableProperty::instance()->fieldName( TableProperty::TableId ),
                                   QString::number( static_cast<int>( tableId )),
                                   TableProperty::instance()->fieldName( TableProperty::TableOrder )
-                                  ));
+                                  ), "tableDialog" ))
+                    qCWarning( Database_::Debug ) << TableDialog::tr( "could not read table properties, reason - \"%1\"" ).arg( query.lastError().text());
 
                 // store them in an unordered map (for now)
                 while ( query.next()) {
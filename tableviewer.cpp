@@ -26,11 +26,8 @@
 #include "property.h"
 #include "htmlutils.h"
 #include "tag.h"
-#include "ghswidget.h"
-#include "nfpawidget.h"
 #include "reagentdelegate.h"
 #include "tableentry.h"
-#include <QSqlQuery>
 #include <QDebug>
 #include <QScrollBar>
 #include <QScreen>
@@ -54,94 +51,86 @@ TableViewer::TableViewer( QWidget *parent, const Id &tableId ) : QDialog( parent
     if ( tableId == Id::Invalid )
         return;
 
-    //
-    // step one: get selected tags
-    //
-    QList<Id> tagIds;
-    Id tabId = Id::Invalid;
-
     // name column uses ReagentDelegate
     this->reagentDelegate = new ReagentDelegate();
     this->reagentDelegate->setViewMode();
     this->ui->tableView->setItemDelegateForColumn( 0, this->reagentDelegate );
 
-    // find all TableProperty entries matching tableId
-    QSqlQuery query;
-    query.exec( QString( "select %1, %2 from %3 where %4=%5 order by %6" )
-                .arg( TableProperty::instance()->fieldName( TableProperty::TagId ),
-                      TableProperty::instance()->fieldName( TableProperty::Tab ),
-                      TableProperty::instance()->tableName(),
-                      TableProperty::instance()->fieldName( TableProperty::TableId ),
-                      QString::number( static_cast<int>( tableId )),
-                      TableProperty::instance()->fieldName( TableProperty::TableOrder )
-                      ));
-
-    // store selected tagIds them in a list
-    // also store the selected tabId for use in a horizonatal tab filter
-    while ( query.next()) {
-        const Id id = query.value( 0 ).value<Id>();
-        const bool tabbed = query.value( 1 ).toBool();
-
-        if ( !tabbed )
-            tagIds << id;
-        else
-            tabId = id;
-    }
-
-    // retrieve corresponding unique properties where tagId=tabId
-    // for example:
-    //     tagName: "Location"
-    //     unique entries: "C1", "C2", "C3" + "Unsorted" (when values are missing)
-    //
-    // unique entries (or categories) are displayed as tabs in the QTabBar
-    // on tab change, select statement changes and table data is refreshed
-
     // property data is handled through the property delegate via special viewMode
     // NOTE: code is reused in PropertyDock and here
     this->propertyDelegate = new PropertyDelegate( this->ui->tableView );
     this->propertyDelegate->setViewMode();
 
-    if ( tabId == Id::Invalid ) {
-        // if we do not have a tabId set, there is no need for filtering
-        // just populate the table
-        this->ui->tabBar->hide();
-        this->populateTable( tagIds, this->filter());
+    // setup models
+    this->filterModel->setSourceModel( this->model );
+    this->ui->tableView->setModel( this->filterModel );
+    this->ui->tabBar->hide();
+
+    //
+    // step one: get an in-memory pivot of the selected tags (cached until properties are modified)
+    // NOTE: pivot is built on the database thread, so the dialog is set up once it is ready
+    //
+    this->setCursor( Qt::BusyCursor );
+    TableViewer::connect( &this->watcher, &QFutureWatcher<QSharedPointer<PivotTable>>::finished, this, &TableViewer::setup );
+    this->watcher.setFuture( PivotTable::fromTable( tableId ));
+}
+
+/**
+ * @brief TableViewer::~TableViewer
+ */
+TableViewer::~TableViewer() {
+    // stop waiting for the pivot (NOTE: the future is shared through the pivot cache, so it is
+    //       cancelled there, and only if no other viewer waits for it)
+    TableViewer::disconnect( &this->watcher, &QFutureWatcher<QSharedPointer<PivotTable>>::finished, this, &TableViewer::setup );
+    PivotTable::release( this->tableId, this->watcher.future());
+
+    delete this->reagentDelegate;
+    delete this->propertyDelegate;
+    delete this->model;
+    delete this->filterModel;
+    delete this->ui;
+}
+
+/**
+ * @brief TableViewer::setup sets up tabs and columns once the pivot has been built
+ */
+void TableViewer::setup() {
+    this->unsetCursor();
+
+    if ( this->watcher.isCanceled() || this->watcher.future().resultCount() == 0 )
+        return;
+
+    this->pivot = this->watcher.result();
+    const QList<Id> tagIds( this->pivot->tagIds());
+    const Id tabId = this->pivot->tabId();
+
+    // unique property values of tabId (for example, "Location": "C1", "C2", "C3" + "Unsorted")
+    // are displayed as tabs in the QTabBar; on tab change rows are picked from the pivot
+    this->propertyDelegate->setPrefetched( this->pivot->properties(), this->pivot->tagTypes());
+
+    // get unique categories to use as tabs
+    const QStringList categories( tabId == Id::Invalid ? QStringList() : this->pivot->categories());
+    if ( categories.isEmpty()) {
+        // if we do not have a tabId set (or a malformed filter returns zero categories),
+        // there is no need for filtering, just populate the table
+        this->populateTable( this->pivot->rows());
     } else {
         // setup tabBar
         this->ui->tabBar->setShape( QTabBar::RoundedSouth );
+        this->ui->tabBar->show();
 
-        // get unique categories to use as tabs
-        QStringList categories;
-        QSqlQuery query( QString( "select %1, count( %1 ) from %2 where %3=%4 group by %1 order by %1" ).arg(
-                             Property::instance()->fieldName( Property::PropertyData ), // 1
-                             Property::instance()->tableName(), // 2
-                             Property::instance()->fieldName( Property::TagId ), // 3
-                             QString::number( static_cast<int>( tabId )) // 4
-                             ));
-
-        // store them in a list
-        while ( query.next())
-            categories.append( query.value( 0 ).toString());
-
-        if ( categories.count() > 1 ) {
-            // add corresponding tabs
-            for ( const QString &category : qAsConst( categories ))
-                this->ui->tabBar->addTab( category );
-
-            // append 'unsorted' tab (for entries withou values)
-            this->ui->tabBar->addTab( TableViewer::tr( "Unsorted" ));
-
-            // connect tabBar for updates (click on a tab triggers setFilter which in turn repopulates the table)
-            QTabBar::connect( this->ui->tabBar, &QTabBar::currentChanged, this, [ this, tabId, tagIds ] { this->setFilter( tabId, tagIds ); } );
-
-            // populate with the first category
-            this->setFilter( tabId, tagIds );
-        } else {
-            // a malformed filter may return zero categories
-            // in this case populate the table without filtering it
-            this->ui->tabBar->hide();
-            this->populateTable( tagIds, this->filter());
-        }
+        // add corresponding tabs
+        for ( const QString &category : categories )
+            this->ui->tabBar->addTab( category );
+
+        // append 'unsorted' tab (for entries withou values)
+        this->ui->tabBar->addTab( TableViewer::tr( "Unsorted" ));
+
+        // connect tabBar for updates (click on a tab triggers setFilter which in turn repopulates the table)
+        QTabBar::connect( this->ui->tabBar, &QTabBar::currentChanged, this, [ this ] { this->setFilter(); } );
+
+        // populate with the first category
+        this->setFilter();
     }
 
     // set property delegate to columns with properties (1+)
@@ -152,26 +141,17 @@ TableViewer::TableViewer( QWidget *parent, const Id &tableId ) : QDialog( parent
     // refresh table on sort
     this->connect( this->ui->tableView->horizontalHeader(), &QHeaderView::sortIndicatorChanged, [ this ]( int, Qt::SortOrder ) {
         this->reagentDelegate->clearCache();
-        this->propertyDelegate->clearCache();
 
-        //this->ui->tableView->update();
         this->ui->tableView->resizeColumnsToContents();
         this->ui->tableView->resizeRowsToContents();
     } );
 
     // initial sort
     this->ui->tableView->sortByColumn( 0, Qt::AscendingOrder );
-}
 
-/**
- * @brief TableViewer::~TableViewer
- */
-TableViewer::~TableViewer() {
-    delete this->reagentDelegate;
-    delete this->propertyDelegate;
-    delete this->model;
-    delete this->filterModel;
-    delete this->ui;
+    // dialog may already be visible
+    if ( this->isVisible())
+        this->resizeToContents();
 }
 
 /**
@@ -180,7 +160,13 @@ TableViewer::~TableViewer() {
  */
 void TableViewer::showEvent( QShowEvent *event ) {
     QDialog::showEvent( event );
+    this->resizeToContents();
+}
 
+/**
+ * @brief TableViewer::resizeToContents
+ */
+void TableViewer::resizeToContents() {
     // get optimal dialog width
     // FIXME: magic number
     int width = 48;
@@ -211,138 +197,13 @@ void TableViewer::showEvent( QShowEvent *event ) {
 
 /**
  * @brief TableViewer::populateTable
+ * @param rows
  */
-void TableViewer::populateTable( const QList<Id> tagIds, const QString &filter ) {
+void TableViewer::populateTable( const QVector<int> &rows ) {
     this->reagentDelegate->clearCache();
-    this->propertyDelegate->clearCache();
-
-    //
-    // step one: run an sql query that returns [reagentId] [propertyId_0] ... [propertyId_N]
-    //
-    QString statement( QString( "with base_table as ( select %1.%2 as rid, " ).arg( Reagent::instance()->tableName(), Reagent::instance()->fieldName( Reagent::ID )));
-    int c = 0;
-    for ( c = 0; c < tagIds.count(); c++ )
-        statement.append( QString( " ifnull( t%1.id, -1 ) as c%1" ).arg( QString::number( c )) + QString(( c < tagIds.count() - 1 ? "," : "" )));
-
-    statement.append( QString( ", %1.%2 as pid " ).arg( Reagent::instance()->tableName(), Reagent::instance()->fieldName( Reagent::ParentId )));
-    statement.append( " from " + Reagent::instance()->tableName());
-
-    for ( c = 0; c < tagIds.count(); c++ ) {
-        statement.append( QString( " left join "
-                                   "( select %2, %3.%4 from %3 where %5=%6 ) "
-                                   "as t%1 "
-                                   "on t%1.%2=rid " )
-                          .arg( QString::number( c ), // 1
-                                Property::instance()->fieldName( Property::ReagentId ), // 2
-                                Property::instance()->tableName(), // 3
-                                Property::instance()->fieldName( Property::ID ), // 4
-                                Property::instance()->fieldName( Property::TagId ), // 5
-                                QString::number( static_cast<int>( tagIds.at( c ))) // 6
-                                )
-                          );
-    }
-
-    statement.append( " where " + filter );
-    for ( c = 0; c < tagIds.count(); c++ )
-        statement.append( QString( "c%1" ).arg( QString::number( c )) + QString(( c < tagIds.count() - 1 ? "+" : "" )));
-    statement.append( QString( "!=-%1" ).arg( QString::number( c )));
-
-    const TableEntry::Modes mode = TableEntry::instance()->mode( this->tableId );
-    if ( mode == TableEntry::Reagents )
-        statement.append( QString( " and %1.%2=-1 " ).arg( Reagent::instance()->tableName(), Reagent::instance()->fieldName( Reagent::ParentId )));
-
-    const QString orderClause( QString( " order by case when %1.%3=-1 then %1.%4 else %1.%3 end, %1.%4, %1.%2" )
-                               .arg( Reagent::instance()->tableName(), // 1
-                                     Reagent::instance()->fieldName( Reagent::Name ), // 2 NOTE: html names are not sorted correctly
-                                     Reagent::instance()->fieldName( Reagent::ParentId ), // 3
-                                     Reagent::instance()->fieldName( Reagent::ID ) // 4
-                               ));
-
-    statement.append( orderClause );
-
-    QStringList tags;
-    QStringList minusOnes;
-    for ( c = 0; c < tagIds.count(); c++ ) {
-        tags <<  QString( "c%1" ).arg( QString::number( c ));
-        minusOnes << "-1";
-    }
-
-    statement.append( QString( " ) select rid, %1 from base_table " ).arg( tags.join( ", " )));
-    statement.append( QString( "union select %2.%3 as rid_, %1 from %2 where " ).arg( minusOnes.join( ", " ), Reagent::instance()->tableName(), Reagent::instance()->fieldName( Reagent::ID )));
-    statement.append( "rid_ in ( select pid from base_table ) and rid_ not in ( select rid from base_table )" );
-
-    // DEBUG:
-    // qDebug() << statement;
-
-    // select name, id, parentId from reagent order by name, case when parentId=-1 then id else parentId end
-
-    //
-    // step two: visualize data, using QSqlQueryModel and QTableView
-    //
-    this->model->setQuery( QSqlQuery( statement ));
-    this->filterModel->setSourceModel( this->model );
-    this->ui->tableView->setModel( this->filterModel );
-    //this->ui->tableView->setModel( this->model );
-    this->ui->tableView->setSizeAdjustPolicy( QTableView::AdjustToContents );
 
-    // setup column names
-    this->model->setHeaderData( 0, Qt::Horizontal, TableViewer::tr( "Reagent" ));
-    for ( c = 0; c < tagIds.count(); c++ )
-        this->model->setHeaderData( c + 1, Qt::Horizontal, QApplication::translate( "Tag", Tag::instance()->name( tagIds.at( c )).toUtf8().constData()));
-
-    // setup index widgets (NFPA, GHS)
-    // NOTE: similar to PropertyDock::
-    for ( int r = 0; r < this->model->rowCount(); r++ ) {
-        for ( int c = 1; c < this->model->columnCount(); c++ ) {
-            const QModelIndex index( this->model->index( r, c ));
-
-            // handle the rest of columns, setting index widgets if needed
-            const Id propertyId = static_cast<Id>( index.data( Qt::DisplayRole ).value<Id>());
-            if ( propertyId == Id::Invalid )
-                continue;
-            const Id tagId = Property::instance()->tagId( propertyId );
-
-            bool pixmap = false;
-            if ( tagId != Id::Invalid )
-                pixmap = Tag::instance()->type( tagId ) == Tag::Formula || tagId == PixmapTag;
-
-            if ( tagId == Id::Invalid || pixmap )
-                continue;
-
-            const Tag::Types type = Tag::instance()->type( tagId );
-            if ( type == Tag::NFPA || type == Tag::GHS ) {
-                const QStringList parms( Property::instance()->propertyData( propertyId ).toString().split( " " ));
-                QWidget *widget( this->ui->tableView->indexWidget( index ));
-
-                if ( type == Tag::NFPA ) {
-                    NFPAWidget *nfpa( new NFPAWidget( nullptr, parms ));
-                    widget = nfpa;
-                } else {
-                    GHSWidget *ghs( new GHSWidget( nullptr, parms ));
-                    widget = ghs;
-                }
-
-                // there aren't supposed to be updates (disimilar to PropertyDock::setSpecialWidgets)
-                // therefore we can set the widget and forget about it
-                //widget->setAttribute( Qt::WA_DeleteOnClose, true );
-
-                // FIXME: dirty hack to fix alignment
-                QWidget *container = new QWidget();
-                container->setAttribute( Qt::WA_DeleteOnClose, true );
-                QGridLayout *grid( new QGridLayout());
-                grid->setSpacing(0);
-                grid->setContentsMargins( 0, 0, 0, 0 );
-                grid->addItem( new QSpacerItem( 1, 1, QSizePolicy::Fixed, QSizePolicy::Expanding ), 0, 0, 1, 3 );
-                grid->addItem( new QSpacerItem( 1, 1, QSizePolicy::Expanding, QSizePolicy::Fixed ), 1, 0 );
-                grid->addWidget( widget, 1, 1 );
-                grid->addItem( new QSpacerItem( 1, 1, QSizePolicy::Expanding, QSizePolicy::Fixed ), 1, 2 );
-                grid->addItem( new QSpacerItem( 1, 1, QSizePolicy::Fixed, QSizePolicy::Expanding ), 2, 0, 1, 3 );
-                container->setLayout( grid );
-
-                this->ui->tableView->setIndexWidget( index, container );
-            }
-        }
-    }
+    // NOTE: this is an in-memory operation; no queries are run on tab switches
+    this->model->setRows( this->pivot, rows );
 
     // resize to contents
     this->ui->tableView->resizeColumnsToContents();
@@ -352,84 +213,104 @@ void TableViewer::populateTable( const QList<Id> tagIds, const QString &filter )
 /**
  * @brief TableViewer::setFilter
  */
-void TableViewer::setFilter( const Id tabId, const QList<Id> tagList ) {
-    // clear filter just in case
-    this->m_filter.clear();
-
+void TableViewer::setFilter() {
     // no tabs - no filter
     if ( this->ui->tabBar->currentIndex() < 0 )
         return;
 
     // get tab name which is also the category filter
-    const QString text( this->ui->tabBar->currentIndex() == this->ui->tabBar->count() - 1 ? "" : this->ui->tabBar->tabText( this->ui->tabBar->currentIndex()));
-
     // [filter0] [filter1] .. [filterN] [Unsorted]
-    // if text is empty - it indicates that we have selected the last or 'Unsorted' tab which uses a simplified query
-    if ( text.isEmpty())
-        this->m_filter = QString( " %1.%2 not in ( select %3 from %4 where %5=%6 ) and " ).arg(
-                    Reagent::instance()->tableName(), // 1
-                    Reagent::instance()->fieldName( Reagent::ID ), // 2
-                    Property::instance()->fieldName( Property::ReagentId ), // 3
-                    Property::instance()->tableName(), // 4
-                    Property::instance()->fieldName( Property::TagId ), // 5
-                    QString::number( static_cast<int>( tabId ))
-                    );
-    else
-        this->m_filter = QString( " %1.%2 in ( select %3 from %4 where %5=%6 and cast( %7 as text )='%8' ) and " ).arg(
-                    Reagent::instance()->tableName(), // 1
-                    Reagent::instance()->fieldName( Reagent::ID ), // 2
-                    Property::instance()->fieldName( Property::ReagentId ), // 3
-                    Property::instance()->tableName(), // 4
-                    Property::instance()->fieldName( Property::TagId ), // 5
-                    QString::number( static_cast<int>( tabId )), // 6
-                    Property::instance()->fieldName( Property::PropertyData ), // 7
-                    text // 8
-                    );
+    // if text is empty - it indicates that we have selected the last or 'Unsorted' tab
+    const QString text( this->ui->tabBar->currentIndex() == this->ui->tabBar->count() - 1 ? "" : this->ui->tabBar->tabText( this->ui->tabBar->currentIndex()));
 
     // repopulate table with filtering enabled
-    this->populateTable( tagList, this->filter());
+    this->populateTable( this->pivot->rows( text ));
 }
 
 /**
- * @brief FilterModel::lessThan
- * @param left
- * @param right
+ * @brief PivotModel::rowCount
+ * @param parent
  * @return
  */
-bool FilterModel::lessThan( const QModelIndex &left, const QModelIndex &right ) const {
-    const Id leftId = left.data( Qt::DisplayRole ).value<Id>();
-    const Id rightId = right.data( Qt::DisplayRole ).value<Id>();
+int PivotModel::rowCount( const QModelIndex &parent ) const {
+    return parent.isValid() ? 0 : this->rows.count();
+}
 
-    if ( static_cast<int>( leftId ) <= 0 || static_cast<int>( rightId ) <= 0 )
-        return leftId < rightId;
+/**
+ * @brief PivotModel::columnCount
+ * @param parent
+ * @return
+ */
+int PivotModel::columnCount( const QModelIndex &parent ) const {
+    return parent.isValid() || this->pivot.isNull() ? 0 : this->pivot->columnCount() + 1;
+}
 
-    bool reagent = left.column() == 0;
+/**
+ * @brief PivotModel::data
+ * @param index
+ * @param role
+ * @return
+ */
+QVariant PivotModel::data( const QModelIndex &index, int role ) const {
+    if ( !index.isValid() || this->pivot.isNull() || index.row() >= this->rows.count())
+        return QVariant();
 
+    const int row = this->rows.at( index.row());
+    if ( role == Qt::DisplayRole )
+        return static_cast<int>( index.column() == 0 ? this->pivot->reagentId( row ) : this->pivot->propertyId( row, index.column() - 1 ));
 
-    // FIXME: or just check if .toReal() succeeds and compare output?
-    if ( !reagent ) {
-        const Id leftTagId = Property::instance()->tagId( leftId );
-        const Id rightTagId = Property::instance()->tagId( rightId );
+    if ( role == PivotModel::SortRole )
+        return this->pivot->sortKey( row, index.column() - 1 );
 
-        if ( leftTagId != Id::Invalid && rightTagId != Id::Invalid ) {
-            const Tag::Types leftType = Tag::instance()->type( leftTagId );
-            const Tag::Types rightType = Tag::instance()->type( rightTagId );
+    return QVariant();
+}
 
-            //qDebug() << "compare numbazzz";
+/**
+ * @brief PivotModel::headerData
+ * @param section
+ * @param orientation
+ * @param role
+ * @return
+ */
+QVariant PivotModel::headerData( int section, Qt::Orientation orientation, int role ) const {
+    if ( orientation != Qt::Horizontal || role != Qt::DisplayRole || this->pivot.isNull())
+        return QAbstractTableModel::headerData( section, orientation, role );
 
-            if (( leftType == Tag::Integer || leftType == Tag::Real ) && ( rightType == Tag::Integer || rightType == Tag::Real )) {
-                const qreal leftNumber = Property::instance()->propertyData( leftId ).toReal();
-                const qreal rightNumber = Property::instance()->propertyData( rightId ).toReal();
+    if ( section == 0 )
+        return TableViewer::tr( "Reagent" );
 
-                return leftNumber < rightNumber;
-            }
-        }
-    }
+    return QApplication::translate( "Tag", Tag::instance()->name( this->pivot->tagIds().at( section - 1 )).toUtf8().constData());
+}
+
+/**
+ * @brief PivotModel::setRows
+ * @param pivot
+ * @param rows
+ */
+void PivotModel::setRows( const QSharedPointer<PivotTable> &pivot, const QVector<int> &rows ) {
+    this->beginResetModel();
+    this->pivot = pivot;
+    this->rows = rows;
+    this->endResetModel();
+}
+
+/**
+ * @brief FilterModel::lessThan
+ * @param left
+ * @param right
+ * @return
+ */
+bool FilterModel::lessThan( const QModelIndex &left, const QModelIndex &right ) const {
+    const QVariant leftKey( left.data( PivotModel::SortRole ));
+    const QVariant rightKey( right.data( PivotModel::SortRole ));
+
+    // empty cells go first
+    if ( leftKey.isNull() || rightKey.isNull())
+        return leftKey.isNull() && !rightKey.isNull();
 
-    const QString leftString( HTMLUtils::toPlainText( reagent ? Reagent::instance()->name( leftId ) : Property::instance()->propertyData( leftId ).toString()));
-    const QString rightString( HTMLUtils::toPlainText( reagent ? Reagent::instance()->name( rightId ) : Property::instance()->propertyData( rightId ).toString()));
+    // numeric sort keys are precomputed for Integer and Real tags
+    if ( leftKey.type() == QVariant::Double && rightKey.type() == QVariant::Double )
+        return leftKey.toReal() < rightKey.toReal();
 
-    return leftString < rightString;
-    //qDebug() << leftString << rightString;
-    //return QString::localeAwareCompare( leftString, rightString );
+    return leftKey.toString() < rightKey.toString();
 }
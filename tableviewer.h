@@ -20,9 +20,12 @@
  * includes
  */
 #include <QDialog>
-#include <QSqlQueryModel>
+#include <QAbstractTableModel>
+#include <QFutureWatcher>
+#include <QSortFilterProxyModel>
 #include "propertydelegate.h"
 #include "reagentdelegate.h"
+#include "pivottable.h"
 #include "table.h"
 
 /**
@@ -32,6 +35,30 @@ namespace Ui {
 class TableViewer;
 }
 
+/**
+ * @brief The PivotModel class exposes a subset of PivotTable rows as [reagentId] [propertyId_0] ... [propertyId_N]
+ */
+class PivotModel : public QAbstractTableModel {
+public:
+    /**
+     * @brief The Roles enum
+     */
+    enum Roles {
+        SortRole = Qt::UserRole
+    };
+
+    explicit PivotModel( QObject *parent = nullptr ) : QAbstractTableModel( parent ) {}
+    [[nodiscard]] int rowCount( const QModelIndex &parent = QModelIndex()) const override;
+    [[nodiscard]] int columnCount( const QModelIndex &parent = QModelIndex()) const override;
+    [[nodiscard]] QVariant data( const QModelIndex &index, int role ) const override;
+    [[nodiscard]] QVariant headerData( int section, Qt::Orientation orientation, int role ) const override;
+    void setRows( const QSharedPointer<PivotTable> &pivot, const QVector<int> &rows );
+
+private:
+    QSharedPointer<PivotTable> pivot;
+    QVector<int> rows;
+};
+
 /**
  * @brief The FilterModel class
  */
@@ -49,23 +76,22 @@ public:
     explicit TableViewer( QWidget *parent = nullptr, const Id &tableId = Id::Invalid );
     ~TableViewer() override;
 
-    /**
-     * @brief filter
-     * @return
-     */
-    [[nodiscard]] QString filter() const { return this->m_filter; }
-
 protected:
     void showEvent( QShowEvent *event ) override;
 
 public slots:
-    void populateTable( const QList<Id> tagIds, const QString &filter );
-    void setFilter( const Id tabId, const QList<Id> tagList );
+    void populateTable( const QVector<int> &rows );
+    void setFilter();
+
+private slots:
+    void setup();
 
 private:
+    void resizeToContents();
     Ui::TableViewer *ui;
-    QSqlQueryModel *model = new QSqlQueryModel();
-    QString m_filter;
+    QSharedPointer<PivotTable> pivot;
+    QFutureWatcher<QSharedPointer<PivotTable>> watcher;
+    PivotModel *model = new PivotModel();
     FilterModel *filterModel = new FilterModel();
     ReagentDelegate *reagentDelegate = nullptr;
     PropertyDelegate *propertyDelegate = nullptr;
@@ -22,6 +22,7 @@
 #include "tag.h"
 #include "field.h"
 #include "database.h"
+#include "querytracer.h"
 
 #include <QSqlQuery>
 
@@ -68,10 +69,10 @@ QStringList Tag::getFunctionList() const {
     // NOTE: this is not very expensive so there is no need to optimize this yet
     QStringList functions;
     QSqlQuery query;
-    query.exec( QString( "select %1, %2 from %3 where %2 not null" )
+    QueryTracer::exec( query, QString( "select %1, %2 from %3 where %2 not null" )
                         .arg( Tag::instance()->fieldName( Tag::ID ),
                               Tag::instance()->fieldName( Tag::Function ),
-                              Tag::instance()->tableName()));
+                              Tag::instance()->tableName()), "tag" );
     while ( query.next()) {
         const QString functionName( query.value( 1 ).toString());
         if ( !functionName.isEmpty())
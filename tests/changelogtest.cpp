@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "changelogtest.h"
+#include "database.h"
+#include "reagent.h"
+#include "variable.h"
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QtTest>
+
+/*
+ * the other instance
+ */
+namespace ChangeLogTest_ {
+    constexpr const char *Connection = "changeLogTest";
+    constexpr const char *Origin = "{changeLogTest}";
+}
+
+/**
+ * @brief ChangeLogTest::initTestCase enables shared mode and opens a second connection to the same database
+ */
+void ChangeLogTest::initTestCase() {
+    // changes are polled manually
+    Variable::setInteger( "database/pollInterval", 3600000 );
+    Variable::enable( "database/shared" );
+    QVERIFY( ChangeLog::instance()->isEnabled());
+
+    QSqlDatabase database( QSqlDatabase::addDatabase( "QSQLITE", ChangeLogTest_::Connection ));
+    database.setDatabaseName( QSqlDatabase::database().databaseName());
+    QVERIFY( database.open());
+    Database::configure( database );
+}
+
+/**
+ * @brief ChangeLogTest::cleanupTestCase
+ */
+void ChangeLogTest::cleanupTestCase() {
+    QSqlDatabase::database( ChangeLogTest_::Connection ).close();
+    QSqlDatabase::removeDatabase( ChangeLogTest_::Connection );
+}
+
+/**
+ * @brief ChangeLogTest::insert
+ */
+void ChangeLogTest::insert() {
+    const int count = Reagent::instance()->count();
+    this->reagentId = ChangeLogTest::addReagent( "Shared insert" );
+    QVERIFY( this->reagentId != Id::Invalid );
+    QVERIFY( Reagent::instance()->row( this->reagentId ) == Row::Invalid );
+
+    QSignalSpy added( ChangeLog::instance(), &ChangeLog::reagentAdded );
+    ChangeLog::instance()->poll();
+
+    const Row row = Reagent::instance()->row( this->reagentId );
+    QVERIFY( row != Row::Invalid );
+    QCOMPARE( Reagent::instance()->count(), count + 1 );
+    QCOMPARE( Reagent::instance()->name( row ), QString( "Shared insert" ));
+    QCOMPARE( added.count(), 1 );
+}
+
+/**
+ * @brief ChangeLogTest::update
+ */
+void ChangeLogTest::update() {
+    QVERIFY( this->reagentId != Id::Invalid );
+
+    QSqlQuery query( QSqlDatabase::database( ChangeLogTest_::Connection ));
+    query.prepare( QString( "update %1 set %2=? where %3=?" )
+                   .arg( Reagent::instance()->tableName(),
+                         Reagent::instance()->fieldName( Reagent::Name ),
+                         Reagent::instance()->fieldName( Reagent::ID )));
+    query.addBindValue( QString( "Shared update" ));
+    query.addBindValue( static_cast<int>( this->reagentId ));
+    QVERIFY( query.exec());
+    QVERIFY( ChangeLogTest::record( this->reagentId, ChangeLog::Update, Reagent::Name ));
+
+    QSignalSpy changed( Reagent::instance(), &Table::entryChanged );
+    ChangeLog::instance()->poll();
+
+    QCOMPARE( changed.count(), 1 );
+    QCOMPARE( Reagent::instance()->name( Reagent::instance()->row( this->reagentId )), QString( "Shared update" ));
+}
+
+/**
+ * @brief ChangeLogTest::remove
+ */
+void ChangeLogTest::remove() {
+    QVERIFY( this->reagentId != Id::Invalid );
+
+    const int count = Reagent::instance()->count();
+    QVERIFY( ChangeLogTest::removeReagent( this->reagentId ));
+
+    QSignalSpy removed( Reagent::instance(), &Table::entryRemoved );
+    ChangeLog::instance()->poll();
+
+    QCOMPARE( removed.count(), 1 );
+    QVERIFY( Reagent::instance()->row( this->reagentId ) == Row::Invalid );
+    QCOMPARE( Reagent::instance()->count(), count - 1 );
+    this->reagentId = Id::Invalid;
+}
+
+/**
+ * @brief ChangeLogTest::insertAndRemove entries added and removed within the same poll are never selected
+ */
+void ChangeLogTest::insertAndRemove() {
+    const int count = Reagent::instance()->count();
+    const Id id = ChangeLogTest::addReagent( "Shared transient" );
+    QVERIFY( id != Id::Invalid );
+    QVERIFY( ChangeLogTest::removeReagent( id ));
+
+    QSignalSpy added( ChangeLog::instance(), &ChangeLog::reagentAdded );
+    QSignalSpy removed( ChangeLog::instance(), &ChangeLog::reagentRemoved );
+    ChangeLog::instance()->poll();
+
+    QCOMPARE( added.count(), 0 );
+    QCOMPARE( removed.count(), 0 );
+    QVERIFY( Reagent::instance()->row( id ) == Row::Invalid );
+    QCOMPARE( Reagent::instance()->count(), count );
+}
+
+/**
+ * @brief ChangeLogTest::ownChanges changes are recorded with the local origin and are not applied twice
+ */
+void ChangeLogTest::ownChanges() {
+    const Id id = Reagent::instance()->id( Reagent::instance()->add( "Shared local", QString()));
+    QVERIFY( id != Id::Invalid );
+
+    QSqlQuery query( QSqlDatabase::database( ChangeLogTest_::Connection ));
+    QVERIFY( query.exec( QString( "select count(*) from %1 where tableName='%2' and rowId=%3 and operation=%4 and origin!='%5'" )
+                         .arg( ChangeLog::TableName,
+                               Reagent::instance()->tableName(),
+                               QString::number( static_cast<int>( id )),
+                               QString::number( ChangeLog::Insert ),
+                               ChangeLogTest_::Origin )));
+    QVERIFY( query.next());
+    QCOMPARE( query.value( 0 ).toInt(), 1 );
+
+    QSignalSpy added( ChangeLog::instance(), &ChangeLog::reagentAdded );
+    ChangeLog::instance()->poll();
+    QCOMPARE( added.count(), 0 );
+
+    Reagent::instance()->remove( QList<Id>() << id );
+}
+
+/**
+ * @brief ChangeLogTest::addReagent adds a reagent through the second connection
+ * @param name
+ * @return
+ */
+Id ChangeLogTest::addReagent( const QString &name ) {
+    QSqlQuery query( QSqlDatabase::database( ChangeLogTest_::Connection ));
+    query.prepare( QString( "insert into %1 ( %2, %3, %4, %5 ) values ( ?, ?, ?, ? )" )
+                   .arg( Reagent::instance()->tableName(),
+                         Reagent::instance()->fieldName( Reagent::Name ),
+                         Reagent::instance()->fieldName( Reagent::Reference ),
+                         Reagent::instance()->fieldName( Reagent::ParentId ),
+                         Reagent::instance()->fieldName( Reagent::DateTime )));
+    query.addBindValue( name );
+    query.addBindValue( QString());
+    query.addBindValue( static_cast<int>( Id::Invalid ));
+    query.addBindValue( 0 );
+    if ( !query.exec())
+        return Id::Invalid;
+
+    const Id id = query.lastInsertId().value<Id>();
+    return ChangeLogTest::record( id, ChangeLog::Insert ) ? id : Id::Invalid;
+}
+
+/**
+ * @brief ChangeLogTest::removeReagent removes a reagent through the second connection
+ * @param reagentId
+ * @return
+ */
+bool ChangeLogTest::removeReagent( const Id &reagentId ) {
+    QSqlQuery query( QSqlDatabase::database( ChangeLogTest_::Connection ));
+    if ( !query.exec( QString( "delete from %1 where %2=%3" )
+                      .arg( Reagent::instance()->tableName(),
+                            Reagent::instance()->fieldName( Reagent::ID ),
+                            QString::number( static_cast<int>( reagentId )))))
+        return false;
+
+    return ChangeLogTest::record( reagentId, ChangeLog::Remove );
+}
+
+/**
+ * @brief ChangeLogTest::record records a change the same way ChangeLog does, but with a different origin
+ * @param reagentId
+ * @param operation
+ * @param fieldId
+ * @return
+ */
+bool ChangeLogTest::record( const Id &reagentId, ChangeLog::Operations operation, int fieldId ) {
+    QSqlQuery query( QSqlDatabase::database( ChangeLogTest_::Connection ));
+    query.prepare( QString( "insert into %1( tableName, rowId, operation, fieldId, origin ) values( ?, ?, ?, ?, ? )" ).arg( ChangeLog::TableName ));
+    query.addBindValue( Reagent::instance()->tableName());
+    query.addBindValue( static_cast<int>( reagentId ));
+    query.addBindValue( static_cast<int>( operation ));
+    query.addBindValue( fieldId );
+    query.addBindValue( QString( ChangeLogTest_::Origin ));
+    return query.exec();
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QObject>
+#include "changelog.h"
+
+/**
+ * @brief The ChangeLogTest class checks that changes made by another instance through a second
+ * connection are applied by ChangeLog::poll
+ */
+class ChangeLogTest final : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( ChangeLogTest )
+
+public:
+    explicit ChangeLogTest() = default;
+
+    // disable move
+    ChangeLogTest( ChangeLogTest&& ) = delete;
+    ChangeLogTest& operator=( ChangeLogTest&& ) = delete;
+    ~ChangeLogTest() override = default;
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void insert();
+    void update();
+    void remove();
+    void insertAndRemove();
+    void ownChanges();
+
+private:
+    [[nodiscard]] static Id addReagent( const QString &name );
+    [[nodiscard]] static bool removeReagent( const Id &reagentId );
+    [[nodiscard]] static bool record( const Id &reagentId, ChangeLog::Operations operation, int fieldId = -1 );
+
+    Id reagentId = Id::Invalid;
+};
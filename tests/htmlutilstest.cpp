@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "htmlutilstest.h"
+#include "htmlutils.h"
+#include <QTextDocument>
+#include <QtTest>
+
+/**
+ * @brief HTMLUtilsTest::reference returns plain text the way earlier versions converted it
+ * @param html
+ * @return
+ */
+QString HTMLUtilsTest::reference( const QString &html ) {
+    if ( !Qt::mightBeRichText( html ))
+        return html;
+
+    QTextDocument document;
+    document.setHtml( html );
+    return document.toPlainText();
+}
+
+/**
+ * @brief HTMLUtilsTest::namedEntities_data entities commonly found in reagent names and property values
+ */
+void HTMLUtilsTest::namedEntities_data() {
+    QTest::addColumn<QString>( "name" );
+
+    const QStringList names( QStringList()
+                             << "amp" << "lt" << "gt" << "quot" << "nbsp" << "deg" << "micro" << "plusmn" << "middot"
+                             << "sup2" << "sup3" << "frac12" << "times" << "divide" << "alpha" << "beta" << "mu" << "Omega"
+                             << "rarr" << "harr" << "le" << "ge" << "asymp" << "permil" << "copy" << "reg" << "trade"
+                             << "euro" << "laquo" << "hellip" << "ndash" << "mdash" << "Auml" << "szlig" << "unknown" );
+    for ( const QString &name : names )
+        QTest::newRow( qPrintable( name )) << name;
+}
+
+/**
+ * @brief HTMLUtilsTest::namedEntities
+ */
+void HTMLUtilsTest::namedEntities() {
+    QFETCH( QString, name );
+
+    const QString html( QString( "<p>x &%1; y</p>" ).arg( name ));
+    QCOMPARE( HTMLUtils::toPlainText( html ), HTMLUtilsTest::reference( html ));
+}
+
+/**
+ * @brief HTMLUtilsTest::markup_data
+ */
+void HTMLUtilsTest::markup_data() {
+    QTest::addColumn<QString>( "html" );
+
+    QTest::newRow( "plain" ) << "Sodium chloride";
+    QTest::newRow( "subscript" ) << "<html><body>H<sub>2</sub>O</body></html>";
+    QTest::newRow( "paragraphs" ) << "<p>first</p><p>second</p>";
+    QTest::newRow( "line break" ) << "<p>first<br>second</p>";
+    QTest::newRow( "head" ) << "<html><head><style>p { margin: 0; }</style></head><body><p>Sodium&nbsp;chloride</p></body></html>";
+    QTest::newRow( "numeric" ) << "<p>10&#176;C, 5&#x00b5;l</p>";
+    QTest::newRow( "escaped markup" ) << "<p>&lt;b&gt;bold&lt;/b&gt;</p>";
+}
+
+/**
+ * @brief HTMLUtilsTest::markup
+ */
+void HTMLUtilsTest::markup() {
+    QFETCH( QString, html );
+    QCOMPARE( HTMLUtils::toPlainText( html ), HTMLUtilsTest::reference( html ));
+}
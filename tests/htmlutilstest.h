@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QObject>
+
+/**
+ * @brief The HTMLUtilsTest class compares HTMLUtils::toPlainText with QTextDocument (used by earlier versions)
+ */
+class HTMLUtilsTest final : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( HTMLUtilsTest )
+
+public:
+    explicit HTMLUtilsTest() = default;
+
+    // disable move
+    HTMLUtilsTest( HTMLUtilsTest&& ) = delete;
+    HTMLUtilsTest& operator=( HTMLUtilsTest&& ) = delete;
+    ~HTMLUtilsTest() override = default;
+
+private slots:
+    void namedEntities_data();
+    void namedEntities();
+    void markup_data();
+    void markup();
+
+private:
+    [[nodiscard]] static QString reference( const QString &html );
+};
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "changelogtest.h"
+#include "core.h"
+#include "database.h"
+#include "htmlutilstest.h"
+#include "main.h"
+#include "propertyflagstest.h"
+#include "variable.h"
+#include <QGuiApplication>
+#include <QTemporaryDir>
+#include <QtTest>
+
+/**
+ * @brief main runs core tests against a copy of the built-in database
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main( int argc, char *argv[] ) {
+    // keep configuration and database out of the user's home directory
+    QTemporaryDir home;
+    qputenv( "HOME", home.path().toLocal8Bit());
+    qputenv( "USERPROFILE", home.path().toLocal8Bit());
+    if ( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ))
+        qputenv( "QT_QPA_PLATFORM", "offscreen" );
+
+    QGuiApplication a( argc, argv );
+
+    // NOTE: database is copied from resources, since the path does not exist yet
+    Core::registerMetaTypes();
+    Core::addVariables();
+    Variable::setString( "databasePath", home.filePath( "database.db" ));
+    Database::instance();
+    if ( !Core::loadTables())
+        return 1;
+
+    int result = 0;
+    {
+        PropertyFlagsTest propertyFlags;
+        result |= QTest::qExec( &propertyFlags, argc, argv );
+    }
+    {
+        HTMLUtilsTest htmlUtils;
+        result |= QTest::qExec( &htmlUtils, argc, argv );
+    }
+
+    // NOTE: last, since shared mode records every subsequent change
+    {
+        ChangeLogTest changeLog;
+        result |= QTest::qExec( &changeLog, argc, argv );
+    }
+
+    GarbageMan::instance()->clear();
+    delete GarbageMan::instance();
+    delete Database::instance();
+    delete Variable::instance();
+
+    return result;
+}
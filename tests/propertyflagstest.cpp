@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "propertyflagstest.h"
+#include "reagent.h"
+#include "tag.h"
+#include <QtTest>
+
+/*
+ * tags of the built-in database (scriptable unless noted otherwise)
+ */
+namespace PropertyFlagsTest_ {
+    [[maybe_unused]] constexpr const Id MolarMass = static_cast<Id>( 1 );
+    [[maybe_unused]] constexpr const Id Density = static_cast<Id>( 2 );
+    [[maybe_unused]] constexpr const Id Assay = static_cast<Id>( 3 );
+    [[maybe_unused]] constexpr const Id Producer = static_cast<Id>( 23 ); // not scriptable
+}
+
+/**
+ * @brief PropertyFlagsTest::initTestCase adds a reagent with a batch and a reagent with duplicate tags
+ */
+void PropertyFlagsTest::initTestCase() {
+    QVERIFY( !Tag::instance()->function( PropertyFlagsTest_::MolarMass ).isEmpty());
+    QVERIFY( Tag::instance()->function( PropertyFlagsTest_::Producer ).isEmpty());
+
+    this->parentId = Reagent::instance()->id( Reagent::instance()->add( "Flag parent", "FLAGP" ));
+    this->batchId = Reagent::instance()->id( Reagent::instance()->add( "Flag batch", QString(), this->parentId ));
+    this->duplicateId = Reagent::instance()->id( Reagent::instance()->add( "Flag duplicate", "FLAGD" ));
+    QVERIFY( this->parentId != Id::Invalid );
+    QVERIFY( this->batchId != Id::Invalid );
+    QVERIFY( this->duplicateId != Id::Invalid );
+
+    // parent: molar mass and density, batch: overrides density and adds assay
+    QVERIFY( Property::instance()->add( QString(), PropertyFlagsTest_::MolarMass, "100", this->parentId ) != Row::Invalid );
+    QVERIFY( Property::instance()->add( QString(), PropertyFlagsTest_::Density, "1.0", this->parentId ) != Row::Invalid );
+    QVERIFY( Property::instance()->add( QString(), PropertyFlagsTest_::Density, "0.9", this->batchId ) != Row::Invalid );
+    QVERIFY( Property::instance()->add( QString(), PropertyFlagsTest_::Assay, "99", this->batchId ) != Row::Invalid );
+
+    // duplicates in the first two rows (missed by the old backwards scan) and a non-scriptable pair
+    QVERIFY( Property::instance()->add( QString(), PropertyFlagsTest_::MolarMass, "58.44", this->duplicateId ) != Row::Invalid );
+    QVERIFY( Property::instance()->add( QString(), PropertyFlagsTest_::MolarMass, "58.45", this->duplicateId ) != Row::Invalid );
+    QVERIFY( Property::instance()->add( QString(), PropertyFlagsTest_::Producer, "A", this->duplicateId ) != Row::Invalid );
+    QVERIFY( Property::instance()->add( QString(), PropertyFlagsTest_::Producer, "B", this->duplicateId ) != Row::Invalid );
+    QVERIFY( Property::instance()->add( QString(), PropertyFlagsTest_::MolarMass, "58.46", this->duplicateId ) != Row::Invalid );
+}
+
+/**
+ * @brief PropertyFlagsTest::cleanupTestCase
+ */
+void PropertyFlagsTest::cleanupTestCase() {
+    Property::instance()->setFilter( QString());
+    Reagent::instance()->remove( QList<Id>() << this->parentId << this->duplicateId );
+}
+
+/**
+ * @brief PropertyFlagsTest::batchOverride
+ */
+void PropertyFlagsTest::batchOverride() {
+    PropertyFlagsTest::selectReagent( this->batchId, this->parentId );
+    QCOMPARE( PropertyFlagsTest::flags( this->batchId, PropertyFlagsTest_::Density ), Property::PropertyFlags( Property::Batch | Property::Override ));
+
+    // overridden parent value is not selected
+    QCOMPARE( PropertyFlagsTest::flags( this->parentId, PropertyFlagsTest_::Density ), Property::PropertyFlags( Property::NoFlags ));
+}
+
+/**
+ * @brief PropertyFlagsTest::batchNonOverriding
+ */
+void PropertyFlagsTest::batchNonOverriding() {
+    PropertyFlagsTest::selectReagent( this->batchId, this->parentId );
+    QCOMPARE( PropertyFlagsTest::flags( this->batchId, PropertyFlagsTest_::Assay ), Property::PropertyFlags( Property::Batch ));
+}
+
+/**
+ * @brief PropertyFlagsTest::parentProperty inherited parent values are neither batch nor duplicate
+ */
+void PropertyFlagsTest::parentProperty() {
+    PropertyFlagsTest::selectReagent( this->batchId, this->parentId );
+    QCOMPARE( PropertyFlagsTest::flags( this->parentId, PropertyFlagsTest_::MolarMass ), Property::PropertyFlags( Property::NoFlags ));
+}
+
+/**
+ * @brief PropertyFlagsTest::duplicateScriptableTags
+ */
+void PropertyFlagsTest::duplicateScriptableTags() {
+    PropertyFlagsTest::selectReagent( this->duplicateId );
+    QCOMPARE( PropertyFlagsTest::flags( this->duplicateId, PropertyFlagsTest_::MolarMass, 2 ), Property::PropertyFlags( Property::Duplicate ));
+
+    // only scriptable tags can be duplicates
+    QCOMPARE( PropertyFlagsTest::flags( this->duplicateId, PropertyFlagsTest_::Producer, 0 ), Property::PropertyFlags( Property::NoFlags ));
+    QCOMPARE( PropertyFlagsTest::flags( this->duplicateId, PropertyFlagsTest_::Producer, 1 ), Property::PropertyFlags( Property::NoFlags ));
+}
+
+/**
+ * @brief PropertyFlagsTest::duplicateFirstRows covers the old startIndex > 0 check, which never flagged the second row
+ */
+void PropertyFlagsTest::duplicateFirstRows() {
+    PropertyFlagsTest::selectReagent( this->duplicateId );
+    QCOMPARE( Property::instance()->tagId( static_cast<Row>( 0 )), PropertyFlagsTest_::MolarMass );
+    QCOMPARE( Property::instance()->tagId( static_cast<Row>( 1 )), PropertyFlagsTest_::MolarMass );
+    QCOMPARE( Property::instance()->propertyFlags( static_cast<Row>( 0 )), Property::PropertyFlags( Property::NoFlags ));
+    QCOMPARE( Property::instance()->propertyFlags( static_cast<Row>( 1 )), Property::PropertyFlags( Property::Duplicate ));
+}
+
+/**
+ * @brief PropertyFlagsTest::unfilteredSelect flags are not computed without a reagent filter
+ */
+void PropertyFlagsTest::unfilteredSelect() {
+    Property::instance()->setFilter( QString());
+    QVERIFY( Property::instance()->count() > 0 );
+
+    for ( int y = 0; y < Property::instance()->count(); y++ )
+        QCOMPARE( Property::instance()->propertyFlags( static_cast<Row>( y )), Property::PropertyFlags( Property::NoFlags ));
+}
+
+/**
+ * @brief PropertyFlagsTest::selectReagent applies the same filter as ReagentView (without hidden tags)
+ * @param reagentId
+ * @param parentId
+ */
+void PropertyFlagsTest::selectReagent( const Id &reagentId, const Id &parentId ) {
+    Property::instance()->setFilter( QString(
+            "( %1=%2 and %1>-1 ) or ( %1=%3 and %1>-1 and %4 not in ( select %4 from %5 where ( %1=%2 and %4>-2 )))" )
+                                             .arg( Property::instance()->fieldName( Property::ReagentId ),
+                                                   QString::number( static_cast<int>( reagentId )),
+                                                   QString::number( static_cast<int>( parentId )),
+                                                   Property::instance()->fieldName( Property::TagId ),
+                                                   Property::instance()->tableName()));
+    Property::instance()->sort( Property::TableOrder, Qt::AscendingOrder );
+    Property::instance()->select();
+}
+
+/**
+ * @brief PropertyFlagsTest::flags returns flags of the n-th selected property of a reagent with the given tag
+ * @param reagentId
+ * @param tagId
+ * @param occurrence
+ * @return
+ */
+Property::PropertyFlags PropertyFlagsTest::flags( const Id &reagentId, const Id &tagId, int occurrence ) {
+    for ( int y = 0; y < Property::instance()->count(); y++ ) {
+        const Row row = static_cast<Row>( y );
+        if ( Property::instance()->reagentId( row ) != reagentId || Property::instance()->tagId( row ) != tagId )
+            continue;
+
+        if ( occurrence-- == 0 )
+            return Property::instance()->propertyFlags( row );
+    }
+
+    return Property::NoFlags;
+}
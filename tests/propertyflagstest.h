@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QObject>
+#include "property.h"
+
+/**
+ * @brief The PropertyFlagsTest class checks batch, override and duplicate flags of Property
+ */
+class PropertyFlagsTest final : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( PropertyFlagsTest )
+
+public:
+    explicit PropertyFlagsTest() = default;
+
+    // disable move
+    PropertyFlagsTest( PropertyFlagsTest&& ) = delete;
+    PropertyFlagsTest& operator=( PropertyFlagsTest&& ) = delete;
+    ~PropertyFlagsTest() override = default;
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void batchOverride();
+    void batchNonOverriding();
+    void parentProperty();
+    void duplicateScriptableTags();
+    void duplicateFirstRows();
+    void unfilteredSelect();
+
+private:
+    static void selectReagent( const Id &reagentId, const Id &parentId = Id::Invalid );
+    [[nodiscard]] static Property::PropertyFlags flags( const Id &reagentId, const Id &tagId, int occurrence = 0 );
+
+    Id parentId = Id::Invalid;
+    Id batchId = Id::Invalid;
+    Id duplicateId = Id::Invalid;
+};
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * includes
+ */
+#include "thumbnailmodel.h"
+#include "structureprefetcher.h"
+#include "variable.h"
+#include "cache.h"
+#include <QPixmap>
+#include <QThread>
+
+/**
+ * @brief ThumbnailModel::ThumbnailModel
+ * @param parent
+ */
+ThumbnailModel::ThumbnailModel( QObject *parent ) : QAbstractListModel( parent ) {
+    // keep up to ~16MB of decoded thumbnails (cost is in kilobytes)
+    this->thumbnails.setMaxCost( 16384 );
+    this->pool.setMaxThreadCount( qMax( 1, QThread::idealThreadCount() / 2 ));
+
+    ThumbnailModel::connect( NetworkManager::instance(), &NetworkManager::finished, this, &ThumbnailModel::replyReceived );
+    ThumbnailModel::connect( NetworkManager::instance(), &NetworkManager::error, this, &ThumbnailModel::error );
+}
+
+/**
+ * @brief ThumbnailModel::~ThumbnailModel
+ */
+ThumbnailModel::~ThumbnailModel() {
+    ThumbnailModel::disconnect( NetworkManager::instance(), &NetworkManager::finished, this, &ThumbnailModel::replyReceived );
+    ThumbnailModel::disconnect( NetworkManager::instance(), &NetworkManager::error, this, &ThumbnailModel::error );
+
+    // tasks reference this object, so they must finish first
+    this->cancel();
+    this->pool.waitForDone();
+}
+
+/**
+ * @brief ThumbnailModel::data
+ * @param index
+ * @param role
+ * @return
+ */
+QVariant ThumbnailModel::data( const QModelIndex &index, int role ) const {
+    if ( !index.isValid() || index.row() < 0 || index.row() >= this->cidList.count())
+        return QVariant();
+
+    const int cid = this->cidList.at( index.row());
+    switch ( role ) {
+    case Qt::DisplayRole:
+        return QString::number( cid );
+
+    case Qt::DecorationRole:
+    {
+        const QImage *image( this->thumbnails.object( cid ));
+        if ( image != nullptr )
+            return QPixmap::fromImage( *image );
+
+        // only visible rows are ever asked for decoration
+        this->request( cid );
+    }
+        break;
+
+    case Qt::SizeHintRole:
+        return QSize( ThumbnailModel::ThumbnailSize + 8, ThumbnailModel::ThumbnailSize + 24 );
+
+    default:
+        break;
+    }
+
+    return QVariant();
+}
+
+/**
+ * @brief ThumbnailModel::setCids
+ * @param list
+ */
+void ThumbnailModel::setCids( const QList<int> &list ) {
+    this->beginResetModel();
+    this->cancel();
+    this->cidList = list;
+    this->endResetModel();
+}
+
+/**
+ * @brief ThumbnailModel::cancel aborts all outstanding requests and processing
+ */
+void ThumbnailModel::cancel() {
+    this->generation.ref();
+    this->pool.clear();
+    this->pending.clear();
+    this->failed.clear();
+
+    NetworkManager::instance()->abort( NetworkManager::ThumbnailRequest );
+}
+
+/**
+ * @brief ThumbnailModel::request reads thumbnail from disk cache or network and decodes it on a worker thread
+ * @param cid
+ */
+void ThumbnailModel::request( int cid ) const {
+    if ( this->pending.contains( cid ) || this->failed.contains( cid ))
+        return;
+
+    this->pending << cid;
+    const QString key( QString( "%1.png" ).arg( cid ));
+    if ( Cache::instance()->contains( Cache::ThumbnailContext, key )) {
+        // NOTE: result is delivered through a queued slot, hence the const_cast
+        this->pool.start( new StructureTask( const_cast<ThumbnailModel *>( this ), this->generation.load(), &this->generation, cid,
+                                             Cache::instance()->getData( Cache::ThumbnailContext, key ), Variable::isEnabled( "darkMode" )));
+        return;
+    }
+
+    NetworkManager::instance()->execute( QString( "https://pubchem.ncbi.nlm.nih.gov/rest/pug/compound/cid/%1/PNG?image_size=small" ).arg( cid ), NetworkManager::ThumbnailRequest, cid );
+}
+
+/**
+ * @brief ThumbnailModel::replyReceived
+ * @param type
+ * @param userData
+ * @param data
+ */
+void ThumbnailModel::replyReceived( const QString &, NetworkManager::Types type, const QVariant &userData, const QByteArray &data ) {
+    const int cid = userData.toInt();
+    if ( type != NetworkManager::ThumbnailRequest || !this->pending.contains( cid ))
+        return;
+
+    if ( data.isEmpty()) {
+        this->pending.remove( cid );
+        this->failed << cid;
+        return;
+    }
+
+    Cache::instance()->insert( Cache::ThumbnailContext, QString( "%1.png" ).arg( cid ), data );
+    this->pool.start( new StructureTask( this, this->generation.load(), &this->generation, cid, data, Variable::isEnabled( "darkMode" )));
+}
+
+/**
+ * @brief ThumbnailModel::error
+ * @param type
+ * @param userData
+ */
+void ThumbnailModel::error( const QString &, NetworkManager::Types type, const QVariant &userData, const QString & ) {
+    const int cid = userData.toInt();
+    if ( type != NetworkManager::ThumbnailRequest || !this->pending.remove( cid ))
+        return;
+
+    this->failed << cid;
+}
+
+/**
+ * @brief ThumbnailModel::processed receives decoded thumbnails from worker threads
+ * @param cid
+ * @param generation
+ * @param image
+ */
+void ThumbnailModel::processed( int cid, int generation, const QImage &image ) {
+    if ( generation != this->generation.load() || !this->pending.remove( cid ))
+        return;
+
+    if ( image.isNull()) {
+        this->failed << cid;
+        return;
+    }
+
+    // scale down once, so that painting does not have to
+    QImage *thumbnail( new QImage( image.width() > ThumbnailModel::ThumbnailSize || image.height() > ThumbnailModel::ThumbnailSize ?
+                                   image.scaled( ThumbnailModel::ThumbnailSize, ThumbnailModel::ThumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation ) : image ));
+    this->thumbnails.insert( cid, thumbnail, qMax( 1, thumbnail->bytesPerLine() * thumbnail->height() / 1024 ));
+
+    const int row = this->cidList.indexOf( cid );
+    if ( row >= 0 )
+        emit this->dataChanged( this->index( row ), this->index( row ), QVector<int>() << Qt::DecorationRole );
+}
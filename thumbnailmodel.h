@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include <QAbstractListModel>
+#include <QAtomicInt>
+#include <QCache>
+#include <QImage>
+#include <QSet>
+#include <QThreadPool>
+#include "networkmanager.h"
+
+/**
+ * @brief The ThumbnailModel class lists cids with small structure thumbnails that are loaded on demand
+ */
+class ThumbnailModel final : public QAbstractListModel {
+    Q_OBJECT
+    Q_DISABLE_COPY( ThumbnailModel )
+
+public:
+    explicit ThumbnailModel( QObject *parent = nullptr );
+
+    // disable move
+    ThumbnailModel( ThumbnailModel&& ) = delete;
+    ThumbnailModel& operator=( ThumbnailModel&& ) = delete;
+
+    ~ThumbnailModel() override;
+
+    /**
+     * @brief rowCount
+     * @return
+     */
+    [[nodiscard]] int rowCount( const QModelIndex & = QModelIndex()) const override { return this->cidList.count(); }
+    [[nodiscard]] QVariant data( const QModelIndex &index, int role ) const override;
+    static constexpr const int ThumbnailSize = 100;
+
+public slots:
+    void setCids( const QList<int> &list );
+    void cancel();
+
+private slots:
+    void replyReceived( const QString &, NetworkManager::Types type, const QVariant &userData, const QByteArray &data );
+    void error( const QString &, NetworkManager::Types type, const QVariant &userData, const QString & );
+    void processed( int cid, int generation, const QImage &image );
+
+private:
+    void request( int cid ) const;
+
+    QList<int> cidList;
+
+    // NOTE: thumbnails are requested lazily from data(), when rows become visible
+    mutable QCache<int, QImage> thumbnails;
+    mutable QSet<int> pending;
+    mutable QSet<int> failed;
+    mutable QThreadPool pool;
+    QAtomicInt generation;
+};
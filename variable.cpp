@@ -21,39 +21,11 @@
  * includes
  */
 #include "variable.h"
-#include "widget.h"
-#include <QCheckBox>
-#include <QComboBox>
-#include <QAction>
 
 /**
  * @brief Variable::Variable
  */
-Variable::Variable() {
-    // update widgets on variable change
-    Variable::connect( this, &Variable::valueChanged, [ this ]( const QString &key ) {
-        const QList<Widget*> list( this->boundVariables.values( key ));
-        for ( Widget *widget : list ) {
-            auto var( Variable::value<QVariant>( key ));
-
-            if ( widget->value() != var )
-                widget->setValue( var );
-        }
-    } );
-
-    // update variable and sibling widgets on widget change
-    Variable::connect( this, &Variable::widgetChanged,
-                   [ this ]( const QString &key, Widget *widget, const QVariant &value ) {
-                       const QList<Widget*> list( this->boundVariables.values( key ));
-                       for ( Widget *boundWidget : list ) {
-                           if ( boundWidget == widget ) {
-                               Variable::setValue( key, value );
-                           } else {
-                               boundWidget->setValue( value );
-                           }
-                       }
-                   } );
-}
+Variable::Variable() {}
 
 /**
  * @brief Variable::~Variable
@@ -83,48 +55,3 @@ void Variable::bind( const QString &key, const QObject *receiver, const char *me
     this->slotList[key] = qMakePair( const_cast<QObject *>( receiver ), receiver->metaObject()->indexOfSlot( QMetaObject::normalizedSignature( qPrintable( method ))));
 }
 
-/**
- * @brief Variable::bind
- * @param key
- * @param object
- * @return
- */
-QString Variable::bind( const QString &key, QObject *object ) {
-    auto *boundWidget( new Widget( object ));
-
-    boundWidget->setValue( Variable::value<QVariant>( key ));
-    Variable::connect( boundWidget, &Widget::changed, this, [ this, key, boundWidget ]( const QVariant &value ) {
-        emit this->widgetChanged( key, boundWidget, value );
-    } );
-    this->boundVariables.insert( key, boundWidget );
-
-    return key;
-}
-
-/**
- * @brief Variable::unbind
- * @param key
- * @param object
- */
-void Variable::unbind( const QString &key, QObject *object ) {
-    if ( this->slotList.contains( key ))
-        this->slotList.remove( key );
-
-    if ( this->boundVariables.contains( key )) {
-        QList<Widget *> widgetList( this->boundVariables.values( key ));
-
-        if ( object == nullptr ) {
-            qDeleteAll( widgetList );
-            this->boundVariables.remove( key );
-            return;
-        }
-
-        const QList<Widget*> list( this->boundVariables.values( key ));
-        for ( Widget *compare : list ) {
-            if ( compare->widget == object ) {
-                this->boundVariables.remove( key, compare );
-                delete compare;
-            }
-        }
-    }
-}
@@ -26,7 +26,7 @@
 #include <QString>
 #include <QMetaMethod>
 #include <QLoggingCategory>
-#include <QWidget>
+#include <QObject>
 #include "variableentry.h"
 
 /**
@@ -337,15 +337,9 @@ public slots:
             Variable::setValue<QVariant>( key, Variable::value<QVariant>( key, true ));
     }
     void bind( const QString &key, const QObject *receiver, const char *method );
-    QString bind( const QString &key, QObject *object );
 
-    /**
-     * @brief bind
-     * @param key
-     * @param widget
-     * @return
-     */
-    QString bind( const QString &key, QWidget *widget ) { return this->bind( key, qobject_cast<QObject *>( widget )); }
+    // NOTE: widget bindings are implemented by the application (see variablebindings.cpp)
+    QString bind( const QString &key, QObject *object );
     void unbind( const QString &key, QObject *object = nullptr );
 
     /**
@@ -360,7 +354,9 @@ signals:
 
 private:
     explicit Variable();
+    void connectWidgets();
     QMap<QString, QSharedPointer<Var>> list;
     QMultiMap<QString, Widget *> boundVariables;
     QMap<QString, QPair<QObject *, int> > slotList;
+    bool widgetsConnected = false;
 };
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2020 Armands Aleksejevs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+#pragma once
+
+/*
+ * includes
+ */
+#include "variable.h"
+#include "listutils.h"
+
+/**
+ * @brief The VariableHandle class caches a decoded variable value until the variable changes
+ * (GUI thread only)
+ */
+template<typename T>
+class VariableHandle final {
+    Q_DISABLE_COPY( VariableHandle )
+
+public:
+    using Decoder = T ( * )( const QVariant &value );
+
+    /**
+     * @brief VariableHandle
+     * @param key
+     * @param decoder optional conversion from stored value (e.g. list parsing)
+     */
+    explicit VariableHandle( const char *key, Decoder decoder = nullptr ) : m_key( QString::fromLatin1( key )), decoder( decoder ) {}
+
+    // disable move
+    VariableHandle( VariableHandle&& ) = delete;
+    VariableHandle& operator=( VariableHandle&& ) = delete;
+    ~VariableHandle() = default;
+
+    /**
+     * @brief key
+     * @return
+     */
+    [[nodiscard]] const QString &key() const { return this->m_key; }
+
+    /**
+     * @brief value returns cached value, decoding it only after the variable has changed
+     * @return
+     */
+    [[nodiscard]] const T &value() const {
+        if ( !this->m_valid )
+            this->refresh();
+
+        return this->m_value;
+    }
+
+    /**
+     * @brief invalidate
+     */
+    void invalidate() const { this->m_valid = false; }
+
+private:
+    /**
+     * @brief refresh
+     */
+    void refresh() const {
+        // NOTE: resolved on first use, since handles are constructed before the variable registry
+        if ( !this->m_connected ) {
+            QObject::connect( Variable::instance(), &Variable::valueChanged, Variable::instance(), [ this ]( const QString &key ) {
+                if ( !QString::compare( key, this->m_key ))
+                    this->invalidate();
+            } );
+            this->m_connected = true;
+        }
+
+        const QVariant var( Variable::value<QVariant>( this->m_key ));
+        this->m_value = this->decoder != nullptr ? this->decoder( var ) : qvariant_cast<T>( var );
+        this->m_valid = true;
+    }
+
+    const QString m_key;
+    const Decoder decoder;
+    mutable T m_value = T();
+    mutable bool m_valid = false;
+    mutable bool m_connected = false;
+};
+
+/**
+ * @brief The Variable_ namespace
+ */
+namespace Variable_ {
+    inline const VariableHandle<bool> DarkMode( "darkMode" );
+    inline const VariableHandle<QString> DecimalSeparator( "decimalSeparator" );
+    inline const VariableHandle<int> SlowQueryThreshold( "database/slowQueryThreshold" );
+    inline const VariableHandle<QList<int>> SelectedLabelRows( "labelDock/selectedRows", []( const QVariant &value ) {
+        return ListUtils::toNumericList<int>( value.toString().split( ";" ));
+    } );
+}
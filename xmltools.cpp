@@ -28,9 +28,65 @@
 #include <QDir>
 #include <QDomDocument>
 #include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
 #include <QXmlStreamWriter>
 #include "main.h"
 
+/**
+ * @brief XMLTools::XMLTools
+ * @param parent
+ */
+XMLTools::XMLTools( QObject *parent ) : QObject( parent ) {
+    this->setObjectName( "XMLTools" );
+
+    // writes must not overlap
+    this->pool.setMaxThreadCount( 1 );
+
+    // debounce flushes
+    this->timer.setSingleShot( true );
+    this->timer.setInterval( XMLTools_::FlushDelay );
+    XMLTools::connect( &this->timer, &QTimer::timeout, this, &XMLTools::flush );
+    XMLTools::connect( Variable::instance(), &Variable::valueChanged, this, &XMLTools::scheduleFlush );
+
+    GarbageMan::instance()->add( this );
+}
+
+/**
+ * @brief XMLTools::~XMLTools
+ */
+XMLTools::~XMLTools() {
+    XMLTools::disconnect( &this->timer, &QTimer::timeout, this, &XMLTools::flush );
+    XMLTools::disconnect( Variable::instance(), &Variable::valueChanged, this, &XMLTools::scheduleFlush );
+    this->pool.waitForDone();
+}
+
+/**
+ * @brief XMLTools::configPath
+ * @return
+ */
+QString XMLTools::configPath() {
+    const QDir configDir( QDir::homePath() + "/" + Main::Path );
+    if ( !configDir.exists())
+        configDir.mkpath( configDir.absolutePath());
+
+    return configDir.absolutePath() + "/" + XMLTools_::ConfigFile;
+}
+
+/**
+ * @brief XMLTools::sidecarPath returns path of the file that holds a large value
+ * @param key
+ * @return
+ */
+QString XMLTools::sidecarPath( const QString &key ) {
+    const QDir sidecarDir( QDir::homePath() + "/" + Main::Path + "/" + XMLTools_::SidecarDir );
+    if ( !sidecarDir.exists())
+        sidecarDir.mkpath( sidecarDir.absolutePath());
+
+    return sidecarDir.absolutePath() + "/" + QString( key ).replace( QRegularExpression( "[^A-Za-z0-9_]" ), "_" ) + ".dat";
+}
+
 /**
  * @brief XMLTools::read
  * @param mode
@@ -38,18 +94,17 @@
  */
 void XMLTools::read() {
     QDomDocument document;
-    const QDir configDir( QDir::homePath() + "/" + Main::Path );
+
+    // start tracking changes (initial values are set silently)
+    XMLTools::instance();
 
 #ifdef QT_DEBUG
     // announce
     qCInfo( XMLTools_::Debug ) << XMLTools::tr( "reading configuration" );
 #endif
 
-    if ( !configDir.exists())
-        configDir.mkpath( configDir.absolutePath());
-
     // set path
-    const QString path( configDir.absolutePath() + "/" + XMLTools_::ConfigFile );
+    const QString path( XMLTools::configPath());
 
     // load xml file
     QFile xmlFile( path );
@@ -69,7 +124,19 @@ void XMLTools::read() {
                 const QString key( element.attribute( "key" ));
                 QVariant value;
 
-                if ( element.hasAttribute( "binary" )) {
+                if ( element.hasAttribute( "file" )) {
+                    // large values are kept in sidecar files
+                    QFile sidecar( XMLTools::sidecarPath( key ));
+                    if ( !sidecar.open( QFile::ReadOnly )) {
+                        qCWarning( XMLTools_::Debug ) << XMLTools::tr( "could not read value of \"%1\"" ).arg( key );
+                        node = qAsConst( node ).nextSibling();
+                        continue;
+                    }
+
+                    QDataStream in( &sidecar );
+                    in >> value;
+                    sidecar.close();
+                } else if ( element.hasAttribute( "binary" )) {
                     QByteArray array( QByteArray::fromBase64( element.attribute( "binary" ).toUtf8().constData()));
                     QBuffer buffer( &array );
                     buffer.open( QIODevice::ReadOnly );
@@ -92,57 +159,123 @@ void XMLTools::read() {
 }
 
 /**
- * @brief XMLTools::write
- * @param mode
+ * @brief XMLTools::snapshot copies current values (cheap, since values are implicitly shared)
+ * @return
+ */
+XMLTools_::Snapshot XMLTools::snapshot() {
+    XMLTools_::Snapshot snapshot;
+    for ( const QSharedPointer<Var> &var : qAsConst( Variable::instance()->list )) {
+        if ( var->key().isEmpty() || var->flags() & Var::Flag::NoSave )
+            continue;
+
+        snapshot << qMakePair( var->key(), var->value());
+    }
+
+    return snapshot;
+}
+
+/**
+ * @brief XMLTools::scheduleFlush marks a variable as changed and (re)starts the flush timer
+ * @param key
+ */
+void XMLTools::scheduleFlush( const QString &key ) {
+    if ( !Variable::instance()->contains( key ) || Variable::instance()->list[key]->flags() & Var::Flag::NoSave )
+        return;
+
+    this->dirtyKeys << key;
+    this->timer.start();
+}
+
+/**
+ * @brief XMLTools::flush writes changed configuration on a background thread
+ */
+void XMLTools::flush() {
+    this->timer.stop();
+    if ( this->dirtyKeys.isEmpty())
+        return;
+
+    this->pool.start( new ConfigWriter( XMLTools::snapshot(), this->dirtyKeys ));
+    this->dirtyKeys.clear();
+}
+
+/**
+ * @brief XMLTools::write writes configuration synchronously (on exit)
  */
 void XMLTools::write() {
-    const QDir configDir( QDir::homePath() + "/" + Main::Path );
+    XMLTools *tools( XMLTools::instance());
+    tools->timer.stop();
+    tools->pool.waitForDone();
 
+    // nothing has changed since the last flush
+    if ( tools->dirtyKeys.isEmpty() && QFile::exists( XMLTools::configPath()))
+        return;
+
+    ConfigWriter writer( XMLTools::snapshot(), tools->dirtyKeys );
+    writer.run();
+    tools->dirtyKeys.clear();
+}
+
+/**
+ * @brief ConfigWriter::run
+ */
+void ConfigWriter::run() {
 #ifdef QT_DEBUG
     // announce
     qCInfo( XMLTools_::Debug ) << XMLTools::tr( "writing configuration" );
 #endif
 
-    if ( !configDir.exists())
-        configDir.mkpath( configDir.absolutePath());
-
-    // set path
-    const QString path( configDir.absolutePath() + "/" + XMLTools_::ConfigFile );
-
-    // read xml file and create buffer
-    QFile xmlFile( path );
-    QBuffer xmlBuffer;
-    xmlBuffer.open( QBuffer::WriteOnly | QBuffer::Text | QBuffer::Truncate );
-
     // create stream
-    QXmlStreamWriter stream( &xmlBuffer );
+    QByteArray data;
+    QXmlStreamWriter stream( &data );
     stream.setAutoFormatting( true );
     stream.writeStartDocument();
     stream.writeStartElement( "configuration" );
     stream.writeAttribute( "version", "3" );
 
-    // switch mode
-    for ( const QSharedPointer<Var> &var : qAsConst( Variable::instance()->list )) {
-        if ( var->key().isEmpty() || var->flags() & Var::Flag::NoSave )
-            continue;
+    for ( const QPair<QString, QVariant> &pair : qAsConst( this->snapshot )) {
+        const QString &key( pair.first );
+        const QVariant &value( pair.second );
 
         stream.writeEmptyElement( "variable" );
-        stream.writeAttribute( "key", var->key());
+        stream.writeAttribute( "key", key );
 
-        if ( !var->value().canConvert<QString>()) {
-            QByteArray array;
-            QBuffer buffer( &array );
+        // small strings are stored inline as before
+        const bool isString = value.canConvert<QString>();
+        const QString string( isString ? value.toString() : QString());
+        const QString path( XMLTools::sidecarPath( key ));
+        if ( isString && string.length() <= XMLTools_::SidecarThreshold ) {
+            stream.writeAttribute( "value", string );
 
-            buffer.open( QIODevice::WriteOnly );
-            QDataStream out( &buffer );
+            if ( this->dirtyKeys.contains( key ) && QFile::exists( path ))
+                QFile::remove( path );
 
-            out << var->value();
-            buffer.close();
+            continue;
+        }
+
+        QByteArray array;
+        QBuffer buffer( &array );
+        buffer.open( QIODevice::WriteOnly );
+        QDataStream out( &buffer );
+        out << value;
+        buffer.close();
 
+        if ( array.size() <= XMLTools_::SidecarThreshold ) {
             stream.writeAttribute( "binary", QString( array.toBase64()));
-        } else {
-            stream.writeAttribute( "value", var->value().toString());
+
+            if ( this->dirtyKeys.contains( key ) && QFile::exists( path ))
+                QFile::remove( path );
+
+            continue;
         }
+
+        // large values go to sidecar files, which are rewritten only when changed
+        stream.writeAttribute( "file", QFileInfo( path ).fileName());
+        if ( !this->dirtyKeys.contains( key ) && QFile::exists( path ))
+            continue;
+
+        QSaveFile sidecar( path );
+        if ( !sidecar.open( QFile::WriteOnly ) || sidecar.write( array ) != array.size() || !sidecar.commit())
+            qCCritical( XMLTools_::Debug ) << XMLTools::tr( "could not write configuration file \"%1\"" ).arg( path );
     }
 
     // end config element
@@ -151,33 +284,16 @@ void XMLTools::write() {
     // end document
     stream.writeEndDocument();
 
-    // close buffer
-    xmlBuffer.close();
-
-    // read existing config from file
-    QString savedData;
-    if ( xmlFile.open( QFile::ReadOnly | QIODevice::Text )) {
-        savedData = xmlFile.readAll();
-        xmlFile.close();
-    }
-
-    // read new config from buffer
-    QString newData;
-    if ( xmlBuffer.open( QFile::ReadOnly | QIODevice::Text )) {
-        newData = xmlBuffer.readAll();
-        xmlBuffer.close();
-    }
-
-    // compare data
-    if ( QString::compare( qAsConst( savedData ), qAsConst( newData ))) {
-        // write out as binary (not QIODevice::Text) to avoid CR line endings
-        if ( !xmlFile.open( QFile::WriteOnly | QFile::Truncate )) {
-            qCCritical( XMLTools_::Debug ) << XMLTools::tr( "could not open configuration file \"%1\"" ).arg( path );
-            return;
-        }
-        xmlFile.write( newData.toUtf8().replace( "\r", "" ));
+    // replace the file only after it has been fully written
+    // NOTE: written out as binary (not QIODevice::Text) to avoid CR line endings
+    const QString path( XMLTools::configPath());
+    QSaveFile xmlFile( path );
+    if ( !xmlFile.open( QFile::WriteOnly )) {
+        qCCritical( XMLTools_::Debug ) << XMLTools::tr( "could not open configuration file \"%1\"" ).arg( path );
+        return;
     }
 
-    // close file
-    xmlFile.close();
+    xmlFile.write( data.replace( "\r", "" ));
+    if ( !xmlFile.commit())
+        qCCritical( XMLTools_::Debug ) << XMLTools::tr( "could not write configuration file \"%1\"" ).arg( path );
 }
@@ -26,6 +26,11 @@
 #include <QDir>
 #include <QLoggingCategory>
 #include <QMap>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVariant>
 
 /**
  * @brief The XML namespace
@@ -33,18 +38,55 @@
 namespace XMLTools_ {
     [[maybe_unused]]
     static constexpr const char *ConfigFile( "configuration.xml" );
+    [[maybe_unused]]
+    static constexpr const char *SidecarDir( "configuration" );
+
+    // values larger than this are stored in sidecar files instead of xml attributes
+    [[maybe_unused]]
+    static constexpr int SidecarThreshold = 4096;
+
+    // changes are flushed after no further changes occur for this long (ms)
+    [[maybe_unused]]
+    static constexpr int FlushDelay = 2000;
     const static QLoggingCategory Debug( "xml" );
+
+    /**
+     * @brief Snapshot is a list of (key, value) pairs taken on the GUI thread
+     */
+    using Snapshot = QList<QPair<QString, QVariant>>;
 }
 
+/**
+ * @brief The ConfigWriter class serializes a configuration snapshot and writes it atomically
+ */
+class ConfigWriter final : public QRunnable {
+public:
+    /**
+     * @brief ConfigWriter
+     * @param snapshot
+     * @param dirtyKeys keys that have changed since the last write (sidecars of other keys are kept)
+     */
+    ConfigWriter( const XMLTools_::Snapshot &snapshot, const QSet<QString> &dirtyKeys ) : snapshot( snapshot ), dirtyKeys( dirtyKeys ) {}
+    void run() override;
+
+private:
+    XMLTools_::Snapshot snapshot;
+    QSet<QString> dirtyKeys;
+};
+
 /**
  * @brief The XMLTools class
  */
 class XMLTools final : public QObject {
     Q_DISABLE_COPY( XMLTools )
     Q_OBJECT
+    friend class ConfigWriter;
 
 public:
-    ~XMLTools() override = default;
+    // disable move
+    XMLTools( XMLTools&& ) = delete;
+    XMLTools& operator=( XMLTools&& ) = delete;
+    ~XMLTools() override;
 
     /**
      * @brief instance
@@ -57,13 +99,16 @@ public:
     static void write();
     static void read();
 
+public slots:
+    void scheduleFlush( const QString &key );
+    void flush();
+
 private:
-    /**
-     * @brief XMLTools
-     * @param parent
-     */
-    explicit XMLTools( QObject *parent = nullptr ) : QObject( parent ) {
-        this->setObjectName( "XMLTools" );
-        GarbageMan::instance()->add( this );
-    }
+    explicit XMLTools( QObject *parent = nullptr );
+    [[nodiscard]] static XMLTools_::Snapshot snapshot();
+    [[nodiscard]] static QString configPath();
+    [[nodiscard]] static QString sidecarPath( const QString &key );
+    QTimer timer;
+    QSet<QString> dirtyKeys;
+    QThreadPool pool;
 };